@@ -3,7 +3,7 @@
 #ifndef SIM_PARAM_ARRAY_HELPER
 #define SIM_PARAM_ARRAY_HELPER
 
-#include <MSFS\MSFS_Core.h>
+#include <MSFS/MSFS_Core.h>
 #include <cstring>
 #include <cstdarg>
 #include <stdio.h>
@@ -75,4 +75,81 @@ static void FsDestroyParamArray(FsVarParamArray* pParamArray)
 
 }
 
+/// <summary>
+/// Parameter types of FsParamArray, selected by the same format characters as FsCreateParamArray.
+/// An unknown character has no specialization and does not compile.
+/// </summary>
+template <char Format>
+struct FsParamFormat;
+
+template <>
+struct FsParamFormat<'c'>
+{
+	typedef FsCRC Type;
+	static void Set(FsVarParamVariant& variant, FsCRC value)
+	{
+		variant.type = FsVarParamTypeCRC;
+		variant.CRCValue = value;
+	}
+};
+
+template <>
+struct FsParamFormat<'s'>
+{
+	typedef const char* Type;
+	static void Set(FsVarParamVariant& variant, const char* value)
+	{
+		variant.type = FsVarParamTypeString;
+		variant.stringValue = value;
+	}
+};
+
+template <>
+struct FsParamFormat<'i'>
+{
+	typedef unsigned int Type;
+	static void Set(FsVarParamVariant& variant, unsigned int value)
+	{
+		variant.type = FsVarParamTypeInteger;
+		variant.intValue = value;
+	}
+};
+
+/// <summary>
+/// Stack-resident alternative to FsCreateParamArray.
+/// The format is given as template arguments and checked at compile time :
+/// the constructor takes exactly one argument per format character, typed
+/// as FsParamFormat declares it. No memory is allocated and nothing has to
+/// be freed; the object converts to a FsVarParamArray pointing into itself.
+/// 
+/// Example : FsParamArray<'i', 'i', 'c', 's'> params(0, 1, 123456, "Hey");
+///           fsVarsAircraftVarGet(simvar, unit, params, &value);
+/// 
+/// The converted FsVarParamArray must not outlive the FsParamArray.
+/// String parameters are referenced, not copied.
+/// </summary>
+template <char... Format>
+struct FsParamArray
+{
+	static const unsigned int Size = sizeof...(Format);
+
+	FsParamArray(typename FsParamFormat<Format>::Type... values)
+	{
+		unsigned int i = 0;
+		int expand[] = { 0, (FsParamFormat<Format>::Set(array[i++], values), 0)... };
+		(void)expand;
+		(void)i;
+	}
+
+	operator FsVarParamArray() const
+	{
+		FsVarParamArray result;
+		result.size = Size;
+		result.array = Size != 0 ? const_cast<FsVarParamVariant*>(array) : nullptr;
+		return result;
+	}
+
+	FsVarParamVariant array[Size != 0 ? Size : 1];
+};
+
 #endif // SIM_PARAM_ARRAY_HELPER
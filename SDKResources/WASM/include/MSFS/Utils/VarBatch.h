@@ -0,0 +1,369 @@
+#pragma once
+
+#ifndef VAR_BATCH_HELPER
+#define VAR_BATCH_HELPER
+
+#include <MSFS/MSFS_Vars.h>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifndef VAR_BATCH_TIMING
+#define VAR_BATCH_TIMING 1
+#endif
+
+#if VAR_BATCH_TIMING
+#include <chrono>
+#endif
+
+/// <summary>
+/// Per-frame counters of a VarBatch.
+/// Times are in nanoseconds and stay 0 when VAR_BATCH_TIMING is 0.
+/// </summary>
+struct VarBatchStats
+{
+	unsigned long long frames = 0;			// Read() calls
+	unsigned long long varsRead = 0;		// fsVarsAircraftVarGet calls
+	unsigned long long readErrors = 0;		// failed gets, the previous value is kept
+	unsigned long long varsChanged = 0;		// bits set in the changed masks
+	unsigned long long lastReadNs = 0;
+	unsigned long long maxReadNs = 0;
+	unsigned long long totalReadNs = 0;
+
+	unsigned long long flushes = 0;			// FlushWrites() calls with pending writes
+	unsigned long long varsWritten = 0;		// fsVarsAircraftVarSet calls
+	unsigned long long writeErrors = 0;
+	unsigned long long lastWriteNs = 0;
+	unsigned long long totalWriteNs = 0;
+
+	/// Average cost of reading one var.
+	double ReadNsPerVar() const { return varsRead ? double(totalReadNs) / double(varsRead) : 0.0; }
+	/// Average cost of writing one var.
+	double WriteNsPerVar() const { return varsWritten ? double(totalWriteNs) / double(varsWritten) : 0.0; }
+};
+
+/// <summary>
+/// Reads a fixed set of aircraft vars once per frame and batches writes.
+///
+/// Sim var and unit ids are resolved once by Register(), so the frame loop
+/// never goes through the string lookups. Read() fetches every registered var
+/// into a contiguous array of doubles (one entry per handle, in registration
+/// order) and compares it with the previous frame into a changed bitmask.
+/// QueueWrite() collects writes, the last value queued for a var wins, and
+/// FlushWrites() applies them from one call site.
+///
+/// Example :
+///		VarBatch batch;
+///		VarBatch::Handle alt = batch.Register("INDICATED ALTITUDE", "feet", FsVarParamArray(), 1.0);
+///		VarBatch::Handle gear = batch.Register("GEAR HANDLE POSITION", "bool");
+///		...
+///		if (batch.Read() != 0)
+///			for (VarBatch::Handle h = batch.NextChanged(0); h != VarBatch::InvalidHandle; h = batch.NextChanged(h + 1))
+///				Send(h, batch.Values()[h]);
+///		batch.QueueWrite(gear, 1.0);
+///		batch.FlushWrites();
+///
+/// String parameters are referenced, not copied : they must outlive the batch.
+/// </summary>
+class VarBatch
+{
+public:
+	typedef unsigned int Handle;
+	enum : Handle { InvalidHandle = 0xffffffff };
+
+	VarBatch() : current(0), hasPrevious(false) {}
+
+	/// <summary>
+	/// Register a var by name, resolving its ids. Registering the same var,
+	/// unit and parameters again returns the first handle.
+	/// Returns InvalidHandle if the var or unit is unknown.
+	/// </summary>
+	Handle Register(const char* simVarName, const char* unitName, FsVarParamArray param = FsVarParamArray(), double epsilon = 0.0)
+	{
+		FsSimVarId id = fsVarsGetAircraftVarId(simVarName);
+		FsUnitId unit = fsVarsGetUnitId(unitName);
+		if (id < 0 || unit < 0)
+		{
+			return InvalidHandle;
+		}
+		return Register(id, unit, param, epsilon);
+	}
+
+	/// <summary>
+	/// Register a var by id. A change smaller than or equal to epsilon is not
+	/// reported by the changed mask.
+	/// </summary>
+	Handle Register(FsSimVarId id, FsUnitId unit, FsVarParamArray param = FsVarParamArray(), double epsilon = 0.0)
+	{
+		for (Handle h = 0; h < Size(); ++h)
+		{
+			if (ids[h] == id && units[h] == unit && SameParams(h, param))
+			{
+				if (epsilon < epsilons[h])
+				{
+					epsilons[h] = epsilon;
+				}
+				return h;
+			}
+		}
+
+		Handle h = Size();
+		ids.push_back(id);
+		units.push_back(unit);
+		epsilons.push_back(epsilon);
+		paramOffsets.push_back((unsigned int)params.size());
+		paramSizes.push_back(param.size);
+		params.insert(params.end(), param.array, param.array + param.size);
+		values[0].push_back(0.0);
+		values[1].push_back(0.0);
+		errors.push_back(FS_VAR_ERROR_NONE);
+		pendingSlots.push_back(InvalidHandle);
+		if ((h & 31) == 0)
+		{
+			changed.push_back(0);
+		}
+		hasPrevious = false;	// the next Read() reports every var
+		return h;
+	}
+
+	unsigned int Size() const { return (unsigned int)ids.size(); }
+
+	/// <summary>
+	/// Read every registered var and update the changed mask.
+	/// Returns the number of changed vars, all of them on the first frame.
+	/// </summary>
+	unsigned int Read()
+	{
+#if VAR_BATCH_TIMING
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+		const unsigned int n = Size();
+		const double* previous = values[current].data();
+		current ^= 1;
+		double* now = values[current].data();
+		const FsVarParamVariant* paramBase = params.data();
+
+		unsigned int nChanged = 0;
+		unsigned int errorCount = 0;
+		for (unsigned int word = 0; word * 32 < n; ++word)
+		{
+			uint32_t mask = 0;
+			const unsigned int end = n - word * 32 < 32 ? n : word * 32 + 32;
+			for (unsigned int i = word * 32; i < end; ++i)
+			{
+				FsVarParamArray param;
+				param.size = paramSizes[i];
+				param.array = param.size ? const_cast<FsVarParamVariant*>(paramBase + paramOffsets[i]) : nullptr;
+
+				errors[i] = fsVarsAircraftVarGet(ids[i], units[i], param, &now[i]);
+				if (errors[i] != FS_VAR_ERROR_NONE)
+				{
+					now[i] = previous[i];
+					++errorCount;
+					continue;
+				}
+				if (!hasPrevious || Differs(now[i], previous[i], epsilons[i]))
+				{
+					mask |= uint32_t(1) << (i & 31);
+				}
+			}
+			changed[word] = mask;
+			nChanged += PopCount(mask);
+		}
+		hasPrevious = true;
+
+		++stats.frames;
+		stats.varsRead += n;
+		stats.readErrors += errorCount;
+		stats.varsChanged += nChanged;
+#if VAR_BATCH_TIMING
+		stats.lastReadNs = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		stats.totalReadNs += stats.lastReadNs;
+		if (stats.lastReadNs > stats.maxReadNs)
+		{
+			stats.maxReadNs = stats.lastReadNs;
+		}
+#endif
+		return nChanged;
+	}
+
+	/// Values of the last Read(), indexed by handle.
+	const double* Values() const { return values[current].data(); }
+	/// Values of the Read() before, indexed by handle.
+	const double* PreviousValues() const { return values[current ^ 1].data(); }
+	double Value(Handle h) const { return values[current][h]; }
+	/// Result of the last get of a var. A var which failed keeps its previous value.
+	FsVarError Error(Handle h) const { return errors[h]; }
+
+	/// Changed mask of the last Read(), bit (h & 31) of word h / 32 is set if var h changed.
+	const uint32_t* ChangedMask() const { return changed.data(); }
+	unsigned int ChangedMaskWords() const { return (unsigned int)changed.size(); }
+	bool Changed(Handle h) const { return (changed[h >> 5] >> (h & 31)) & 1; }
+
+	/// <summary>
+	/// First changed var with a handle greater than or equal to from, InvalidHandle if none.
+	/// </summary>
+	Handle NextChanged(Handle from) const
+	{
+		for (unsigned int word = from >> 5; word < changed.size(); ++word)
+		{
+			uint32_t mask = changed[word];
+			if (word == (from >> 5))
+			{
+				mask &= ~uint32_t(0) << (from & 31);
+			}
+			if (mask)
+			{
+				return (word << 5) + CountTrailingZeros(mask);
+			}
+		}
+		return InvalidHandle;
+	}
+
+	/// <summary>
+	/// Queue a write, applied by the next FlushWrites(). Queuing a var twice keeps the last value.
+	/// </summary>
+	void QueueWrite(Handle h, double value)
+	{
+		if (pendingSlots[h] != InvalidHandle)
+		{
+			pendingValues[pendingSlots[h]] = value;
+			return;
+		}
+		pendingSlots[h] = (Handle)pendingHandles.size();
+		pendingHandles.push_back(h);
+		pendingValues.push_back(value);
+	}
+
+	unsigned int PendingWrites() const { return (unsigned int)pendingHandles.size(); }
+
+	/// <summary>
+	/// Apply the queued writes in queue order. Returns the number of failed writes.
+	/// </summary>
+	unsigned int FlushWrites()
+	{
+		if (pendingHandles.empty())
+		{
+			return 0;
+		}
+#if VAR_BATCH_TIMING
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+		unsigned int errorCount = 0;
+		for (size_t k = 0; k < pendingHandles.size(); ++k)
+		{
+			const Handle h = pendingHandles[k];
+			FsVarParamArray param;
+			param.size = paramSizes[h];
+			param.array = param.size ? &params[paramOffsets[h]] : nullptr;
+			if (fsVarsAircraftVarSet(ids[h], units[h], param, pendingValues[k]) != FS_VAR_ERROR_NONE)
+			{
+				++errorCount;
+			}
+			pendingSlots[h] = InvalidHandle;
+		}
+
+		++stats.flushes;
+		stats.varsWritten += pendingHandles.size();
+		stats.writeErrors += errorCount;
+		pendingHandles.clear();
+		pendingValues.clear();
+#if VAR_BATCH_TIMING
+		stats.lastWriteNs = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		stats.totalWriteNs += stats.lastWriteNs;
+#endif
+		return errorCount;
+	}
+
+	const VarBatchStats& Stats() const { return stats; }
+	void ResetStats() { stats = VarBatchStats(); }
+
+private:
+	static bool Differs(double a, double b, double epsilon)
+	{
+		if (a != a || b != b)	// NaN : changed unless both are NaN
+		{
+			return (a != a) != (b != b);
+		}
+		return std::fabs(a - b) > epsilon;
+	}
+
+	static unsigned int PopCount(uint32_t x)
+	{
+#if defined(__clang__) || defined(__GNUC__)
+		return (unsigned int)__builtin_popcount(x);
+#else
+		x = x - ((x >> 1) & 0x55555555u);
+		x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+		return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+	}
+
+	static unsigned int CountTrailingZeros(uint32_t x)
+	{
+#if defined(__clang__) || defined(__GNUC__)
+		return (unsigned int)__builtin_ctz(x);
+#else
+		unsigned int n = 0;
+		while (!(x & 1))
+		{
+			x >>= 1;
+			++n;
+		}
+		return n;
+#endif
+	}
+
+	/// A null string parameter only matches another null one.
+	static bool SameString(const char* a, const char* b)
+	{
+		return a == b || (a != nullptr && b != nullptr && std::strcmp(a, b) == 0);
+	}
+
+	bool SameParams(Handle h, const FsVarParamArray& param) const
+	{
+		if (paramSizes[h] != param.size)
+		{
+			return false;
+		}
+		for (unsigned int i = 0; i < param.size; ++i)
+		{
+			const FsVarParamVariant& a = params[paramOffsets[h] + i];
+			const FsVarParamVariant& b = param.array[i];
+			if (a.type != b.type)
+			{
+				return false;
+			}
+			if (a.type == FsVarParamTypeInteger ? a.intValue != b.intValue
+				: a.type == FsVarParamTypeCRC ? a.CRCValue != b.CRCValue
+				: !SameString(a.stringValue, b.stringValue))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// One entry per handle
+	std::vector<FsSimVarId> ids;
+	std::vector<FsUnitId> units;
+	std::vector<double> epsilons;
+	std::vector<unsigned int> paramOffsets;
+	std::vector<unsigned int> paramSizes;
+	std::vector<double> values[2];			// current and previous frame
+	std::vector<FsVarError> errors;
+	std::vector<Handle> pendingSlots;		// index in pendingHandles, InvalidHandle if no write is queued
+
+	std::vector<FsVarParamVariant> params;	// parameters of all vars
+	std::vector<uint32_t> changed;
+
+	std::vector<Handle> pendingHandles;
+	std::vector<double> pendingValues;
+
+	unsigned int current;
+	bool hasPrevious;
+	VarBatchStats stats;
+};
+
+#endif // VAR_BATCH_HELPER
@@ -0,0 +1,350 @@
+#pragma once
+
+#ifndef VAR_CHANGE_DETECTOR_HELPER
+#define VAR_CHANGE_DETECTOR_HELPER
+
+#include <MSFS/MSFS_CommBus.h>
+#include <MSFS/Utils/VarBatch.h>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Publish order of a tracked var. When a packet has a size limit, higher
+/// classes are packed first and the rest waits for the next frame. Inside a
+/// class, the next frame starts with the first var which did not fit, so
+/// every var of the class gets its turn.
+/// </summary>
+enum VarPriority : unsigned char
+{
+	VarPriorityCritical,
+	VarPriorityHigh,
+	VarPriorityNormal,
+	VarPriorityLow,
+
+	VarPriorityCount
+};
+
+/// <summary>
+/// Publish rules of a tracked var.
+/// </summary>
+struct VarTrackOptions
+{
+	double deadband = 0.0;		// publish when |value - last published value| > deadband
+	double minInterval = 0.0;	// seconds between two publishes of the var, a change waits until then
+	double maxInterval = 0.0;	// republish unchanged values after this many seconds, 0 for never
+	VarPriority priority = VarPriorityNormal;
+	unsigned short key = 0xFFFF;	// id on the wire, 0xFFFF to use the VarBatch handle (below 0xFFFF)
+};
+
+/// <summary>
+/// Counters of a VarChangeDetector.
+/// </summary>
+struct VarChangeDetectorStats
+{
+	unsigned long long frames = 0;
+	unsigned long long packets = 0;			// fsCommBusCall calls
+	unsigned long long sendFailures = 0;
+	unsigned long long bytesSent = 0;
+	unsigned long long varsPublished = 0;	// entries sent, including heartbeats
+	unsigned long long heartbeats = 0;		// entries sent because of maxInterval
+	unsigned long long varsDeferred = 0;	// changes left for a later frame (minInterval or packet size)
+	unsigned long long lastUpdateNs = 0;	// Update() time, 0 when VAR_BATCH_TIMING is 0
+	unsigned long long totalUpdateNs = 0;
+};
+
+/// <summary>
+/// Detects changes of aircraft vars inside the module and publishes only
+/// what changed as one packed delta per frame over fsCommBusCall.
+///
+/// Update(now) reads every tracked var through a VarBatch. A var is
+/// published when it moved by more than its deadband since the value last
+/// published, and at least minInterval seconds went by since that publish;
+/// or as a heartbeat when maxInterval seconds went by without a publish.
+/// A change which cannot be sent yet stays pending and is compared again
+/// every frame, so a var returning inside its deadband is dropped.
+/// ForceFull() publishes every var regardless: the vars of a keyframe which
+/// do not fit in its packet are sent with the next frames, whatever their
+/// deadband, since the new receiver has not seen their value yet.
+///
+/// Packet, little-endian (WebAssembly byte order) :
+///		uint32 magic 'VDLT', uint16 version (1), uint16 flags, uint32 sequence, uint16 count,
+///		then count entries of { uint16 key, float64 value }, by priority class.
+///	flags bit 0 (VarDeltaKeyframe) : first packet after ForceFull(), every var follows.
+///
+/// Example :
+///		VarChangeDetector detector("SharedCockpit.VarDelta");
+///		VarTrackOptions altitude;
+///		altitude.deadband = 1.0;
+///		altitude.maxInterval = 5.0;
+///		detector.Track("INDICATED ALTITUDE", "feet", altitude);
+///		...
+///		detector.Update(absoluteTimeInSeconds);	// once per frame
+/// </summary>
+class VarChangeDetector
+{
+public:
+	enum : uint32_t { Magic = 0x544C4456 };	// "VDLT"
+	enum : uint16_t { Version = 1, VarDeltaKeyframe = 1 << 0 };
+	enum : unsigned int { HeaderSize = 14, EntrySize = 10 };
+
+	/// <summary>
+	/// eventName : CommBus event of the packets.
+	/// maxPacketBytes : size limit of a packet, 0 for none. A limit below one entry
+	/// (HeaderSize + EntrySize) is raised to one entry, so every packet carries at least one var.
+	/// </summary>
+	explicit VarChangeDetector(const char* eventName, FsCommBusBroadcastFlags broadcastTo = FsCommBusBroadcast_Default, unsigned int maxPacketBytes = 0)
+		: cursors(), eventName(eventName), broadcastTo(broadcastTo),
+		maxPacketBytes(maxPacketBytes != 0 && maxPacketBytes < HeaderSize + EntrySize ? HeaderSize + EntrySize : maxPacketBytes),
+		sequence(0), keyframe(true)
+	{
+	}
+
+	/// <summary>
+	/// Track a var by name. Returns its VarBatch handle, VarBatch::InvalidHandle if the var or unit is unknown,
+	/// or if options.key is left to the handle once 0xFFFF vars are tracked : the handle would not fit the wire key.
+	/// Tracking the same var again replaces its options.
+	/// </summary>
+	VarBatch::Handle Track(const char* simVarName, const char* unitName, const VarTrackOptions& options = VarTrackOptions(), FsVarParamArray param = FsVarParamArray())
+	{
+		if (!HasKey(options))
+			return VarBatch::InvalidHandle;
+		return Configure(batch.Register(simVarName, unitName, param), options);
+	}
+
+	VarBatch::Handle Track(FsSimVarId id, FsUnitId unit, const VarTrackOptions& options = VarTrackOptions(), FsVarParamArray param = FsVarParamArray())
+	{
+		if (!HasKey(options))
+			return VarBatch::InvalidHandle;
+		return Configure(batch.Register(id, unit, param), options);
+	}
+
+	/// <summary>
+	/// Publish every var with the next Update(), ignoring deadbands and minInterval,
+	/// e.g. when a new peer joins.
+	/// </summary>
+	void ForceFull()
+	{
+		keyframe = true;
+	}
+
+	/// <summary>
+	/// Read the tracked vars, publish what changed. now is a monotonic time in seconds.
+	/// Returns the number of vars published.
+	/// </summary>
+	unsigned int Update(double now)
+	{
+#if VAR_BATCH_TIMING
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+		const unsigned int n = batch.Size();
+		const bool full = keyframe;
+		keyframe = false;
+
+		// Keyframe : every var is owed to the new receiver until sent, the deadbands do not apply.
+		if (full)
+		{
+			for (unsigned int word = 0; word < keyframePending.size(); ++word)
+				keyframePending[word] = word * 32 + 32 <= n ? ~uint32_t(0) : (uint32_t(1) << (n & 31)) - 1;
+		}
+
+		// Pending changes : vars which moved this frame are compared with their last published value.
+		batch.Read();
+		const double* values = batch.Values();
+		for (VarBatch::Handle h = batch.NextChanged(0); h != VarBatch::InvalidHandle; h = batch.NextChanged(h + 1))
+		{
+			if (Exceeds(values[h], published[h], deadbands[h]))
+				pending[h >> 5] |= uint32_t(1) << (h & 31);
+			else
+				pending[h >> 5] &= ~(uint32_t(1) << (h & 31));
+		}
+
+		// Pack by priority class until the size limit. What does not fit stays pending,
+		// and what is left of a keyframe stays due : only its first packet carries the flag.
+		// A class resumes at the var which did not fit, so that its first vars cannot
+		// take every packet while the others wait.
+		packet.resize(HeaderSize);
+		unsigned int count = 0;
+		bool packetFull = false;
+		for (unsigned int priority = 0; priority < VarPriorityCount && !packetFull; ++priority)
+		{
+			const std::vector<VarBatch::Handle>& handles = handlesByPriority[priority];
+			const unsigned int size = (unsigned int)handles.size();
+			for (unsigned int i = 0; i < size; ++i)
+			{
+				const unsigned int at = (cursors[priority] + i) % size;
+				const VarBatch::Handle h = handles[at];
+				const uint32_t bit = uint32_t(1) << (h & 31);
+				const bool isPending = (pending[h >> 5] & bit) != 0;
+				const double elapsed = now - publishTimes[h];
+				const bool due = (keyframePending[h >> 5] & bit) != 0 || (isPending && elapsed >= minIntervals[h]);
+				const bool heartbeat = !due && maxIntervals[h] > 0.0 && elapsed >= maxIntervals[h];
+				if (!due && !heartbeat)
+					continue;
+				if (maxPacketBytes != 0 && packet.size() + EntrySize > maxPacketBytes)
+				{
+					cursors[priority] = at;
+					packetFull = true;
+					break;
+				}
+
+				Put16(keys[h]);
+				PutDouble(values[h]);
+				++count;
+				published[h] = values[h];
+				publishTimes[h] = now;
+				pending[h >> 5] &= ~bit;
+				keyframePending[h >> 5] &= ~bit;
+				if (heartbeat)
+					++stats.heartbeats;
+			}
+		}
+
+		for (unsigned int word = 0; word < pending.size(); ++word)
+			stats.varsDeferred += PopCount(pending[word] | keyframePending[word]);
+
+		++stats.frames;
+		if (count != 0)
+		{
+			uint32_t header32 = Magic;
+			std::memcpy(&packet[0], &header32, 4);
+			uint16_t header16 = Version;
+			std::memcpy(&packet[4], &header16, 2);
+			header16 = full ? VarDeltaKeyframe : 0;
+			std::memcpy(&packet[6], &header16, 2);
+			header32 = sequence++;
+			std::memcpy(&packet[8], &header32, 4);
+			header16 = uint16_t(count);
+			std::memcpy(&packet[12], &header16, 2);
+
+			++stats.packets;
+			stats.varsPublished += count;
+			stats.bytesSent += packet.size();
+			if (!fsCommBusCall(eventName, packet.data(), (unsigned int)packet.size(), broadcastTo))
+				++stats.sendFailures;
+		}
+#if VAR_BATCH_TIMING
+		stats.lastUpdateNs = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		stats.totalUpdateNs += stats.lastUpdateNs;
+#endif
+		return count;
+	}
+
+	/// Last packet built by Update(), including one which was not sent because it was empty.
+	const std::vector<char>& LastPacket() const { return packet; }
+
+	/// Value of a var as last published.
+	double Published(VarBatch::Handle h) const { return published[h]; }
+
+	/// The underlying reads; VarBatch::Stats() has the per-var read cost.
+	const VarBatch& Batch() const { return batch; }
+
+	const VarChangeDetectorStats& Stats() const { return stats; }
+	void ResetStats() { stats = VarChangeDetectorStats(); }
+
+private:
+	bool HasKey(const VarTrackOptions& options) const
+	{
+		return options.key != 0xFFFF || batch.Size() < 0xFFFF;
+	}
+
+	VarBatch::Handle Configure(VarBatch::Handle h, const VarTrackOptions& options)
+	{
+		if (h == VarBatch::InvalidHandle)
+			return h;
+
+		if (h == deadbands.size())
+		{
+			deadbands.push_back(0.0);
+			minIntervals.push_back(0.0);
+			maxIntervals.push_back(0.0);
+			published.push_back(0.0);
+			publishTimes.push_back(-HUGE_VAL);
+			keys.push_back(0);
+			priorities.push_back(VarPriorityNormal);
+			handlesByPriority[VarPriorityNormal].push_back(h);
+			if ((h & 31) == 0)
+			{
+				pending.push_back(0);
+				keyframePending.push_back(0);
+			}
+			keyframe = true;	// the receiver has never seen this var
+		}
+
+		deadbands[h] = options.deadband;
+		minIntervals[h] = options.minInterval;
+		maxIntervals[h] = options.maxInterval;
+		keys[h] = options.key != 0xFFFF ? options.key : (unsigned short)h;
+		const VarPriority priority = options.priority < VarPriorityCount ? options.priority : VarPriorityLow;
+		if (priority != priorities[h])
+		{
+			std::vector<VarBatch::Handle>& from = handlesByPriority[priorities[h]];
+			for (size_t i = 0; i < from.size(); ++i)
+			{
+				if (from[i] == h)
+				{
+					from.erase(from.begin() + i);
+					break;
+				}
+			}
+			handlesByPriority[priority].push_back(h);
+			priorities[h] = priority;
+		}
+		return h;
+	}
+
+	static bool Exceeds(double value, double published, double deadband)
+	{
+		if (value != value || published != published)	// NaN : changed unless both are NaN
+			return (value != value) != (published != published);
+		return std::fabs(value - published) > deadband;
+	}
+
+	static unsigned int PopCount(uint32_t x)
+	{
+		x = x - ((x >> 1) & 0x55555555u);
+		x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+		return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+	}
+
+	void Put16(uint16_t value)
+	{
+		const size_t at = packet.size();
+		packet.resize(at + 2);
+		std::memcpy(&packet[at], &value, 2);
+	}
+
+	void PutDouble(double value)
+	{
+		const size_t at = packet.size();
+		packet.resize(at + 8);
+		std::memcpy(&packet[at], &value, 8);
+	}
+
+	VarBatch batch;
+
+	// One entry per handle
+	std::vector<double> deadbands;
+	std::vector<double> minIntervals;
+	std::vector<double> maxIntervals;
+	std::vector<double> published;
+	std::vector<double> publishTimes;
+	std::vector<unsigned short> keys;
+	std::vector<VarPriority> priorities;
+
+	std::vector<VarBatch::Handle> handlesByPriority[VarPriorityCount];
+	unsigned int cursors[VarPriorityCount];	// position in handlesByPriority where the next frame starts packing
+	std::vector<uint32_t> pending;		// changes not published yet, bit (h & 31) of word h / 32
+	std::vector<uint32_t> keyframePending;	// vars of the last keyframe not published yet, same layout
+	std::vector<char> packet;
+
+	const char* eventName;
+	FsCommBusBroadcastFlags broadcastTo;
+	unsigned int maxPacketBytes;
+	uint32_t sequence;
+	bool keyframe;
+	VarChangeDetectorStats stats;
+};
+
+#endif // VAR_CHANGE_DETECTOR_HELPER
@@ -95,6 +95,10 @@ public:
 
     The user-buffer is not deallocated by this allocator.
 
+    For memory rebuilt over and over (e.g. a per-frame document), Reset() keeps all
+    chunks and hands them out again, so the steady state does not touch BaseAllocator.
+    Size(), PeakSize(), Capacity() and ChunkCount() help sizing the chunks.
+
     \tparam BaseAllocator the allocator type for allocating memory chunks. Default is CrtAllocator.
     \note implements Allocator concept
 */
@@ -108,7 +112,7 @@ public:
         \param baseAllocator The allocator for allocating memory chunks.
     */
     MemoryPoolAllocator(size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) : 
-        chunkHead_(0), chunk_capacity_(chunkSize), userBuffer_(0), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+        chunkHead_(0), spareHead_(0), chunk_capacity_(chunkSize), size_(0), peakSize_(0), userBuffer_(0), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
     {
     }
 
@@ -123,7 +127,7 @@ public:
         \param baseAllocator The allocator for allocating memory chunks.
     */
     MemoryPoolAllocator(void *buffer, size_t size, size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) :
-        chunkHead_(0), chunk_capacity_(chunkSize), userBuffer_(buffer), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+        chunkHead_(0), spareHead_(0), chunk_capacity_(chunkSize), size_(0), peakSize_(0), userBuffer_(buffer), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
     {
         RAPIDJSON_ASSERT(buffer != 0);
         RAPIDJSON_ASSERT(size > sizeof(ChunkHeader));
@@ -150,26 +154,63 @@ public:
         }
         if (chunkHead_ && chunkHead_ == userBuffer_)
             chunkHead_->size = 0; // Clear user buffer
+        while (spareHead_) {
+            ChunkHeader* next = spareHead_->next;
+            baseAllocator_->Free(spareHead_);
+            spareHead_ = next;
+        }
+        size_ = 0;
+    }
+
+    //! Releases all memory blocks but keeps the chunks for reuse.
+    /*! Like Clear(), this invalidates every block allocated so far. The chunks are
+        kept and served again, in their original order, before BaseAllocator is asked
+        for a new one. Allocating the same pattern after each Reset() thus needs no
+        chunk allocation at all once the high-water mark has been reached.
+    */
+    void Reset() {
+        while (chunkHead_ && chunkHead_ != userBuffer_) {
+            ChunkHeader* next = chunkHead_->next;
+            chunkHead_->size = 0;
+            chunkHead_->next = spareHead_;
+            spareHead_ = chunkHead_;
+            chunkHead_ = next;
+        }
+        if (chunkHead_ && chunkHead_ == userBuffer_)
+            chunkHead_->size = 0; // Clear user buffer
+        size_ = 0;
     }
 
     //! Computes the total capacity of allocated memory chunks.
-    /*! \return total capacity in bytes.
+    /*! \return total capacity in bytes, including chunks kept by Reset().
     */
     size_t Capacity() const {
         size_t capacity = 0;
         for (ChunkHeader* c = chunkHead_; c != 0; c = c->next)
             capacity += c->capacity;
+        for (ChunkHeader* c = spareHead_; c != 0; c = c->next)
+            capacity += c->capacity;
         return capacity;
     }
 
     //! Computes the memory blocks allocated.
     /*! \return total used bytes.
     */
-    size_t Size() const {
-        size_t size = 0;
+    size_t Size() const { return size_; }
+
+    //! High-water mark of Size() since construction.
+    /*! \return maximum number of used bytes at any time, across Clear() and Reset().
+    */
+    size_t PeakSize() const { return peakSize_; }
+
+    //! Counts the memory chunks, including the user buffer and chunks kept by Reset().
+    size_t ChunkCount() const {
+        size_t count = 0;
         for (ChunkHeader* c = chunkHead_; c != 0; c = c->next)
-            size += c->size;
-        return size;
+            count++;
+        for (ChunkHeader* c = spareHead_; c != 0; c = c->next)
+            count++;
+        return count;
     }
 
     //! Allocates a memory block. (concept Allocator)
@@ -184,6 +225,7 @@ public:
 
         void *buffer = reinterpret_cast<char *>(chunkHead_) + RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + chunkHead_->size;
         chunkHead_->size += size;
+        AddSize(size);
         return buffer;
     }
 
@@ -207,6 +249,7 @@ public:
             size_t increment = static_cast<size_t>(newSize - originalSize);
             if (chunkHead_->size + increment <= chunkHead_->capacity) {
                 chunkHead_->size += increment;
+                AddSize(increment);
                 return originalPtr;
             }
         }
@@ -230,11 +273,20 @@ private:
     //! Copy assignment operator is not permitted.
     MemoryPoolAllocator& operator=(const MemoryPoolAllocator& rhs) /* = delete */;
 
-    //! Creates a new chunk.
+    //! Creates a new chunk, or takes back one kept by Reset().
     /*! \param capacity Capacity of the chunk in bytes.
         \return true if success.
     */
     bool AddChunk(size_t capacity) {
+        for (ChunkHeader** c = &spareHead_; *c != 0; c = &(*c)->next)
+            if ((*c)->capacity >= capacity) {
+                ChunkHeader* chunk = *c;
+                *c = chunk->next;
+                chunk->next = chunkHead_;
+                chunkHead_ = chunk;
+                return true;
+            }
+
         if (!baseAllocator_)
             ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
         if (ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(baseAllocator_->Malloc(RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + capacity))) {
@@ -259,8 +311,17 @@ private:
         ChunkHeader *next;  //!< Next chunk in the linked list.
     };
 
+    void AddSize(size_t size) {
+        size_ += size;
+        if (size_ > peakSize_)
+            peakSize_ = size_;
+    }
+
     ChunkHeader *chunkHead_;    //!< Head of the chunk linked-list. Only the head chunk serves allocation.
+    ChunkHeader *spareHead_;    //!< Empty chunks kept by Reset(), in allocation order.
     size_t chunk_capacity_;     //!< The minimum capacity of chunk when they are allocated.
+    size_t size_;               //!< Bytes of memory blocks currently allocated.
+    size_t peakSize_;           //!< High-water mark of size_.
     void *userBuffer_;          //!< User supplied buffer.
     BaseAllocator* baseAllocator_;  //!< base allocator for allocating memory chunks.
     BaseAllocator* ownBaseAllocator_;   //!< base allocator created by this object.
@@ -61,6 +61,9 @@ class GenericValue;
 template <typename Encoding, typename Allocator, typename StackAllocator>
 class GenericDocument;
 
+template <typename Encoding, typename Allocator>
+class GenericInternPool;
+
 //! Name-value pair in a JSON object value.
 /*!
     This class was internal to GenericValue. It used to be a inner struct.
@@ -400,6 +403,24 @@ template <typename T> struct IsGenericValueImpl<T, typename Void<typename T::Enc
 // helper to match arbitrary GenericValue instantiations, including derived classes
 template <typename T> struct IsGenericValue : IsGenericValueImpl<T>::Type {};
 
+// handlers declaring bool Float(float), e.g. Writer and PrettyWriter
+template <typename Handler>
+class HasFloatHandlerImpl {
+    template <typename U, bool (U::*)(float)> struct Check {};
+    template <typename U> static char Test(Check<U, &U::Float>*);
+    template <typename U> static int Test(...);
+public:
+    enum { Value = sizeof(Test<Handler>(0)) == sizeof(char) };
+};
+
+template <typename Handler> struct HasFloatHandler : BoolType<HasFloatHandlerImpl<Handler>::Value> {};
+
+template <typename Handler>
+inline bool AcceptFloat(Handler& handler, float f, TrueType) { return handler.Float(f); }
+
+template <typename Handler>
+inline bool AcceptFloat(Handler& handler, float f, FalseType) { return handler.Double(static_cast<double>(f)); }
+
 } // namespace internal
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -523,6 +544,36 @@ struct TypeHelper<ValueType, typename ValueType::ConstObject> {
 template <bool, typename> class GenericArray;
 template <bool, typename> class GenericObject;
 
+///////////////////////////////////////////////////////////////////////////////
+// Interned strings
+
+namespace internal {
+
+//! Header stored in front of every string owned by a GenericInternPool.
+struct InternedStringHeader {
+    const void* pool;   //!< Owning pool, strings of the same pool are equal iff their addresses are.
+    SizeType hash;      //!< HashString() of the string.
+    SizeType length;    //!< Length in code units, without the terminating null.
+};
+
+//! FNV-1a over the code units of a string.
+template <typename Ch>
+inline SizeType HashString(const Ch* s, SizeType length) {
+    uint32_t h = 2166136261u;
+    for (SizeType i = 0; i < length; i++) {
+        h ^= static_cast<uint32_t>(s[i]);
+        h *= 16777619u;
+    }
+    return static_cast<SizeType>(h);
+}
+
+template <typename Ch>
+inline const InternedStringHeader* GetInternedStringHeader(const Ch* s) {
+    return reinterpret_cast<const InternedStringHeader*>(s) - 1;
+}
+
+} // namespace internal
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericValue
 
@@ -672,6 +723,13 @@ public:
     //! Constructor for double value.
     explicit GenericValue(double d) RAPIDJSON_NOEXCEPT : data_() { data_.n.d = d; data_.f.flags = kNumberDoubleFlag; }
 
+    //! Constructor for float value.
+    /*! The value holds \c f promoted to double, and remembers that it was a float:
+        Accept() passes it to Float() of handlers which have it, e.g. \ref Writer,
+        which writes the shortest form, 0.3 instead of 0.30000001192092896 for 0.3f.
+    */
+    explicit GenericValue(float f) RAPIDJSON_NOEXCEPT : data_() { data_.n.d = static_cast<double>(f); data_.f.flags = kNumberFloatFlag; }
+
     //! Constructor for constant string (i.e. do not make a copy of string)
     GenericValue(const Ch* s, SizeType length) RAPIDJSON_NOEXCEPT : data_() { SetStringRaw(StringRef(s, length)); }
 
@@ -988,6 +1046,8 @@ public:
     bool IsFloat() const  {
         if ((data_.f.flags & kDoubleFlag) == 0)
             return false;
+        if ((data_.f.flags & kFloatFlag) != 0)
+            return true;
         double d = GetDouble();
         return d >= -3.4028234e38 && d <= 3.4028234e38;
     }
@@ -1047,7 +1107,8 @@ public:
         Since 0.2, if the name is not correct, it will assert.
         If user is unsure whether a member exists, user should use HasMember() first.
         A better approach is to use FindMember().
-        \note Linear time complexity.
+        \note Linear time complexity, constant time on objects holding a member index
+            (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD).
     */
     template <typename T>
     RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(GenericValue&)) operator[](T* name) {
@@ -1055,7 +1116,10 @@ public:
         return (*this)[n];
     }
     template <typename T>
-    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(const GenericValue&)) operator[](T* name) const { return const_cast<GenericValue&>(*this)[name]; }
+    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(const GenericValue&)) operator[](T* name) const {
+        GenericValue n(StringRef(name));
+        return (*this)[n];
+    }
 
     //! Get a value from an object associated with the name.
     /*! \pre IsObject() == true
@@ -1064,7 +1128,8 @@ public:
         \note Compared to \ref operator[](T*), this version is faster because it does not need a StrLen().
         And it can also handle strings with embedded null characters.
 
-        \note Linear time complexity.
+        \note Linear time complexity, constant time on objects holding a member index
+            (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD).
     */
     template <typename SourceAllocator>
     GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) {
@@ -1084,7 +1149,16 @@ public:
         }
     }
     template <typename SourceAllocator>
-    const GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) const { return const_cast<GenericValue&>(*this)[name]; }
+    const GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) const {
+        ConstMemberIterator member = FindMember(name);
+        if (member != MemberEnd())
+            return member->value;
+        else {
+            RAPIDJSON_ASSERT(false);    // see above note
+            static char buffer[sizeof(GenericValue)];
+            return *new (buffer) GenericValue();
+        }
+    }
 
 #if RAPIDJSON_HAS_STDSTRING
     //! Get a value from an object associated with name (string object).
@@ -1149,14 +1223,18 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, constant time on objects holding a member index
+            (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD).
     */
     MemberIterator FindMember(const Ch* name) {
         GenericValue n(StringRef(name));
         return FindMember(n);
     }
 
-    ConstMemberIterator FindMember(const Ch* name) const { return const_cast<GenericValue&>(*this).FindMember(name); }
+    ConstMemberIterator FindMember(const Ch* name) const {
+        GenericValue n(StringRef(name));
+        return FindMember(n);
+    }
 
     //! Find member by name.
     /*!
@@ -1169,19 +1247,60 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, constant time on objects holding a member index
+            (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD). The non-const overloads build
+            the index on first use, the const overloads only use an index already built.
     */
     template <typename SourceAllocator>
     MemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) {
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(name.IsString());
-        MemberIterator member = MemberBegin();
-        for ( ; member != MemberEnd(); ++member)
-            if (name.StringEqual(member->name))
-                break;
-        return member;
+#if RAPIDJSON_MEMBER_INDEX_THRESHOLD
+        if (data_.o.size >= RAPIDJSON_MEMBER_INDEX_THRESHOLD) {
+            SizeType pos;
+            if (!FindMemberIndexed(name, &pos)) { // not built yet, or stale
+                FillMemberIndex(GetMemberIndex());
+                FindMemberIndexed(name, &pos);
+            }
+            return MemberBegin() + pos;
+        }
+#endif
+        return MemberBegin() + FindMemberLinear(name);
+    }
+    template <typename SourceAllocator>
+    ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const {
+        RAPIDJSON_ASSERT(IsObject());
+        RAPIDJSON_ASSERT(name.IsString());
+#if RAPIDJSON_MEMBER_INDEX_THRESHOLD
+        SizeType pos;
+        if (data_.o.size >= RAPIDJSON_MEMBER_INDEX_THRESHOLD && FindMemberIndexed(name, &pos))
+            return MemberBegin() + pos;
+#endif
+        return MemberBegin() + FindMemberLinear(name);
+    }
+
+    //! Builds the member index of a large object.
+    /*! Lookups through a non-const object build the index on first use. Lookups through a
+        const object, e.g. from several threads sharing a document, only use an index which
+        is already built: call this first to give them constant time lookups.
+
+        The index follows AddMember(), RemoveMember(), EraseMember() and members reordered
+        through iterators. Call this again after changing the name of a member in place,
+        e.g. with \c SetString() through an iterator, since lookups of the new name may
+        otherwise fail.
+
+        Does nothing on objects whose capacity is below \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD.
+        \pre IsObject() == true
+        \return The value itself for fluent API.
+    */
+    GenericValue& BuildMemberIndex() {
+        RAPIDJSON_ASSERT(IsObject());
+#if RAPIDJSON_MEMBER_INDEX_THRESHOLD
+        if (MemberIndex* index = GetMemberIndex())
+            FillMemberIndex(index);
+#endif
+        return *this;
     }
-    template <typename SourceAllocator> ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const { return const_cast<GenericValue&>(*this).FindMember(name); }
 
 #if RAPIDJSON_HAS_STDSTRING
     //! Find member by string object name.
@@ -1213,17 +1332,26 @@ public:
         if (o.size >= o.capacity) {
             if (o.capacity == 0) {
                 o.capacity = kDefaultObjectCapacity;
-                SetMembersPointer(reinterpret_cast<Member*>(allocator.Malloc(o.capacity * sizeof(Member))));
+                SetMembersPointer(reinterpret_cast<Member*>(allocator.Malloc(MembersSize(o.capacity))));
             }
             else {
                 SizeType oldCapacity = o.capacity;
                 o.capacity += (oldCapacity + 1) / 2; // grow by factor 1.5
-                SetMembersPointer(reinterpret_cast<Member*>(allocator.Realloc(GetMembersPointer(), oldCapacity * sizeof(Member), o.capacity * sizeof(Member))));
+                SetMembersPointer(reinterpret_cast<Member*>(allocator.Realloc(GetMembersPointer(), MembersSize(oldCapacity), MembersSize(o.capacity))));
             }
+            InvalidateMemberIndex();
         }
         Member* members = GetMembersPointer();
         members[o.size].name.RawAssign(name);
         members[o.size].value.RawAssign(value);
+#if RAPIDJSON_MEMBER_INDEX_THRESHOLD
+        if (MemberIndex* index = GetMemberIndex()) {
+            if (index->count == o.size) { // keep a built index up to date
+                InsertMemberIndex(index, HashMemberName(members[o.size].name), o.size);
+                index->count++;
+            }
+        }
+#endif
         o.size++;
         return *this;
     }
@@ -1361,6 +1489,7 @@ public:
         for (MemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
             m->~Member();
         data_.o.size = 0;
+        InvalidateMemberIndex();
     }
 
     //! Remove a member in object by its name.
@@ -1411,6 +1540,7 @@ public:
         else
             m->~Member(); // Only one left, just destroy
         --data_.o.size;
+        InvalidateMemberIndex();
         return m;
     }
 
@@ -1449,6 +1579,7 @@ public:
             itr->~Member();
         std::memmove(&*pos, &*last, static_cast<size_t>(MemberEnd() - last) * sizeof(Member));
         data_.o.size -= static_cast<SizeType>(last - first);
+        InvalidateMemberIndex();
         return pos;
     }
 
@@ -1700,6 +1831,13 @@ public:
     //!@name String
     //@{
 
+    //! Get the string.
+    /*! \warning The string is not null-terminated if it was parsed with \ref kParseNoCopyStringsFlag
+            (ParseNoCopy()) or set from a StringRef() without a terminator: it then points into
+            the source buffer and ends at GetStringLength(). Do not pass it to functions
+            expecting a C string, such as strcmp() or printf("%s"), unless the value is known
+            to be copied.
+    */
     const Ch* GetString() const { RAPIDJSON_ASSERT(IsString()); return (data_.f.flags & kInlineStrFlag) ? data_.ss.str : GetStringPointer(); }
 
     //! Get the length of string.
@@ -1818,7 +1956,9 @@ public:
     
         default:
             RAPIDJSON_ASSERT(GetType() == kNumberType);
-            if (IsDouble())         return handler.Double(data_.n.d);
+            if ((data_.f.flags & kFloatFlag) != 0)
+                return internal::AcceptFloat(handler, static_cast<float>(data_.n.d), internal::HasFloatHandler<Handler>());
+            else if (IsDouble())    return handler.Double(data_.n.d);
             else if (IsInt())       return handler.Int(data_.n.i.i);
             else if (IsUint())      return handler.Uint(data_.n.u.u);
             else if (IsInt64())     return handler.Int64(data_.n.i64);
@@ -1829,6 +1969,7 @@ public:
 private:
     template <typename, typename> friend class GenericValue;
     template <typename, typename, typename> friend class GenericDocument;
+    template <typename, typename> friend class GenericInternPool;
 
     enum {
         kBoolFlag       = 0x0008,
@@ -1841,6 +1982,8 @@ private:
         kStringFlag     = 0x0400,
         kCopyFlag       = 0x0800,
         kInlineStrFlag  = 0x1000,
+        kInternFlag     = 0x2000,
+        kFloatFlag      = 0x4000,
 
         // Initial flags of different types.
         kNullFlag = kNullType,
@@ -1851,10 +1994,12 @@ private:
         kNumberInt64Flag = kNumberType | kNumberFlag | kInt64Flag,
         kNumberUint64Flag = kNumberType | kNumberFlag | kUint64Flag,
         kNumberDoubleFlag = kNumberType | kNumberFlag | kDoubleFlag,
+        kNumberFloatFlag = kNumberType | kNumberFlag | kDoubleFlag | kFloatFlag,
         kNumberAnyFlag = kNumberType | kNumberFlag | kIntFlag | kInt64Flag | kUintFlag | kUint64Flag | kDoubleFlag,
         kConstStringFlag = kStringType | kStringFlag,
         kCopyStringFlag = kStringType | kStringFlag | kCopyFlag,
         kShortStringFlag = kStringType | kStringFlag | kCopyFlag | kInlineStrFlag,
+        kInternStringFlag = kStringType | kStringFlag | kInternFlag,
         kObjectFlag = kObjectType,
         kArrayFlag = kArrayType,
 
@@ -1969,13 +2114,136 @@ private:
     void SetObjectRaw(Member* members, SizeType count, Allocator& allocator) {
         data_.f.flags = kObjectFlag;
         if (count) {
-            Member* m = static_cast<Member*>(allocator.Malloc(count * sizeof(Member)));
+            Member* m = static_cast<Member*>(allocator.Malloc(MembersSize(count)));
             SetMembersPointer(m);
             std::memcpy(m, members, count * sizeof(Member));
         }
         else
             SetMembersPointer(0);
         data_.o.size = data_.o.capacity = count;
+        InvalidateMemberIndex();
+    }
+
+#if RAPIDJSON_MEMBER_INDEX_THRESHOLD
+    // Objects with a capacity of at least RAPIDJSON_MEMBER_INDEX_THRESHOLD members
+    // carry an open-addressing hash table in the same allocation, right after the
+    // member array. It is (re)built on demand by the non-const FindMember() and by
+    // BuildMemberIndex(), extended in place by AddMember() and invalidated by anything
+    // that removes members. Members reordered through iterators are detected by lookups,
+    // which then treat the index as stale.
+    struct MemberIndex {
+        SizeType count;     //!< number of indexed members, kInvalidMemberIndex if stale
+        SizeType mask;      //!< bucket count - 1
+    };
+
+    struct MemberIndexBucket {
+        SizeType hash;
+        SizeType pos;       //!< member position + 1, 0 for an empty bucket
+    };
+
+    static const SizeType kInvalidMemberIndex = ~SizeType(0);
+
+    //! Bucket count for a capacity, power of two with a load factor of at most 0.5.
+    static SizeType MemberIndexBuckets(SizeType capacity) {
+        SizeType n = 1;
+        while (n < capacity * 2)
+            n <<= 1;
+        return n;
+    }
+
+    //! Bytes to allocate for the member array of the given capacity.
+    static size_t MembersSize(SizeType capacity) {
+        size_t size = capacity * sizeof(Member);
+        if (capacity >= RAPIDJSON_MEMBER_INDEX_THRESHOLD)
+            size += sizeof(MemberIndex) + MemberIndexBuckets(capacity) * sizeof(MemberIndexBucket);
+        return size;
+    }
+
+    MemberIndex* GetMemberIndex() const {
+        if (data_.o.capacity < RAPIDJSON_MEMBER_INDEX_THRESHOLD)
+            return 0;
+        return reinterpret_cast<MemberIndex*>(GetMembersPointer() + data_.o.capacity);
+    }
+
+    static MemberIndexBucket* GetMemberIndexBuckets(MemberIndex* index) {
+        return reinterpret_cast<MemberIndexBucket*>(index + 1);
+    }
+
+    static const MemberIndexBucket* GetMemberIndexBuckets(const MemberIndex* index) {
+        return reinterpret_cast<const MemberIndexBucket*>(index + 1);
+    }
+
+    void InvalidateMemberIndex() {
+        if (MemberIndex* index = GetMemberIndex())
+            index->count = kInvalidMemberIndex;
+    }
+
+    //! FNV-1a over the code units of a member name, precomputed for interned names.
+    template <typename SourceAllocator>
+    static SizeType HashMemberName(const GenericValue<Encoding, SourceAllocator>& name) {
+        if (name.data_.f.flags & kInternFlag)
+            return internal::GetInternedStringHeader(name.GetStringPointer())->hash;
+        return internal::HashString(name.GetString(), name.GetStringLength());
+    }
+
+    //! Linear probing, earlier members win on duplicate names like the linear scan does.
+    static void InsertMemberIndex(MemberIndex* index, SizeType hash, SizeType pos) {
+        MemberIndexBucket* buckets = GetMemberIndexBuckets(index);
+        SizeType i = hash & index->mask;
+        while (buckets[i].pos != 0)
+            i = (i + 1) & index->mask;
+        buckets[i].hash = hash;
+        buckets[i].pos = pos + 1;
+    }
+
+    void FillMemberIndex(MemberIndex* index) {
+        index->mask = MemberIndexBuckets(data_.o.capacity) - 1;
+        std::memset(GetMemberIndexBuckets(index), 0, (index->mask + 1) * sizeof(MemberIndexBucket));
+        const Member* members = GetMembersPointer();
+        for (SizeType i = 0; i < data_.o.size; i++)
+            InsertMemberIndex(index, HashMemberName(members[i].name), i);
+        index->count = data_.o.size;
+    }
+
+    //! Looks a name up in the index, without modifying it.
+    /*! Returns false if the index is not built or does not match the members any more.
+        Otherwise sets *pos to the position of the member, or to the member count if there is none.
+    */
+    template <typename SourceAllocator>
+    bool FindMemberIndexed(const GenericValue<Encoding, SourceAllocator>& name, SizeType* pos) const {
+        const MemberIndex* index = GetMemberIndex();
+        RAPIDJSON_ASSERT(index != 0);
+        if (index->count != data_.o.size)
+            return false;
+
+        const SizeType hash = HashMemberName(name);
+        const MemberIndexBucket* buckets = GetMemberIndexBuckets(index);
+        const Member* members = GetMembersPointer();
+        for (SizeType i = hash & index->mask; buckets[i].pos != 0; i = (i + 1) & index->mask)
+            if (buckets[i].hash == hash) {
+                const Member& m = members[buckets[i].pos - 1];
+                if (name.StringEqual(m.name)) {
+                    *pos = buckets[i].pos - 1;
+                    return true;
+                }
+                if (HashMemberName(m.name) != hash) // members were reordered since the index was built
+                    return false;
+            }
+        *pos = data_.o.size;
+        return true;
+    }
+#else
+    static size_t MembersSize(SizeType capacity) { return capacity * sizeof(Member); }
+    void InvalidateMemberIndex() {}
+#endif // RAPIDJSON_MEMBER_INDEX_THRESHOLD
+
+    template <typename SourceAllocator>
+    SizeType FindMemberLinear(const GenericValue<Encoding, SourceAllocator>& name) const {
+        const Member* members = GetMembersPointer();
+        SizeType i = 0;
+        while (i < data_.o.size && !name.StringEqual(members[i].name))
+            i++;
+        return i;
     }
 
     //! Initialize this value as constant string, without calling destructor.
@@ -1985,6 +2253,13 @@ private:
         data_.s.length = s.length;
     }
 
+    //! Initialize this value as a string owned by a GenericInternPool, without calling destructor.
+    void SetInternedStringRaw(const Ch* s, SizeType length) RAPIDJSON_NOEXCEPT {
+        data_.f.flags = kInternStringFlag;
+        SetStringPointer(s);
+        data_.s.length = length;
+    }
+
     //! Initialize this value as copy string with initial data, without calling destructor.
     void SetStringRaw(StringRefType s, Allocator& allocator) {
         Ch* str = 0;
@@ -2022,6 +2297,10 @@ private:
         const Ch* const str2 = rhs.GetString();
         if(str1 == str2) { return true; } // fast path for constant string
 
+        if ((data_.f.flags & rhs.data_.f.flags & kInternFlag) &&
+            internal::GetInternedStringHeader(str1)->pool == internal::GetInternedStringHeader(str2)->pool)
+            return false; // distinct strings of the same intern pool
+
         return (std::memcmp(str1, str2, sizeof(Ch) * len1) == 0);
     }
 
@@ -2031,6 +2310,176 @@ private:
 //! GenericValue with UTF8 encoding
 typedef GenericValue<UTF8<> > Value;
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericInternPool
+
+//! A set of interned strings which documents use for their member names.
+/*!
+    Documents of a repeated shape copy the same member names again with every
+    parse. A document with an intern pool attached (see
+    GenericDocument::SetInternPool()) stores each key found in the pool as a
+    constant string referring to the pool instead: nothing is copied into the
+    document allocator, and two names interned by the same pool are compared
+    by address only. The hashed member index (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD)
+    uses the hash stored with the interned name instead of hashing it again.
+
+    Documents only look strings up, keys not in the pool are stored as usual.
+    A pool can therefore be shared by documents parsed in different threads,
+    as long as no Intern() call runs concurrently.
+
+    \code
+    InternPool pool;
+    pool.InternMemberNames(firstSnapshot);  // or Intern() every known key
+
+    Document d;
+    d.SetInternPool(&pool).Parse(json);
+    \endcode
+
+    \tparam Encoding Encoding of the strings.
+    \tparam Allocator Allocator for the strings and the hash table.
+    \note The pool must outlive every value referring to its strings.
+*/
+template <typename Encoding, typename Allocator = MemoryPoolAllocator<> >
+class GenericInternPool {
+public:
+    typedef typename Encoding::Ch Ch;   //!< Character type derived from Encoding.
+    typedef Allocator AllocatorType;    //!< Allocator type from template parameter.
+
+    //! Constructor.
+    /*! \param allocator Allocator for the strings and the table. If it is null, a self-owned one is created.
+    */
+    explicit GenericInternPool(Allocator* allocator = 0) : allocator_(allocator), ownAllocator_(), buckets_(), mask_(), size_() {
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+    }
+
+    //! Destructor.
+    ~GenericInternPool() {
+        Clear();
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Intern a string.
+    /*! \return The pool's null-terminated copy of the string, the same pointer for every equal string.
+    */
+    const Ch* Intern(const Ch* str, SizeType length) {
+        RAPIDJSON_ASSERT(str != 0 || length == 0);
+        const SizeType hash = internal::HashString(str, length);
+        if (const Ch* s = Find(str, length, hash))
+            return s;
+
+        if ((size_ + 1) * 2 > mask_ + 1)
+            Rehash(mask_ ? (mask_ + 1) * 2 : kDefaultCapacity);
+
+        Header* header = static_cast<Header*>(allocator_->Malloc(sizeof(Header) + (length + 1) * sizeof(Ch)));
+        header->pool = this;
+        header->hash = hash;
+        header->length = length;
+        Ch* s = reinterpret_cast<Ch*>(header + 1);
+        std::memcpy(s, str, length * sizeof(Ch));
+        s[length] = '\0';
+        Insert(s, hash);
+        size_++;
+        return s;
+    }
+
+    //! Intern a null-terminated string.
+    const Ch* Intern(const Ch* str) { return Intern(str, internal::StrLen(str)); }
+
+    //! Intern the names of all members of a value and of its descendants.
+    template <typename ValueType>
+    void InternMemberNames(const ValueType& value) {
+        if (value.IsObject()) {
+            for (typename ValueType::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m) {
+                Intern(m->name.GetString(), m->name.GetStringLength());
+                InternMemberNames(m->value);
+            }
+        }
+        else if (value.IsArray())
+            for (typename ValueType::ConstValueIterator v = value.Begin(); v != value.End(); ++v)
+                InternMemberNames(*v);
+    }
+
+    //! Look up a string without interning it.
+    /*! \return The pool's copy of the string, or null if it was not interned.
+    */
+    const Ch* Find(const Ch* str, SizeType length) const {
+        return size_ ? Find(str, length, internal::HashString(str, length)) : 0;
+    }
+
+    //! Number of interned strings.
+    SizeType GetSize() const { return size_; }
+
+    //! Remove all strings.
+    /*! \note Invalidates every value referring to a string of this pool.
+    */
+    void Clear() {
+        if (Allocator::kNeedFree)
+            for (SizeType i = 0; buckets_ && i <= mask_; i++)
+                if (buckets_[i].str)
+                    Allocator::Free(const_cast<Header*>(internal::GetInternedStringHeader(buckets_[i].str)));
+        Allocator::Free(buckets_);
+        buckets_ = 0;
+        mask_ = 0;
+        size_ = 0;
+    }
+
+    //! Get the allocator of this pool.
+    Allocator& GetAllocator() { return *allocator_; }
+
+private:
+    GenericInternPool(const GenericInternPool&);
+    GenericInternPool& operator=(const GenericInternPool&);
+
+    typedef internal::InternedStringHeader Header;
+
+    struct Bucket {
+        const Ch* str;      //!< null for an empty bucket
+        SizeType hash;
+    };
+
+    static const SizeType kDefaultCapacity = 256;
+
+    const Ch* Find(const Ch* str, SizeType length, SizeType hash) const {
+        if (!buckets_)
+            return 0;
+        for (SizeType i = hash & mask_; buckets_[i].str; i = (i + 1) & mask_)
+            if (buckets_[i].hash == hash && internal::GetInternedStringHeader(buckets_[i].str)->length == length &&
+                std::memcmp(buckets_[i].str, str, length * sizeof(Ch)) == 0)
+                return buckets_[i].str;
+        return 0;
+    }
+
+    void Insert(const Ch* s, SizeType hash) {
+        SizeType i = hash & mask_;
+        while (buckets_[i].str)
+            i = (i + 1) & mask_;
+        buckets_[i].str = s;
+        buckets_[i].hash = hash;
+    }
+
+    void Rehash(SizeType bucketCount) {
+        Bucket* old = buckets_;
+        const SizeType oldCount = old ? mask_ + 1 : 0;
+        buckets_ = static_cast<Bucket*>(allocator_->Malloc(bucketCount * sizeof(Bucket)));
+        std::memset(buckets_, 0, bucketCount * sizeof(Bucket));
+        mask_ = bucketCount - 1;
+        for (SizeType i = 0; i < oldCount; i++)
+            if (old[i].str)
+                Insert(old[i].str, old[i].hash);
+        Allocator::Free(old);
+    }
+
+    Allocator* allocator_;
+    Allocator* ownAllocator_;
+    Bucket* buckets_;   //!< open addressing with linear probing, at most half full
+    SizeType mask_;     //!< bucket count - 1
+    SizeType size_;
+};
+
+//! GenericInternPool with UTF8 encoding
+typedef GenericInternPool<UTF8<> > InternPool;
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericDocument 
 
@@ -2048,6 +2497,7 @@ public:
     typedef typename Encoding::Ch Ch;                       //!< Character type derived from Encoding.
     typedef GenericValue<Encoding, Allocator> ValueType;    //!< Value type of the document.
     typedef Allocator AllocatorType;                        //!< Allocator type from template parameter.
+    typedef GenericInternPool<Encoding, Allocator> InternPoolType; //!< Intern pool type for member names.
 
     //! Constructor
     /*! Creates an empty document of specified type.
@@ -2070,7 +2520,7 @@ public:
         \param stackAllocator   Optional allocator for allocating memory for stack.
     */
     GenericDocument(Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity, StackAllocator* stackAllocator = 0) : 
-        allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_()
+        allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_(), internPool_()
     {
         if (!allocator_)
             ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
@@ -2083,7 +2533,8 @@ public:
           allocator_(rhs.allocator_),
           ownAllocator_(rhs.ownAllocator_),
           stack_(std::move(rhs.stack_)),
-          parseResult_(rhs.parseResult_)
+          parseResult_(rhs.parseResult_),
+          internPool_(rhs.internPool_)
     {
         rhs.allocator_ = 0;
         rhs.ownAllocator_ = 0;
@@ -2110,6 +2561,7 @@ public:
         ownAllocator_ = rhs.ownAllocator_;
         stack_ = std::move(rhs.stack_);
         parseResult_ = rhs.parseResult_;
+        internPool_ = rhs.internPool_;
 
         rhs.allocator_ = 0;
         rhs.ownAllocator_ = 0;
@@ -2131,6 +2583,7 @@ public:
         internal::Swap(allocator_, rhs.allocator_);
         internal::Swap(ownAllocator_, rhs.ownAllocator_);
         internal::Swap(parseResult_, rhs.parseResult_);
+        internal::Swap(internPool_, rhs.internPool_);
         return *this;
     }
 
@@ -2231,6 +2684,44 @@ public:
     }
     //!@}
 
+    //!@name Parse without copying from read-only string
+    //!@{
+
+    //! Parse JSON text from a read-only string, referencing its strings without escapes
+    /*! Strings without escapes refer into \c str, which must outlive the document.
+        Strings with escapes are unescaped into the allocator of the document, as
+        with Parse().
+        \warning Referenced strings are \b not null-terminated: GetString() is
+            followed by the closing quote of the source. Read them with
+            GetStringLength(), or compare them with operator==, never as C strings.
+        \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \param str Read-only zero-terminated string to be parsed.
+        \return The document itself for fluent API.
+        \see kParseNoCopyStringsFlag
+    */
+    template <unsigned parseFlags>
+    GenericDocument& ParseNoCopy(const Ch* str) {
+        return Parse<parseFlags | kParseNoCopyStringsFlag>(str);
+    }
+
+    //! Parse JSON text from a read-only string, referencing its strings without escapes (with \ref kParseDefaultFlags)
+    GenericDocument& ParseNoCopy(const Ch* str) {
+        return ParseNoCopy<kParseDefaultFlags>(str);
+    }
+
+    //! Parse JSON text from a read-only buffer of \c length characters, referencing its strings without escapes
+    /*! \see ParseNoCopy(const Ch*)
+    */
+    template <unsigned parseFlags>
+    GenericDocument& ParseNoCopy(const Ch* str, size_t length) {
+        return Parse<parseFlags | kParseNoCopyStringsFlag>(str, length);
+    }
+
+    GenericDocument& ParseNoCopy(const Ch* str, size_t length) {
+        return ParseNoCopy<kParseDefaultFlags>(str, length);
+    }
+    //!@}
+
     //!@name Parse from read-only string
     //!@{
 
@@ -2335,6 +2826,20 @@ public:
     //! Get the capacity of stack in bytes.
     size_t GetStackCapacity() const { return stack_.GetCapacity(); }
 
+    //! Attach an intern pool for the member names of subsequent parses.
+    /*! Keys found in the pool are stored as references to the pool's strings,
+        other keys are copied as usual. Pass null to detach the pool.
+        \return The document itself for fluent API.
+        \see GenericInternPool
+    */
+    GenericDocument& SetInternPool(const InternPoolType* internPool) {
+        internPool_ = internPool;
+        return *this;
+    }
+
+    //! Get the attached intern pool, null if there is none.
+    const InternPoolType* GetInternPool() const { return internPool_; }
+
 private:
     // clear stack on any exit from ParseStream, e.g. due to exception
     struct ClearStackOnExit {
@@ -2359,6 +2864,7 @@ public:
     bool Int64(int64_t i) { new (stack_.template Push<ValueType>()) ValueType(i); return true; }
     bool Uint64(uint64_t i) { new (stack_.template Push<ValueType>()) ValueType(i); return true; }
     bool Double(double d) { new (stack_.template Push<ValueType>()) ValueType(d); return true; }
+    bool Float(float f) { new (stack_.template Push<ValueType>()) ValueType(f); return true; }
 
     bool RawNumber(const Ch* str, SizeType length, bool copy) { 
         if (copy) 
@@ -2378,7 +2884,14 @@ public:
 
     bool StartObject() { new (stack_.template Push<ValueType>()) ValueType(kObjectType); return true; }
     
-    bool Key(const Ch* str, SizeType length, bool copy) { return String(str, length, copy); }
+    bool Key(const Ch* str, SizeType length, bool copy) {
+        if (internPool_)
+            if (const Ch* s = internPool_->Find(str, length)) {
+                (new (stack_.template Push<ValueType>()) ValueType())->SetInternedStringRaw(s, length);
+                return true;
+            }
+        return String(str, length, copy);
+    }
 
     bool EndObject(SizeType memberCount) {
         typename ValueType::Member* members = stack_.template Pop<typename ValueType::Member>(memberCount);
@@ -2418,6 +2931,7 @@ private:
     Allocator* ownAllocator_;
     internal::Stack<StackAllocator> stack_;
     ParseResult parseResult_;
+    const InternPoolType* internPool_;
 };
 
 //! GenericDocument with UTF8 encoding
@@ -2438,7 +2952,7 @@ GenericValue<Encoding,Allocator>::GenericValue(const GenericValue<Encoding,Sourc
         }
         break;
     case kStringType:
-        if (rhs.data_.f.flags == kConstStringFlag) {
+        if (rhs.data_.f.flags == kConstStringFlag || rhs.data_.f.flags == kInternStringFlag) {
             data_.f.flags = rhs.data_.f.flags;
             data_  = *reinterpret_cast<const Data*>(&rhs.data_);
         } else {
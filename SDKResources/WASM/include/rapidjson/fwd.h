@@ -41,6 +41,13 @@ class CrtAllocator;
 template <typename BaseAllocator>
 class MemoryPoolAllocator;
 
+// instrumentedallocator.h
+
+struct AllocationStats;
+
+template <typename BaseAllocator>
+class InstrumentedAllocator;
+
 // stream.h
 
 template <typename Encoding>
@@ -60,6 +67,18 @@ class GenericStringBuffer;
 
 typedef GenericStringBuffer<UTF8<char>, CrtAllocator> StringBuffer;
 
+// segmentedbuffer.h
+
+template <typename BaseAllocator>
+class GenericSegmentPool;
+
+typedef GenericSegmentPool<CrtAllocator> SegmentPool;
+
+template <typename Encoding, typename BaseAllocator>
+class GenericSegmentedBuffer;
+
+typedef GenericSegmentedBuffer<UTF8<char>, CrtAllocator> SegmentedBuffer;
+
 // filereadstream.h
 
 class FileReadStream;
@@ -79,6 +98,10 @@ typedef GenericMemoryBuffer<CrtAllocator> MemoryBuffer;
 
 struct MemoryStream;
 
+// memorymappedfile.h
+
+class MemoryMappedFile;
+
 // reader.h
 
 template<typename Encoding, typename Derived>
@@ -89,6 +112,23 @@ class GenericReader;
 
 typedef GenericReader<UTF8<char>, UTF8<char>, CrtAllocator> Reader;
 
+// pushreader.h
+
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator>
+class GenericPushReader;
+
+typedef GenericPushReader<UTF8<char>, UTF8<char>, CrtAllocator> PushReader;
+
+// msgpack.h
+
+template<typename OutputStream, typename StackAllocator>
+class MsgPackWriter;
+
+template <typename StackAllocator>
+class GenericMsgPackReader;
+
+typedef GenericMsgPackReader<CrtAllocator> MsgPackReader;
+
 // writer.h
 
 template<typename OutputStream, typename SourceEncoding, typename TargetEncoding, typename StackAllocator, unsigned writeFlags>
@@ -120,6 +160,37 @@ class GenericDocument;
 
 typedef GenericDocument<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> Document;
 
+template <typename Encoding, typename Allocator>
+class GenericInternPool;
+
+typedef GenericInternPool<UTF8<char>, MemoryPoolAllocator<CrtAllocator> > InternPool;
+
+// persistentvalue.h
+
+template <typename Encoding, typename Allocator>
+class GenericPersistentValue;
+
+typedef GenericPersistentValue<UTF8<char>, CrtAllocator> PersistentValue;
+
+// tape.h
+
+template <typename Encoding>
+class GenericTapeValue;
+
+typedef GenericTapeValue<UTF8<char> > TapeValue;
+
+template <typename Encoding, typename StackAllocator>
+class GenericTapeDocument;
+
+typedef GenericTapeDocument<UTF8<char>, CrtAllocator> TapeDocument;
+
+// ndjsonreader.h
+
+template <typename DocumentType>
+class GenericNdjsonReader;
+
+typedef GenericNdjsonReader<Document> NdjsonReader;
+
 // pointer.h
 
 template <typename ValueType, typename Allocator>
@@ -127,6 +198,18 @@ class GenericPointer;
 
 typedef GenericPointer<Value, CrtAllocator> Pointer;
 
+template <typename ValueType, typename Allocator>
+class GenericBoundPointer;
+
+typedef GenericBoundPointer<Value, CrtAllocator> BoundPointer;
+
+// patch.h
+
+template <typename ValueType, typename StackAllocator>
+class GenericDiffer;
+
+typedef GenericDiffer<Value, CrtAllocator> Differ;
+
 // schema.h
 
 template <typename SchemaDocumentType>
@@ -0,0 +1,387 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INSTRUMENTEDALLOCATOR_H_
+#define RAPIDJSON_INSTRUMENTEDALLOCATOR_H_
+
+#include "allocators.h"
+#include "internal/strfunc.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+/*! \def RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+    \ingroup RAPIDJSON_CONFIG
+    \brief Enable the statistics of InstrumentedAllocator (default 1).
+
+    When defined to 0, InstrumentedAllocator keeps its interface but forwards
+    every call to its base allocator, without block header nor bookkeeping.
+    Scopes cost nothing and the report is empty.
+*/
+#ifndef RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+#define RAPIDJSON_ALLOCATOR_INSTRUMENTATION 1
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Allocation statistics of one scope of an InstrumentedAllocator.
+struct AllocationStats {
+    static const unsigned kHistogramSize = 16;  //!< Number of size classes.
+
+    //! Size class of an allocation: <= 16 bytes, <= 32 bytes, ... <= 256 KB, larger.
+    static unsigned SizeClass(size_t size) {
+        unsigned c = 0;
+        for (size_t limit = 16; size > limit && c < kHistogramSize - 1; limit <<= 1)
+            c++;
+        return c;
+    }
+
+    const char* name;           //!< Tag of the scope, "" for allocations outside of any scope.
+    size_t mallocCount;         //!< Number of Malloc() calls.
+    size_t reallocCount;        //!< Number of Realloc() calls which resized a block.
+    size_t freeCount;           //!< Number of blocks freed.
+    size_t bytes;               //!< Bytes currently allocated.
+    size_t peakBytes;           //!< High-water mark of \c bytes.
+    size_t totalBytes;          //!< Bytes allocated since construction, counting the growth of reallocations.
+    size_t histogram[kHistogramSize];   //!< Number of Malloc()/Realloc() per size class, see SizeClass().
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// InstrumentedAllocator
+
+//! Allocator adaptor recording statistics per tagged scope.
+/*! Every allocation made while a Scope is alive is accounted to the tag of
+    the innermost one; a block stays accounted to that tag when it is resized
+    or freed later. Allocations outside of any scope go to the tag "".
+
+    \code
+    typedef InstrumentedAllocator<> Instrumented;
+    typedef MemoryPoolAllocator<Instrumented> Pool;
+    Instrumented instrumented;
+    Pool pool(64 * 1024, &instrumented);
+    {
+        Instrumented::Scope scope(instrumented, "flightplan");
+        GenericDocument<UTF8<>, Pool> d(&pool);
+        d.Parse(json);
+    }
+    Writer<StringBuffer> writer(report);
+    instrumented.Accept(writer);
+    \endcode
+
+    Each block carries a small header pointing to the statistics of its scope,
+    because Free() is static in the Allocator concept. The statistics outlive
+    the allocator until the last block is freed, so a GenericDocument owning
+    the allocator may free its values after deleting it.
+
+    Tags are not copied: use string literals or strings outliving the allocator.
+    The statistics are not thread-safe, like the allocators themselves.
+
+    \tparam BaseAllocator the allocator type for the blocks. Default is CrtAllocator.
+    \note implements Allocator concept
+    \see RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+*/
+template <typename BaseAllocator = CrtAllocator>
+class InstrumentedAllocator {
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+    struct Registry;
+
+    struct ScopeStats : AllocationStats {
+        ScopeStats* next;
+        Registry* registry;
+    };
+
+    struct Registry {
+        ScopeStats* head;
+        ScopeStats* current;
+        size_t blockCount;
+        size_t bytes;
+        size_t peakBytes;
+        bool orphaned;  // the allocator was destroyed, delete when blockCount drops to 0
+    };
+
+    struct Header {
+        ScopeStats* scope;
+        size_t size;
+    };
+
+    static const size_t kHeaderSize = RAPIDJSON_ALIGN(sizeof(Header));
+#endif
+
+public:
+    static const bool kNeedFree = BaseAllocator::kNeedFree;    //!< Same as the base allocator. (concept Allocator)
+
+    //! Constructor.
+    /*! \param baseAllocator The allocator for allocating blocks. If null, a BaseAllocator is created.
+    */
+    explicit InstrumentedAllocator(BaseAllocator* baseAllocator = 0) : baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        , registry_(RAPIDJSON_NEW(Registry()))
+#endif
+    {
+        if (!baseAllocator_)
+            ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        registry_->head = 0;
+        registry_->blockCount = registry_->bytes = registry_->peakBytes = 0;
+        registry_->orphaned = false;
+        registry_->current = FindOrAddScope("");
+#endif
+    }
+
+    //! Destructor.
+    /*! Blocks still allocated keep the statistics alive if they are freed later (kNeedFree).
+    */
+    ~InstrumentedAllocator() {
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        registry_->orphaned = true;
+        if (!kNeedFree || registry_->blockCount == 0)
+            DestroyRegistry(registry_);
+#endif
+        RAPIDJSON_DELETE(ownBaseAllocator_);
+    }
+
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+    void* Malloc(size_t size) {
+        if (!size)
+            return NULL;
+        Header* h = static_cast<Header*>(baseAllocator_->Malloc(kHeaderSize + size));
+        if (!h)
+            return NULL;
+        ScopeStats* s = registry_->current;
+        h->scope = s;
+        h->size = size;
+        s->mallocCount++;
+        s->histogram[AllocationStats::SizeClass(size)]++;
+        registry_->blockCount++;
+        Grow(s, size);
+        return reinterpret_cast<char*>(h) + kHeaderSize;
+    }
+
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        (void)originalSize;
+        if (originalPtr == 0)
+            return Malloc(newSize);
+        if (newSize == 0) {
+            Free(originalPtr);
+            return NULL;
+        }
+
+        Header* h = GetHeader(originalPtr);
+        ScopeStats* s = h->scope;
+        const size_t oldSize = h->size;
+        h = static_cast<Header*>(baseAllocator_->Realloc(h, kHeaderSize + oldSize, kHeaderSize + newSize));
+        if (!h)
+            return NULL;
+        h->size = newSize;
+        s->reallocCount++;
+        s->histogram[AllocationStats::SizeClass(newSize)]++;
+        if (newSize > oldSize)
+            Grow(s, newSize - oldSize);
+        else {
+            s->bytes -= oldSize - newSize;
+            s->registry->bytes -= oldSize - newSize;
+        }
+        return reinterpret_cast<char*>(h) + kHeaderSize;
+    }
+
+    static void Free(void *ptr) {
+        if (!ptr)
+            return;
+        Header* h = GetHeader(ptr);
+        if (kNeedFree) {
+            ScopeStats* s = h->scope;
+            Registry* r = s->registry;
+            s->freeCount++;
+            s->bytes -= h->size;
+            r->bytes -= h->size;
+            if (--r->blockCount == 0 && r->orphaned)
+                DestroyRegistry(r);
+        }
+        BaseAllocator::Free(h);
+    }
+#else
+    void* Malloc(size_t size) { return baseAllocator_->Malloc(size); }
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) { return baseAllocator_->Realloc(originalPtr, originalSize, newSize); }
+    static void Free(void *ptr) { BaseAllocator::Free(ptr); }
+#endif
+
+    //! Tags the allocations made during its lifetime.
+    /*! Scopes nest; the innermost one receives the allocations.
+    */
+    class Scope {
+    public:
+        //! Enters the scope \c name of \c allocator.
+        Scope(InstrumentedAllocator& allocator, const char* name)
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+            : registry_(allocator.registry_), previous_(allocator.registry_->current)
+        {
+            registry_->current = allocator.FindOrAddScope(name);
+        }
+
+        ~Scope() { registry_->current = previous_; }
+#else
+        {
+            (void)allocator;
+            (void)name;
+        }
+#endif
+
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        Registry* registry_;
+        ScopeStats* previous_;
+#endif
+    };
+
+    //! Bytes currently allocated, in all scopes.
+    size_t Size() const {
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        return registry_->bytes;
+#else
+        return 0;
+#endif
+    }
+
+    //! High-water mark of Size().
+    size_t PeakSize() const {
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        return registry_->peakBytes;
+#else
+        return 0;
+#endif
+    }
+
+    //! Statistics of a scope.
+    /*! \param name Tag of the scope, "" for allocations outside of any scope.
+        \return The statistics, or null if no scope has this tag or the instrumentation is disabled.
+    */
+    const AllocationStats* GetStats(const char* name) const {
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        for (const ScopeStats* s = registry_->head; s != 0; s = s->next)
+            if (s->name == name || std::strcmp(s->name, name) == 0)
+                return s;
+#else
+        (void)name;
+#endif
+        return 0;
+    }
+
+    //! Writes the statistics as JSON to a SAX handler, e.g. a Writer.
+    /*! The report is an object with the members \c bytes, \c peakBytes and
+        \c scopes, an array with one object per scope holding the fields of
+        AllocationStats.
+        \param handler Handler of UTF-8 events.
+        \return Whether the handler accepted every event.
+    */
+    template <typename Handler>
+    bool Accept(Handler& handler) const {
+        if (RAPIDJSON_UNLIKELY(!handler.StartObject()) ||
+            RAPIDJSON_UNLIKELY(!WriteCount(handler, "bytes", Size())) ||
+            RAPIDJSON_UNLIKELY(!WriteCount(handler, "peakBytes", PeakSize())) ||
+            RAPIDJSON_UNLIKELY(!handler.Key("scopes", 6, false)) ||
+            RAPIDJSON_UNLIKELY(!handler.StartArray()))
+            return false;
+
+        SizeType count = 0;
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+        for (const ScopeStats* s = registry_->head; s != 0; s = s->next, count++) {
+            if (RAPIDJSON_UNLIKELY(!handler.StartObject()) ||
+                RAPIDJSON_UNLIKELY(!handler.Key("name", 4, false)) ||
+                RAPIDJSON_UNLIKELY(!handler.String(s->name, internal::StrLen(s->name), false)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "mallocCount", s->mallocCount)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "reallocCount", s->reallocCount)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "freeCount", s->freeCount)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "bytes", s->bytes)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "peakBytes", s->peakBytes)) ||
+                RAPIDJSON_UNLIKELY(!WriteCount(handler, "totalBytes", s->totalBytes)) ||
+                RAPIDJSON_UNLIKELY(!handler.Key("histogram", 9, false)) ||
+                RAPIDJSON_UNLIKELY(!handler.StartArray()))
+                return false;
+            for (unsigned i = 0; i < AllocationStats::kHistogramSize; i++)
+                if (RAPIDJSON_UNLIKELY(!handler.Uint64(s->histogram[i])))
+                    return false;
+            if (RAPIDJSON_UNLIKELY(!handler.EndArray(AllocationStats::kHistogramSize)) ||
+                RAPIDJSON_UNLIKELY(!handler.EndObject(9)))
+                return false;
+        }
+#endif
+        return handler.EndArray(count) && handler.EndObject(3);
+    }
+
+private:
+    InstrumentedAllocator(const InstrumentedAllocator&);
+    InstrumentedAllocator& operator=(const InstrumentedAllocator&);
+
+    template <typename Handler>
+    static bool WriteCount(Handler& handler, const char* name, size_t value) {
+        return handler.Key(name, internal::StrLen(name), false) && handler.Uint64(value);
+    }
+
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+    static Header* GetHeader(void* ptr) {
+        return reinterpret_cast<Header*>(static_cast<char*>(ptr) - kHeaderSize);
+    }
+
+    static void Grow(ScopeStats* s, size_t size) {
+        Registry* r = s->registry;
+        s->totalBytes += size;
+        if ((s->bytes += size) > s->peakBytes)
+            s->peakBytes = s->bytes;
+        if ((r->bytes += size) > r->peakBytes)
+            r->peakBytes = r->bytes;
+    }
+
+    ScopeStats* FindOrAddScope(const char* name) {
+        ScopeStats** link = &registry_->head;
+        for (; *link != 0; link = &(*link)->next)
+            if ((*link)->name == name || std::strcmp((*link)->name, name) == 0)
+                return *link;
+        ScopeStats* s = RAPIDJSON_NEW(ScopeStats());
+        std::memset(static_cast<AllocationStats*>(s), 0, sizeof(AllocationStats));
+        s->name = name;
+        s->next = 0;
+        s->registry = registry_;
+        *link = s;
+        return s;
+    }
+
+    static void DestroyRegistry(Registry* r) {
+        while (r->head) {
+            ScopeStats* next = r->head->next;
+            RAPIDJSON_DELETE(r->head);
+            r->head = next;
+        }
+        RAPIDJSON_DELETE(r);
+    }
+#endif
+
+    BaseAllocator* baseAllocator_;
+    BaseAllocator* ownBaseAllocator_;
+#if RAPIDJSON_ALLOCATOR_INSTRUMENTATION
+    Registry* registry_;
+#endif
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_INSTRUMENTEDALLOCATOR_H_
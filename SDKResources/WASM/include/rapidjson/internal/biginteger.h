@@ -133,7 +133,7 @@ public:
         RAPIDJSON_ASSERT(count_ + offset <= kCapacity);
 
         if (interShift == 0) {
-            std::memmove(&digits_[count_ - 1 + offset], &digits_[count_ - 1], count_ * sizeof(Type));
+            std::memmove(&digits_[offset], &digits_[0], count_ * sizeof(Type));
             count_ += offset;
         }
         else {
@@ -194,9 +194,13 @@ public:
         Type borrow = 0;
         for (size_t i = 0; i < a->count_; i++) {
             Type d = a->digits_[i] - borrow;
-            if (i < b->count_)
+            Type nextBorrow = (a->digits_[i] < borrow) ? 1 : 0;
+            if (i < b->count_) {
+                if (d < b->digits_[i])
+                    nextBorrow = 1;
                 d -= b->digits_[i];
-            borrow = (d > a->digits_[i]) ? 1 : 0;
+            }
+            borrow = nextBorrow;
             out->digits_[i] = d;
             if (d != 0)
                 out->count_ = i + 1;
@@ -123,6 +123,46 @@ inline void Grisu2(double value, char* buffer, int* length, int* K) {
     DigitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
 }
 
+//! Grisu2 for single precision values.
+/*! Generates the digits of the shortest decimal strictly inside the float32 rounding interval of
+    \c value, so that it reads back as the same float (0.3f gives "3" with K = -1, not the 17 digits of the
+    promoted double). The interval is narrowed by a small margin in addition to the usual Grisu2
+    one ulp, keeping the digits clear of the midpoints between floats: they round back to \c value
+    both when parsed directly as float and when parsed as double and then converted.
+*/
+inline void Grisu2(float value, char* buffer, int* length, int* K) {
+    union {
+        float f;
+        uint32_t u;
+    } u = { value };
+
+    const int biased_e = static_cast<int>((u.u >> 23) & 0xFF);
+    uint64_t f = u.u & 0x7FFFFF;
+    int e;
+    if (biased_e != 0) {
+        f += 0x800000;
+        e = biased_e - 150;
+    }
+    else
+        e = -149;
+
+    const DiyFp w_p = DiyFp((f << 1) + 1, e - 1).Normalize();
+    DiyFp w_m = (f == 0x800000 && biased_e > 1) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+    w_m.f <<= w_m.e - w_p.e;
+    w_m.e = w_p.e;
+
+    // Half an ulp of double is at most 2^11 units of the scaled boundaries.
+    const uint64_t kMargin = uint64_t(1) << 12;
+
+    const DiyFp c_mk = GetCachedPower(w_p.e, K);
+    const DiyFp W = DiyFp(f, e).Normalize() * c_mk;
+    DiyFp Wp = w_p * c_mk;
+    DiyFp Wm = w_m * c_mk;
+    Wm.f += kMargin;
+    Wp.f -= kMargin;
+    DigitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
+}
+
 inline char* WriteExponent(int K, char* buffer) {
     if (K < 0) {
         *buffer++ = '-';
@@ -235,6 +275,32 @@ inline char* dtoa(double value, char* buffer, int maxDecimalPlaces = 324) {
     }
 }
 
+//! Writes the shortest decimal which reads back as the same single precision value.
+/*! Same output format as dtoa(), e.g. 0.3f is written as "0.3" instead of "0.30000001192092896".
+    \note \c value must be finite.
+*/
+inline char* ftoa(float value, char* buffer, int maxDecimalPlaces = 324) {
+    RAPIDJSON_ASSERT(maxDecimalPlaces >= 1);
+    Double d(static_cast<double>(value));
+    if (d.IsZero()) {
+        if (d.Sign())
+            *buffer++ = '-';     // -0.0, Issue #289
+        buffer[0] = '0';
+        buffer[1] = '.';
+        buffer[2] = '0';
+        return &buffer[3];
+    }
+    else {
+        if (value < 0) {
+            *buffer++ = '-';
+            value = -value;
+        }
+        int length, K;
+        Grisu2(value, buffer, &length, &K);
+        return Prettify(buffer, length, K, maxDecimalPlaces);
+    }
+}
+
 #ifdef __GNUC__
 RAPIDJSON_DIAG_POP
 #endif
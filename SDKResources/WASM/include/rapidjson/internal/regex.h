@@ -40,6 +40,17 @@ RAPIDJSON_DIAG_OFF(4512) // assignment operator could not be generated
 #define RAPIDJSON_REGEX_VERBOSE 0
 #endif
 
+/*! \def RAPIDJSON_REGEX_DFA_STATE_LIMIT
+    \ingroup RAPIDJSON_CONFIG
+    \brief User-defined maximum number of cached DFA states per GenericRegexSearch.
+
+    Each state takes about 512 bytes. When the cache is full, matching goes on
+    by NFA simulation. 0 disables the DFA.
+*/
+#ifndef RAPIDJSON_REGEX_DFA_STATE_LIMIT
+#define RAPIDJSON_REGEX_DFA_STATE_LIMIT 64
+#endif
+
 RAPIDJSON_NAMESPACE_BEGIN
 namespace internal {
 
@@ -49,6 +60,9 @@ namespace internal {
 static const SizeType kRegexInvalidState = ~SizeType(0);  //!< Represents an invalid index in GenericRegex::State::out, out1
 static const SizeType kRegexInvalidRange = ~SizeType(0);
 
+template <typename RegexType, typename Allocator>
+class GenericRegexSearch;
+
 //! Regular expression engine with subset of ECMAscript grammar.
 /*!
     Supported regular expression syntax:
@@ -80,32 +94,36 @@ static const SizeType kRegexInvalidRange = ~SizeType(0);
     \note This is a Thompson NFA engine, implemented with reference to 
         Cox, Russ. "Regular Expression Matching Can Be Simple And Fast (but is slow in Java, Perl, PHP, Python, Ruby,...).", 
         https://swtch.com/~rsc/regexp/regexp1.html 
+
+    A GenericRegex is not modified by matching, so it can be shared between
+    threads. Matching is done by \ref GenericRegexSearch, which holds the
+    scratch state and the DFA cache of one thread.
 */
 template <typename Encoding, typename Allocator = CrtAllocator>
 class GenericRegex {
 public:
+    typedef Encoding EncodingType;
     typedef typename Encoding::Ch Ch;
+    template <typename, typename> friend class GenericRegexSearch;
 
     GenericRegex(const Ch* source, Allocator* allocator = 0) : 
         states_(allocator, 256), ranges_(allocator, 256), root_(kRegexInvalidState), stateCount_(), rangeCount_(), 
-        stateSet_(), state0_(allocator, 0), state1_(allocator, 0), anchorBegin_(), anchorEnd_()
+        anchorBegin_(), anchorEnd_()
     {
         GenericStringStream<Encoding> ss(source);
         DecodedStream<GenericStringStream<Encoding> > ds(ss);
         Parse(ds);
     }
 
-    ~GenericRegex() {
-        Allocator::Free(stateSet_);
-    }
-
     bool IsValid() const {
         return root_ != kRegexInvalidState;
     }
 
+    //! Matches with a GenericRegexSearch of its own. Use a GenericRegexSearch to match repeatedly.
     template <typename InputStream>
     bool Match(InputStream& is) const {
-        return SearchWithAnchoring(is, true, true);
+        GenericRegexSearch<GenericRegex, Allocator> search(*this);
+        return search.Match(is);
     }
 
     bool Match(const Ch* s) const {
@@ -113,9 +131,11 @@ public:
         return Match(is);
     }
 
+    //! Searches with a GenericRegexSearch of its own. Use a GenericRegexSearch to search repeatedly.
     template <typename InputStream>
     bool Search(InputStream& is) const {
-        return SearchWithAnchoring(is, anchorBegin_, anchorEnd_);
+        GenericRegexSearch<GenericRegex, Allocator> search(*this);
+        return search.Search(is);
     }
 
     bool Search(const Ch* s) const {
@@ -327,14 +347,6 @@ private:
             printf("\n");
 #endif
         }
-
-        // Preallocate buffer for SearchWithAnchoring()
-        RAPIDJSON_ASSERT(stateSet_ == 0);
-        if (stateCount_ > 0) {
-            stateSet_ = static_cast<unsigned*>(states_.GetAllocator().Malloc(GetStateSetSize()));
-            state0_.template Reserve<SizeType>(stateCount_);
-            state1_.template Reserve<SizeType>(stateCount_);
-        }
     }
 
     SizeType NewState(SizeType out, SizeType out1, unsigned codepoint) {
@@ -603,50 +615,247 @@ private:
         }
     }
 
+    bool MatchRange(SizeType rangeIndex, unsigned codepoint) const {
+        bool yes = (GetRange(rangeIndex).start & kRangeNegationFlag) == 0;
+        while (rangeIndex != kRegexInvalidRange) {
+            const Range& r = GetRange(rangeIndex);
+            if (codepoint >= (r.start & ~kRangeNegationFlag) && codepoint <= r.end)
+                return yes;
+            rangeIndex = r.next;
+        }
+        return !yes;
+    }
+
+    Stack<Allocator> states_;
+    Stack<Allocator> ranges_;
+    SizeType root_;
+    SizeType stateCount_;
+    SizeType rangeCount_;
+
+    static const unsigned kInfinityQuantifier = ~0u;
+    bool anchorBegin_;
+    bool anchorEnd_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericRegexSearch
+
+//! Matches strings against a GenericRegex.
+/*!
+    The NFA state sets met while matching are cached as states of a DFA, built
+    lazily, so that repeated matching costs one table lookup per ASCII
+    character. The cache is bounded by \ref RAPIDJSON_REGEX_DFA_STATE_LIMIT,
+    beyond which matching falls back to NFA simulation.
+
+    A search is used by one thread at a time. Threads matching against the same
+    regex each use a search of their own.
+*/
+template <typename RegexType, typename Allocator = CrtAllocator>
+class GenericRegexSearch {
+public:
+    typedef typename RegexType::EncodingType Encoding;
+    typedef typename Encoding::Ch Ch;
+
+    GenericRegexSearch(const RegexType& regex, Allocator* allocator = 0) : 
+        regex_(regex), allocator_(allocator), ownAllocator_(0), stateSet_(),
+        state0_(allocator, 0), state1_(allocator, 0),
+        dfaStates_(allocator, 0), dfaSets_(allocator, 0), dfaTransitions_(allocator, 0), dfaStateCount_()
+    {
+        RAPIDJSON_ASSERT(regex_.IsValid());
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+        stateSet_ = static_cast<uint32_t*>(allocator_->Malloc(GetStateSetSize()));
+        state0_.template Reserve<SizeType>(regex_.stateCount_);
+        state1_.template Reserve<SizeType>(regex_.stateCount_);
+        dfaStart_[0] = dfaStart_[1] = kRegexInvalidState;
+    }
+
+    ~GenericRegexSearch() {
+        Allocator::Free(stateSet_);
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
     template <typename InputStream>
-    bool SearchWithAnchoring(InputStream& is, bool anchorBegin, bool anchorEnd) const {
-        RAPIDJSON_ASSERT(IsValid());
-        DecodedStream<InputStream> ds(is);
+    bool Match(InputStream& is) {
+        return SearchWithAnchoring(is, true, true);
+    }
 
-        state0_.Clear();
-        Stack<Allocator> *current = &state0_, *next = &state1_;
-        const size_t stateSetSize = GetStateSetSize();
-        std::memset(stateSet_, 0, stateSetSize);
+    bool Match(const Ch* s) {
+        GenericStringStream<Encoding> is(s);
+        return Match(is);
+    }
+
+    template <typename InputStream>
+    bool Search(InputStream& is) {
+        return SearchWithAnchoring(is, regex_.anchorBegin_, regex_.anchorEnd_);
+    }
+
+    bool Search(const Ch* s) {
+        GenericStringStream<Encoding> is(s);
+        return Search(is);
+    }
+
+    const RegexType& GetRegex() const { return regex_; }
+
+private:
+    typedef typename RegexType::State State;
+
+    //! State of the lazy DFA, i.e. a set of NFA states.
+    struct DfaState {
+        SizeType setBegin;  //!< Index of the first NFA state in dfaSets_
+        SizeType setCount;  //!< Number of NFA states, 0 for the dead state
+        bool matched;       //!< Whether the match state was reached on entering this state
+        bool anchorBegin;   //!< Whether the search is anchored at the beginning
+    };
 
-        bool matched = AddState(*current, root_);
+    static const unsigned kDfaAlphabetSize = 128;   //!< Transitions are cached for ASCII only.
+
+    template <typename InputStream>
+    bool SearchWithAnchoring(InputStream& is, bool anchorBegin, bool anchorEnd) {
+        RAPIDJSON_ASSERT(regex_.IsValid());
+        typename RegexType::template DecodedStream<InputStream> ds(is);
         unsigned codepoint;
-        while (!current->Empty() && (codepoint = ds.Take()) != 0) {
-            std::memset(stateSet_, 0, stateSetSize);
-            next->Clear();
-            matched = false;
-            for (const SizeType* s = current->template Bottom<SizeType>(); s != current->template End<SizeType>(); ++s) {
-                const State& sr = GetState(*s);
-                if (sr.codepoint == codepoint ||
-                    sr.codepoint == kAnyCharacterClass || 
-                    (sr.codepoint == kRangeCharacterClass && MatchRange(sr.rangeStart, codepoint)))
-                {
-                    matched = AddState(*next, sr.out) || matched;
-                    if (!anchorEnd && matched)
-                        return true;
-                }
-                if (!anchorBegin)
-                    AddState(*next, root_);
+
+        SizeType d = dfaStart_[anchorBegin];
+        if (d == kRegexInvalidState)
+            d = dfaStart_[anchorBegin] = DfaStart(anchorBegin);
+        if (d == kRegexInvalidState) {
+            // No room in the cache: NFA simulation from the start.
+            std::memset(stateSet_, 0, GetStateSetSize());
+            state1_.Clear();
+            bool matched = AddState(state1_, regex_.root_);
+            if (state1_.Empty() || (codepoint = ds.Take()) == 0)
+                return matched;
+            return SearchNfa(ds, state1_.template Bottom<SizeType>(), state1_.template End<SizeType>(), codepoint, anchorBegin, anchorEnd);
+        }
+
+        const DfaState* state = &GetDfaState(d);
+        while (state->setCount != 0 && (codepoint = ds.Take()) != 0) {
+            SizeType n = codepoint < kDfaAlphabetSize ? GetDfaTransitions(d)[codepoint] : kRegexInvalidState;
+            if (n == kRegexInvalidState && (n = DfaNext(d, codepoint)) == kRegexInvalidState) {
+                // Cache overflow: continue with NFA simulation from the state set of d.
+                const SizeType* set = dfaSets_.template Bottom<SizeType>() + GetDfaState(d).setBegin;
+                return SearchNfa(ds, set, set + GetDfaState(d).setCount, codepoint, anchorBegin, anchorEnd);
             }
+            d = n;
+            state = &GetDfaState(d);
+            if (!anchorEnd && state->matched)
+                return true;
+        }
+        return state->matched;
+    }
+
+    // Simulates the NFA from the state set [begin, end), with codepoint already taken from ds.
+    template <typename InputStream>
+    bool SearchNfa(typename RegexType::template DecodedStream<InputStream>& ds, const SizeType* begin, const SizeType* end, unsigned codepoint, bool anchorBegin, bool anchorEnd) {
+        Stack<Allocator> *current = &state0_, *next = &state1_;
+        for (;;) {
+            bool matched = Step(begin, end, codepoint, anchorBegin, *current);
+            if (!anchorEnd && matched)
+                return true;
+            if (current->Empty() || (codepoint = ds.Take()) == 0)
+                return matched;
+            begin = current->template Bottom<SizeType>();
+            end = current->template End<SizeType>();
             internal::Swap(current, next);
         }
+    }
 
+    // Computes in next the states following [begin, end) on codepoint, and marks them in stateSet_.
+    // Returns whether the match state is reached by a transition.
+    bool Step(const SizeType* begin, const SizeType* end, unsigned codepoint, bool anchorBegin, Stack<Allocator>& next) {
+        std::memset(stateSet_, 0, GetStateSetSize());
+        next.Clear();
+        bool matched = false;
+        for (const SizeType* s = begin; s != end; ++s) {
+            const State& sr = regex_.GetState(*s);
+            if (sr.codepoint == codepoint ||
+                sr.codepoint == RegexType::kAnyCharacterClass || 
+                (sr.codepoint == RegexType::kRangeCharacterClass && regex_.MatchRange(sr.rangeStart, codepoint)))
+            {
+                matched = AddState(next, sr.out) || matched;
+            }
+            if (!anchorBegin)
+                AddState(next, regex_.root_);
+        }
         return matched;
     }
 
-    size_t GetStateSetSize() const {
-        return (stateCount_ + 31) / 32 * 4;
+    const DfaState& GetDfaState(SizeType index) {
+        RAPIDJSON_ASSERT(index < dfaStateCount_);
+        return dfaStates_.template Bottom<DfaState>()[index];
+    }
+
+    SizeType* GetDfaTransitions(SizeType index) {
+        RAPIDJSON_ASSERT(index < dfaStateCount_);
+        return dfaTransitions_.template Bottom<SizeType>() + index * kDfaAlphabetSize;
+    }
+
+    SizeType DfaStart(bool anchorBegin) {
+        std::memset(stateSet_, 0, GetStateSetSize());
+        state0_.Clear();
+        bool matched = AddState(state0_, regex_.root_);
+        return FindOrAddDfaState(state0_.GetSize() / sizeof(SizeType), matched, anchorBegin);
+    }
+
+    // Returns the DFA state following d on codepoint, or kRegexInvalidState if the cache is full.
+    SizeType DfaNext(SizeType d, unsigned codepoint) {
+        const DfaState& state = GetDfaState(d);
+        const SizeType* set = dfaSets_.template Bottom<SizeType>() + state.setBegin;
+        bool matched = Step(set, set + state.setCount, codepoint, state.anchorBegin, state0_);
+        SizeType n = FindOrAddDfaState(state0_.GetSize() / sizeof(SizeType), matched, state.anchorBegin);
+        if (n != kRegexInvalidState && codepoint < kDfaAlphabetSize)
+            GetDfaTransitions(d)[codepoint] = n;
+        return n;
+    }
+
+    // Looks up the DFA state of the set marked in stateSet_, adding it if the cache has room.
+    SizeType FindOrAddDfaState(size_t count, bool matched, bool anchorBegin) {
+        const SizeType setBegin = static_cast<SizeType>(dfaSets_.GetSize() / sizeof(SizeType));
+        SizeType* set = dfaSets_.template Push<SizeType>(count);
+        for (SizeType w = 0, i = 0; i < count; w++)
+            for (uint32_t bits = stateSet_[w]; bits != 0; bits &= bits - 1) {
+                SizeType b = 0;
+                while (!(bits & (1u << b)))
+                    b++;
+                set[i++] = w * 32 + b;
+            }
+
+        for (SizeType i = 0; i < dfaStateCount_; i++) {
+            const DfaState& s = GetDfaState(i);
+            if (s.setCount == count && s.matched == matched && s.anchorBegin == anchorBegin &&
+                std::memcmp(dfaSets_.template Bottom<SizeType>() + s.setBegin, set, count * sizeof(SizeType)) == 0)
+            {
+                dfaSets_.template Pop<SizeType>(count);
+                return i;
+            }
+        }
+
+        if (dfaStateCount_ + 1 > SizeType(RAPIDJSON_REGEX_DFA_STATE_LIMIT)) {
+            dfaSets_.template Pop<SizeType>(count);
+            return kRegexInvalidState;
+        }
+
+        DfaState* s = dfaStates_.template Push<DfaState>();
+        s->setBegin = setBegin;
+        s->setCount = static_cast<SizeType>(count);
+        s->matched = matched;
+        s->anchorBegin = anchorBegin;
+        SizeType* transitions = dfaTransitions_.template Push<SizeType>(kDfaAlphabetSize);
+        for (unsigned c = 0; c < kDfaAlphabetSize; c++)
+            transitions[c] = kRegexInvalidState;
+        return dfaStateCount_++;
+    }
+
+    size_t GetStateSetSize() {
+        return (regex_.stateCount_ + 31) / 32 * 4;
     }
 
     // Return whether the added states is a match state
-    bool AddState(Stack<Allocator>& l, SizeType index) const {
+    bool AddState(Stack<Allocator>& l, SizeType index) {
         RAPIDJSON_ASSERT(index != kRegexInvalidState);
 
-        const State& s = GetState(index);
+        const State& s = regex_.GetState(index);
         if (s.out1 != kRegexInvalidState) { // Split
             bool matched = AddState(l, s.out);
             return AddState(l, s.out1) || matched;
@@ -658,34 +867,30 @@ private:
         return s.out == kRegexInvalidState; // by using PushUnsafe() above, we can ensure s is not validated due to reallocation.
     }
 
-    bool MatchRange(SizeType rangeIndex, unsigned codepoint) const {
-        bool yes = (GetRange(rangeIndex).start & kRangeNegationFlag) == 0;
-        while (rangeIndex != kRegexInvalidRange) {
-            const Range& r = GetRange(rangeIndex);
-            if (codepoint >= (r.start & ~kRangeNegationFlag) && codepoint <= r.end)
-                return yes;
-            rangeIndex = r.next;
-        }
-        return !yes;
-    }
-
-    Stack<Allocator> states_;
-    Stack<Allocator> ranges_;
-    SizeType root_;
-    SizeType stateCount_;
-    SizeType rangeCount_;
+    //! Prohibit copying
+    GenericRegexSearch(const GenericRegexSearch&);
+    //! Prohibit assignment
+    GenericRegexSearch& operator=(const GenericRegexSearch&);
 
-    static const unsigned kInfinityQuantifier = ~0u;
+    const RegexType& regex_;
+    Allocator* allocator_;
+    Allocator* ownAllocator_;
 
     // For SearchWithAnchoring()
-    uint32_t* stateSet_;        // allocated by states_.GetAllocator()
-    mutable Stack<Allocator> state0_;
-    mutable Stack<Allocator> state1_;
-    bool anchorBegin_;
-    bool anchorEnd_;
+    uint32_t* stateSet_;        // allocated by allocator_
+    Stack<Allocator> state0_;
+    Stack<Allocator> state1_;
+
+    // Lazily built DFA, one state per distinct NFA state set met by SearchWithAnchoring()
+    Stack<Allocator> dfaStates_;        // DfaState
+    Stack<Allocator> dfaSets_;          // SizeType, sorted NFA states of each DfaState
+    Stack<Allocator> dfaTransitions_;   // SizeType[kDfaAlphabetSize] per DfaState, kRegexInvalidState if not computed yet
+    SizeType dfaStateCount_;
+    SizeType dfaStart_[2];              // indexed by anchorBegin
 };
 
 typedef GenericRegex<UTF8<> > Regex;
+typedef GenericRegexSearch<Regex> RegexSearch;
 
 } // namespace internal
 RAPIDJSON_NAMESPACE_END
@@ -19,6 +19,7 @@
 #include "biginteger.h"
 #include "diyfp.h"
 #include "pow10.h"
+#include "pow5.h"
 
 RAPIDJSON_NAMESPACE_BEGIN
 namespace internal {
@@ -203,6 +204,148 @@ inline bool StrtodDiyFp(const char* decimals, size_t length, size_t decimalPosit
     return halfWay - static_cast<unsigned>(error) >= precisionBits || precisionBits >= halfWay + static_cast<unsigned>(error);
 }
 
+//! Full 64x64 -> 128-bit multiplication.
+inline uint64_t Umul128(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(_MSC_VER) && defined(_M_AMD64)
+    return _umul128(a, b, high);
+#elif defined(__GNUC__) && defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    const uint128 p = static_cast<uint128>(a) * static_cast<uint128>(b);
+    *high = static_cast<uint64_t>(p >> 64);
+    return static_cast<uint64_t>(p);
+#else
+    const uint64_t M32 = 0xFFFFFFFF;
+    const uint64_t a0 = a & M32, a1 = a >> 32;
+    const uint64_t b0 = b & M32, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0;
+    const uint64_t p01 = a0 * b1;
+    const uint64_t p10 = a1 * b0;
+    const uint64_t p11 = a1 * b1;
+    const uint64_t middle = p10 + (p00 >> 32) + (p01 & M32);
+    *high = p11 + (middle >> 32) + (p01 >> 32);
+    return (middle << 32) | (p00 & M32);
+#endif
+}
+
+inline int CountLeadingZero64(uint64_t x) {
+    RAPIDJSON_ASSERT(x != 0);
+#if defined(_MSC_VER) && defined(_M_AMD64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - static_cast<int>(index);
+#elif defined(__GNUC__) && __GNUC__ >= 4
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (static_cast<uint64_t>(1) << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Eisel-Lemire algorithm: computes w * 10^q exactly with one (rarely two) 64x128-bit
+// multiplications by a truncated power of five, or reports that the product is too close
+// to a rounding boundary to decide.
+// see Lemire, "Number Parsing at a Gigabyte per Second", Software: Practice and Experience 51(8), 2021.
+inline bool StrtodEiselLemire(uint64_t w, int q, double* result) {
+    if (w == 0 || q < kPow5MinExponent) {
+        *result = 0.0;
+        return true;
+    }
+    if (q > kPow5MaxExponent) {
+        *result = Double(RAPIDJSON_UINT64_C2(0x7FF00000, 0x00000000)).Value();
+        return true;
+    }
+
+    const int lz = CountLeadingZero64(w);
+    w <<= lz;
+
+    // Needs 55 correct bits: 53-bit significand, 1 bit of rounding and the possible leading zero.
+    const uint64_t* pow5 = Pow5Significand128(q);
+    const uint64_t kPrecisionMask = RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0xFFFFFFFF) >> 55;
+    uint64_t high;
+    uint64_t low = Umul128(w, pow5[0], &high);
+    if ((high & kPrecisionMask) == kPrecisionMask) {
+        // Truncation of 5^q may matter, refine with its lower 64 bits.
+        uint64_t secondHigh;
+        Umul128(w, pow5[1], &secondHigh);
+        low += secondHigh;
+        if (secondHigh > low)
+            high++;
+        if (low == RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0xFFFFFFFF) && (q < -27 || q > 55))
+            return false;
+    }
+
+    const int upperBit = static_cast<int>(high >> 63);
+    uint64_t significand = high >> (upperBit + 9);
+    // floor(log2(10^q)) + 63 + 1023, log2(10) ~ (152170 + 65536) / 2^16
+    int exponent = (((152170 + 65536) * q) >> 16) + 63 + upperBit - lz + 1023;
+
+    if (exponent <= 0) {
+        // Subnormal, the product is accurate enough: round half up on the shifted bits.
+        if (-exponent + 1 >= 64) {
+            *result = 0.0;
+            return true;
+        }
+        significand >>= -exponent + 1;
+        significand += significand & 1;
+        significand >>= 1;
+        exponent = (significand < (static_cast<uint64_t>(1) << 52)) ? 0 : 1;
+        *result = Double((static_cast<uint64_t>(exponent) << 52) | (significand & RAPIDJSON_UINT64_C2(0x000FFFFF, 0xFFFFFFFF))).Value();
+        return true;
+    }
+
+    // Exactly halfway between two doubles is only possible for small exponents: round half to even.
+    if (low <= 1 && q >= -4 && q <= 23 && (significand & 3) == 1 &&
+        (significand << (upperBit + 9)) == high)
+        significand &= ~static_cast<uint64_t>(1);
+
+    significand += significand & 1;
+    significand >>= 1;
+    if (significand >= (static_cast<uint64_t>(2) << 52)) {
+        significand = static_cast<uint64_t>(1) << 52;
+        exponent++;
+    }
+    significand &= ~(static_cast<uint64_t>(1) << 52);
+    if (exponent >= 0x7FF) {
+        // Overflow, rounds to infinity like strtod().
+        exponent = 0x7FF;
+        significand = 0;
+    }
+
+    *result = Double((static_cast<uint64_t>(exponent) << 52) | significand).Value();
+    return true;
+}
+
+// Eisel-Lemire on the decimal digits. More than 19 digits are truncated; the result is
+// accepted when rounding the truncated significand up gives the same double. Otherwise the
+// value lies between two adjacent doubles and *lowerBound tells whether *result is the lower one.
+inline bool StrtodEiselLemire(const char* decimals, size_t length, size_t decimalPosition, int exp, double* result, bool* lowerBound) {
+    *lowerBound = false;
+
+    uint64_t significand = 0;
+    size_t i = 0;
+    for (; i < length && i < 19; i++)
+        significand = significand * 10u + static_cast<unsigned>(decimals[i] - '0');
+
+    const int dExp = static_cast<int>(decimalPosition) - static_cast<int>(i) + exp;
+    if (!StrtodEiselLemire(significand, dExp, result))
+        return false;
+    if (i == length)
+        return true;
+
+    double upper;
+    if (!StrtodEiselLemire(significand + 1, dExp, &upper))
+        return false;
+    if (Double(upper).Uint64Value() == Double(*result).Uint64Value())
+        return true;
+
+    *lowerBound = true;
+    return false;
+}
+
 inline double StrtodBigInteger(double approx, const char* decimals, size_t length, size_t decimalPosition, int exp) {
     const BigInteger dInt(decimals, length);
     const int dExp = static_cast<int>(decimalPosition) - static_cast<int>(length) + exp;
@@ -256,10 +399,14 @@ inline double StrtodFullPrecision(double d, int p, const char* decimals, size_t
     if (int(length) + exp < -324)
         return 0.0;
 
-    if (StrtodDiyFp(decimals, length, decimalPosition, exp, &result))
+    bool lowerBound;
+    if (StrtodEiselLemire(decimals, length, decimalPosition, exp, &result, &lowerBound))
+        return result;
+
+    if (!lowerBound && StrtodDiyFp(decimals, length, decimalPosition, exp, &result))
         return result;
 
-    // Use approximation from StrtodDiyFp and make adjustment with BigInteger comparison
+    // Use approximation from StrtodEiselLemire or StrtodDiyFp and make adjustment with BigInteger comparison
     return StrtodBigInteger(result, decimals, length, decimalPosition, exp);
 }
 
@@ -0,0 +1,145 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_MEMORYMAPPEDFILE_H_
+#define RAPIDJSON_MEMORYMAPPEDFILE_H_
+
+#include "rapidjson.h"
+
+#if defined(_WIN32) || defined(__wasm__)
+#error memorymappedfile.h requires a POSIX host with mmap().
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Read-only memory mapping of a whole file.
+/*! The file content is accessed with GetData() and GetSize(). It is not
+    zero-terminated, so parse it with the length-taking overloads, e.g.
+    GenericDocument::Parse(const Ch*, size_t) or a MemoryStream.
+
+    Pages are faulted in on demand. Release() hands pages which have already
+    been consumed back to the operating system, so that a sequential pass over
+    a file much larger than the physical memory keeps a bounded resident set.
+
+    \note POSIX only (mmap/madvise).
+*/
+class MemoryMappedFile {
+public:
+    typedef char Ch;    //!< Character type (byte).
+
+    //! Default constructor, no file is mapped.
+    MemoryMappedFile() : data_(0), size_(0), mapped_(false) {}
+
+    //! Constructor which maps a file.
+    /*! \param path Path of the file. Check IsOpen() for failure.
+    */
+    explicit MemoryMappedFile(const char* path) : data_(0), size_(0), mapped_(false) { Open(path); }
+
+    //! Destructor, unmaps the file.
+    ~MemoryMappedFile() { Close(); }
+
+    //! Maps a file, unmapping the previous one.
+    /*! An empty file is opened successfully with GetSize() == 0.
+        \param path Path of the file.
+        \return Whether the file was mapped.
+    */
+    bool Open(const char* path) {
+        Close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0;
+        if (ok && st.st_size > 0) {
+            void* p = ::mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const Ch*>(p);
+                size_ = static_cast<size_t>(st.st_size);
+                mapped_ = true;
+            }
+            else
+                ok = false;
+        }
+        else if (ok)
+            data_ = "";
+        ::close(fd);
+        return ok;
+    }
+
+    //! Unmaps the file.
+    void Close() {
+        if (mapped_)
+            ::munmap(const_cast<Ch*>(data_), size_);
+        data_ = 0;
+        size_ = 0;
+        mapped_ = false;
+    }
+
+    //! Whether a file is mapped.
+    bool IsOpen() const { return data_ != 0; }
+
+    //! Content of the file, not zero-terminated.
+    const Ch* GetData() const { return data_; }
+
+    //! Size of the file in bytes.
+    size_t GetSize() const { return size_; }
+
+    //! Drops the resident pages of a consumed byte range.
+    /*! Only the pages lying completely inside the range are released. The data
+        stays valid: touching a released page reads it again from the file.
+        \param offset Offset of the range in bytes.
+        \param length Length of the range in bytes.
+    */
+    void Release(size_t offset, size_t length) {
+        if (!mapped_ || offset >= size_)
+            return;
+        if (length > size_ - offset)
+            length = size_ - offset;
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t first = (offset + page - 1) / page * page;
+        size_t last = (offset + length) / page * page;
+        if (offset + length == size_)
+            last = offset + length; // the tail page belongs to the file alone
+        if (first < last)
+            ::madvise(const_cast<Ch*>(data_) + first, last - first, MADV_DONTNEED);
+    }
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&);
+    MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+    const Ch* data_;
+    size_t size_;
+    bool mapped_;
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_MEMORYMAPPEDFILE_H_
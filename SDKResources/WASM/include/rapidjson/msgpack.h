@@ -0,0 +1,854 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_MSGPACK_H_
+#define RAPIDJSON_MSGPACK_H_
+
+/*! \file msgpack.h
+    \brief MessagePack (https://msgpack.org) writer and reader using the SAX Handler concept.
+*/
+
+#include "reader.h"
+#include "stream.h"
+#include "internal/stack.h"
+#include "internal/strfunc.h"
+#include <cstring>  // memcpy
+#include <limits>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+//! MessagePack format bytes (https://github.com/msgpack/msgpack/blob/master/spec.md).
+enum MsgPackFormat {
+    kMsgPackPositiveFixIntMax = 0x7f,
+    kMsgPackFixMap = 0x80,
+    kMsgPackFixArray = 0x90,
+    kMsgPackFixStr = 0xa0,
+    kMsgPackNil = 0xc0,
+    kMsgPackFalse = 0xc2,
+    kMsgPackTrue = 0xc3,
+    kMsgPackBin8 = 0xc4,
+    kMsgPackBin16 = 0xc5,
+    kMsgPackBin32 = 0xc6,
+    kMsgPackFloat32 = 0xca,
+    kMsgPackFloat64 = 0xcb,
+    kMsgPackUint8 = 0xcc,
+    kMsgPackUint16 = 0xcd,
+    kMsgPackUint32 = 0xce,
+    kMsgPackUint64 = 0xcf,
+    kMsgPackInt8 = 0xd0,
+    kMsgPackInt16 = 0xd1,
+    kMsgPackInt32 = 0xd2,
+    kMsgPackInt64 = 0xd3,
+    kMsgPackStr8 = 0xd9,
+    kMsgPackStr16 = 0xda,
+    kMsgPackStr32 = 0xdb,
+    kMsgPackArray16 = 0xdc,
+    kMsgPackArray32 = 0xdd,
+    kMsgPackMap16 = 0xde,
+    kMsgPackMap32 = 0xdf,
+    kMsgPackNegativeFixIntMin = 0xe0
+};
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// MsgPackWriter
+
+//! MessagePack writer.
+/*! MsgPackWriter implements the Handler concept like Writer, so it can be used
+    with Reader::Parse(), Document::Accept() and GenericMsgPackReader::Parse().
+
+    - Integers are written in the smallest MessagePack integer format, doubles
+      as float 32 when this is exact and as float 64 otherwise. Nothing is
+      converted to or from text.
+    - Strings and keys are written as MessagePack str with a length prefix.
+    - RawNumber() (kParseNumbersAsStringsFlag) writes the number text as a str.
+
+    MessagePack maps and arrays start with their element count, which SAX
+    events only provide at the end. The writer therefore buffers a root object
+    or array and writes it to the stream in one go when it is complete, with the
+    count of each container prefixed in its smallest form. The buffers are kept
+    across Reset(), so a long-lived writer stops allocating.
+
+    Only UTF-8 is supported: strings are copied byte by byte.
+
+    \tparam OutputStream Type of output byte stream, e.g. StringBuffer or MemoryBuffer.
+    \tparam StackAllocator Type of allocator for the buffers.
+    \note implements Handler concept
+*/
+template<typename OutputStream, typename StackAllocator = CrtAllocator>
+class MsgPackWriter {
+public:
+    typedef char Ch;
+
+    //! Constructor
+    /*! \param os Output stream.
+        \param stackAllocator User supplied allocator. If it is null, it will create a private one.
+        \param levelDepth Initial capacity of stack.
+    */
+    explicit
+    MsgPackWriter(OutputStream& os, StackAllocator* stackAllocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(&os), buffer_(stackAllocator, kDefaultBufferCapacity), headers_(stackAllocator, levelDepth * sizeof(Header)), level_stack_(stackAllocator, levelDepth * sizeof(Level)), hasRoot_(false) {}
+
+    explicit
+    MsgPackWriter(StackAllocator* allocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(0), buffer_(allocator, kDefaultBufferCapacity), headers_(allocator, levelDepth * sizeof(Header)), level_stack_(allocator, levelDepth * sizeof(Level)), hasRoot_(false) {}
+
+    //! Reset the writer with a new stream.
+    /*! \param os New output stream.
+        \see Writer::Reset()
+    */
+    void Reset(OutputStream& os) {
+        os_ = &os;
+        hasRoot_ = false;
+        buffer_.Clear();
+        headers_.Clear();
+        level_stack_.Clear();
+    }
+
+    //! Checks whether the output is a complete MessagePack value.
+    bool IsComplete() const {
+        return hasRoot_ && level_stack_.Empty();
+    }
+
+    /*!@name Implementation of Handler
+        \see Handler
+    */
+    //@{
+
+    bool Null()                 { Prefix(); PutByte(internal::kMsgPackNil); return EndValue(); }
+    bool Bool(bool b)           { Prefix(); PutByte(b ? internal::kMsgPackTrue : internal::kMsgPackFalse); return EndValue(); }
+    bool Int(int i)             { Prefix(); WriteInt64(i); return EndValue(); }
+    bool Uint(unsigned u)       { Prefix(); WriteUint64(u); return EndValue(); }
+    bool Int64(int64_t i64)     { Prefix(); WriteInt64(i64); return EndValue(); }
+    bool Uint64(uint64_t u64)   { Prefix(); WriteUint64(u64); return EndValue(); }
+
+    //! Writes the given \c double value to the stream
+    /*!
+        \param d The value to be written.
+        \return Whether it is succeed.
+    */
+    bool Double(double d) {
+        Prefix();
+        float f;
+        if (ToLosslessFloat(d, f))
+            WriteFloat(f);
+        else {
+            union { double d; uint64_t u; } bits;
+            bits.d = d;
+            unsigned char* p = Reserve(9);
+            p[0] = internal::kMsgPackFloat64;
+            PutBigEndian64(p + 1, bits.u);
+        }
+        return EndValue();
+    }
+
+    //! Writes the given \c float value to the stream as float 32.
+    bool Float(float f) { Prefix(); WriteFloat(f); return EndValue(); }
+
+    bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
+        return String(str, length, copy);
+    }
+
+    bool String(const Ch* str, SizeType length, bool copy = false) {
+        (void)copy;
+        Prefix();
+        WriteString(str, length);
+        return EndValue();
+    }
+
+#if RAPIDJSON_HAS_STDSTRING
+    bool String(const std::basic_string<Ch>& str) {
+        return String(str.data(), SizeType(str.size()));
+    }
+#endif
+
+    bool StartObject() { return StartContainer(true); }
+
+    bool Key(const Ch* str, SizeType length, bool copy = false) {
+        (void)copy;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && level_stack_.template Top<Level>()->isObject);
+        RAPIDJSON_ASSERT(!level_stack_.template Top<Level>()->hasKey);
+        level_stack_.template Top<Level>()->hasKey = true;
+        WriteString(str, length);
+        return true;
+    }
+
+    //! Ends an object. The member count is taken from the written members, \c memberCount is ignored.
+    bool EndObject(SizeType memberCount = 0) {
+        (void)memberCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && level_stack_.template Top<Level>()->isObject);
+        RAPIDJSON_ASSERT(!level_stack_.template Top<Level>()->hasKey);
+        return EndContainer();
+    }
+
+    bool StartArray() { return StartContainer(false); }
+
+    //! Ends an array. The element count is taken from the written elements, \c elementCount is ignored.
+    bool EndArray(SizeType elementCount = 0) {
+        (void)elementCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && !level_stack_.template Top<Level>()->isObject);
+        return EndContainer();
+    }
+    //@}
+
+    /*! @name Convenience extensions */
+    //@{
+
+    //! Simpler but slower overload.
+    bool String(const Ch* str) { return String(str, internal::StrLen(str)); }
+    bool Key(const Ch* str) { return Key(str, internal::StrLen(str)); }
+
+    //@}
+
+protected:
+    //! Information for each nested level
+    struct Level {
+        Level(bool isObject_, size_t header_) : header(header_), count(0), isObject(isObject_), hasKey(false) {}
+        size_t header;      //!< Index of the container's header in headers_.
+        SizeType count;     //!< Number of members or elements written so far.
+        bool isObject;      //!< true if in object, otherwise in array.
+        bool hasKey;        //!< Whether the key of the next member is written.
+    };
+
+    //! Container whose count is inserted at \c offset of the buffer when writing it out.
+    struct Header {
+        size_t offset;
+        SizeType count;
+        bool isObject;
+    };
+
+    static const size_t kDefaultLevelDepth = 32;
+    static const size_t kDefaultBufferCapacity = 256;
+
+    unsigned char* Reserve(size_t count) { return buffer_.template Push<unsigned char>(count); }
+    void PutByte(unsigned b) { *Reserve(1) = static_cast<unsigned char>(b); }
+
+    static void PutBigEndian16(unsigned char* p, unsigned u) {
+        p[0] = static_cast<unsigned char>(u >> 8);
+        p[1] = static_cast<unsigned char>(u);
+    }
+
+    static void PutBigEndian32(unsigned char* p, uint32_t u) {
+        p[0] = static_cast<unsigned char>(u >> 24);
+        p[1] = static_cast<unsigned char>(u >> 16);
+        p[2] = static_cast<unsigned char>(u >> 8);
+        p[3] = static_cast<unsigned char>(u);
+    }
+
+    static void PutBigEndian64(unsigned char* p, uint64_t u) {
+        PutBigEndian32(p, static_cast<uint32_t>(u >> 32));
+        PutBigEndian32(p + 4, static_cast<uint32_t>(u));
+    }
+
+    void WriteUint64(uint64_t u) {
+        if (u <= internal::kMsgPackPositiveFixIntMax)
+            PutByte(static_cast<unsigned>(u));
+        else if (u <= 0xFFu) {
+            unsigned char* p = Reserve(2);
+            p[0] = internal::kMsgPackUint8;
+            p[1] = static_cast<unsigned char>(u);
+        }
+        else if (u <= 0xFFFFu) {
+            unsigned char* p = Reserve(3);
+            p[0] = internal::kMsgPackUint16;
+            PutBigEndian16(p + 1, static_cast<unsigned>(u));
+        }
+        else if (u <= 0xFFFFFFFFu) {
+            unsigned char* p = Reserve(5);
+            p[0] = internal::kMsgPackUint32;
+            PutBigEndian32(p + 1, static_cast<uint32_t>(u));
+        }
+        else {
+            unsigned char* p = Reserve(9);
+            p[0] = internal::kMsgPackUint64;
+            PutBigEndian64(p + 1, u);
+        }
+    }
+
+    void WriteInt64(int64_t i) {
+        if (i >= 0)
+            WriteUint64(static_cast<uint64_t>(i));
+        else if (i >= -32)
+            PutByte(static_cast<unsigned>(i) & 0xFFu);   // negative fixint
+        else if (i >= -128) {
+            unsigned char* p = Reserve(2);
+            p[0] = internal::kMsgPackInt8;
+            p[1] = static_cast<unsigned char>(static_cast<uint64_t>(i));
+        }
+        else if (i >= -32768) {
+            unsigned char* p = Reserve(3);
+            p[0] = internal::kMsgPackInt16;
+            PutBigEndian16(p + 1, static_cast<unsigned>(static_cast<uint64_t>(i)));
+        }
+        else if (i >= -2147483647 - 1) {
+            unsigned char* p = Reserve(5);
+            p[0] = internal::kMsgPackInt32;
+            PutBigEndian32(p + 1, static_cast<uint32_t>(static_cast<uint64_t>(i)));
+        }
+        else {
+            unsigned char* p = Reserve(9);
+            p[0] = internal::kMsgPackInt64;
+            PutBigEndian64(p + 1, static_cast<uint64_t>(i));
+        }
+    }
+
+    //! Narrows \c d to \c f if no information is lost, for the shorter float 32 encoding.
+    /*! The range is checked before narrowing, which is undefined behaviour for finite values out of
+        the float range. NaN is never narrowed, so that its payload is kept.
+    */
+    static bool ToLosslessFloat(double d, float& f) {
+        const double maxFloat = static_cast<double>((std::numeric_limits<float>::max)());
+        if (d >= -maxFloat && d <= maxFloat) {
+            f = static_cast<float>(d);
+            return static_cast<double>(f) == d;
+        }
+        if (d == std::numeric_limits<double>::infinity() || d == -std::numeric_limits<double>::infinity()) {
+            f = d > 0 ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+            return true;
+        }
+        return false;   // NaN, or out of the float range
+    }
+
+    void WriteFloat(float f) {
+        union { float f; uint32_t u; } bits;
+        bits.f = f;
+        unsigned char* p = Reserve(5);
+        p[0] = internal::kMsgPackFloat32;
+        PutBigEndian32(p + 1, bits.u);
+    }
+
+    void WriteString(const Ch* str, SizeType length) {
+        unsigned char* p;
+        if (length < 32) {
+            p = Reserve(1 + length);
+            *p++ = static_cast<unsigned char>(internal::kMsgPackFixStr | length);
+        }
+        else if (length <= 0xFFu) {
+            p = Reserve(2 + length);
+            *p++ = internal::kMsgPackStr8;
+            *p++ = static_cast<unsigned char>(length);
+        }
+        else if (length <= 0xFFFFu) {
+            p = Reserve(3 + length);
+            *p++ = internal::kMsgPackStr16;
+            PutBigEndian16(p, length);
+            p += 2;
+        }
+        else {
+            p = Reserve(5 + length);
+            *p++ = internal::kMsgPackStr32;
+            PutBigEndian32(p, length);
+            p += 4;
+        }
+        if (length)
+            std::memcpy(p, str, length);
+    }
+
+    void Prefix() {
+        if (RAPIDJSON_LIKELY(!level_stack_.Empty())) { // this value is not at root
+            Level* level = level_stack_.template Top<Level>();
+            if (level->isObject) {
+                RAPIDJSON_ASSERT(level->hasKey);   // Value of an object member must follow its key.
+                level->hasKey = false;
+            }
+            level->count++;
+        }
+        else {
+            RAPIDJSON_ASSERT(!hasRoot_);    // Should only has one and only one root.
+            hasRoot_ = true;
+        }
+    }
+
+    bool StartContainer(bool isObject) {
+        Prefix();
+        Header* h = headers_.template Push<Header>();
+        h->offset = buffer_.GetSize();
+        h->count = 0;
+        h->isObject = isObject;
+        new (level_stack_.template Push<Level>()) Level(isObject, headers_.GetSize() / sizeof(Header) - 1);
+        return true;
+    }
+
+    bool EndContainer() {
+        Level* level = level_stack_.template Pop<Level>(1);
+        headers_.template Bottom<Header>()[level->header].count = level->count;
+        return EndValue();
+    }
+
+    //! Writes out the buffered root value once it is complete.
+    bool EndValue() {
+        if (RAPIDJSON_UNLIKELY(level_stack_.Empty()))   // end of the root value
+            Flush();
+        return true;
+    }
+
+    void Flush() {
+        const unsigned char* body = buffer_.template Bottom<unsigned char>();
+        size_t offset = 0;
+        for (const Header* h = headers_.template Bottom<Header>(); h != headers_.template End<Header>(); ++h) {
+            PutBytes(body + offset, h->offset - offset);
+            offset = h->offset;
+
+            unsigned char header[5];
+            size_t length;
+            if (h->count < 16) {
+                header[0] = static_cast<unsigned char>((h->isObject ? internal::kMsgPackFixMap : internal::kMsgPackFixArray) | h->count);
+                length = 1;
+            }
+            else if (h->count <= 0xFFFFu) {
+                header[0] = static_cast<unsigned char>(h->isObject ? internal::kMsgPackMap16 : internal::kMsgPackArray16);
+                PutBigEndian16(header + 1, h->count);
+                length = 3;
+            }
+            else {
+                header[0] = static_cast<unsigned char>(h->isObject ? internal::kMsgPackMap32 : internal::kMsgPackArray32);
+                PutBigEndian32(header + 1, h->count);
+                length = 5;
+            }
+            PutBytes(header, length);
+        }
+        PutBytes(body + offset, buffer_.GetSize() - offset);
+        os_->Flush();
+        buffer_.Clear();
+        headers_.Clear();
+    }
+
+    void PutBytes(const unsigned char* p, size_t count) {
+        PutReserve(*os_, count);
+        for (size_t i = 0; i < count; i++)
+            PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(p[i]));
+    }
+
+    OutputStream* os_;
+    internal::Stack<StackAllocator> buffer_;        //!< Encoded root value without container headers.
+    internal::Stack<StackAllocator> headers_;       //!< Headers of the containers in buffer_, in order (Header).
+    internal::Stack<StackAllocator> level_stack_;   //!< Open containers (Level).
+    bool hasRoot_;
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    MsgPackWriter(const MsgPackWriter&);
+    MsgPackWriter& operator=(const MsgPackWriter&);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericMsgPackReader
+
+//! SAX-style MessagePack parser. Use \ref MsgPackReader for UTF-8 output.
+/*! GenericMsgPackReader parses MessagePack from a memory buffer and publishes
+    the values to a Handler, like GenericReader does for JSON text. Strings are
+    passed to the handler directly from the buffer with \c copy set to true
+    (they are not null-terminated), numbers are decoded from their binary form.
+
+    - nil, bool, int, uint, float 32/64, str, array and map are supported.
+      bin is published as a string, ext types are rejected.
+    - Map keys must be strings.
+    - Parse flags: kParseValidateEncodingFlag validates the UTF-8 of strings,
+      kParseStopWhenDoneFlag stops after the root value. Other flags are ignored.
+
+    Containers are tracked in an explicit stack, so deeply nested input cannot
+    overflow the call stack. Errors are reported with the JSON ParseErrorCode:
+
+    - kParseErrorDocumentEmpty: the buffer is empty.
+    - kParseErrorValueInvalid: unsupported format byte, or the buffer ends inside a value.
+    - kParseErrorObjectMissName: a map key is not a string.
+    - kParseErrorStringInvalidEncoding: invalid UTF-8 with kParseValidateEncodingFlag.
+    - kParseErrorDocumentRootNotSingular: bytes follow the root value.
+    - kParseErrorTermination: the handler returned false.
+
+\code
+    Document d;
+    MsgPackReader reader;
+    MsgPackParser<MsgPackReader> parser(reader, buffer, size);
+    d.Populate(parser);
+\endcode
+
+    \tparam StackAllocator Allocator type for the container stack.
+*/
+template <typename StackAllocator = CrtAllocator>
+class GenericMsgPackReader {
+public:
+    typedef char Ch; //!< Character type of the strings published to the handler.
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
+        \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
+    */
+    GenericMsgPackReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_(), begin_(), cur_(), end_() {}
+
+    //! Parse MessagePack from a memory buffer.
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param data Start of the MessagePack data.
+        \param length Length of the data in bytes.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Parse(const void* data, size_t length, Handler& handler) {
+        parseResult_.Clear();
+        stack_.Clear();
+        begin_ = cur_ = static_cast<const unsigned char*>(data);
+        end_ = begin_ + length;
+
+        if (RAPIDJSON_UNLIKELY(cur_ == end_))
+            return SetError(kParseErrorDocumentEmpty);
+
+        do {
+            if (!stack_.Empty()) {
+                Level* level = stack_.template Top<Level>();
+                if (level->remaining == 0) {
+                    const bool isObject = level->isObject;
+                    const SizeType count = level->count;
+                    stack_.template Pop<Level>(1);
+                    if (RAPIDJSON_UNLIKELY(!(isObject ? handler.EndObject(count) : handler.EndArray(count))))
+                        return SetError(kParseErrorTermination);
+                    continue;
+                }
+                level->remaining--;
+                if (level->isObject && !ParseKey<parseFlags>(handler))
+                    return parseResult_;
+            }
+            if (!ParseValue<parseFlags>(handler))
+                return parseResult_;
+        } while (!stack_.Empty());
+
+        if (!(parseFlags & kParseStopWhenDoneFlag) && RAPIDJSON_UNLIKELY(cur_ != end_))
+            return SetError(kParseErrorDocumentRootNotSingular);
+
+        return parseResult_;
+    }
+
+    //! Parse MessagePack from a memory buffer (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    ParseResult Parse(const void* data, size_t length, Handler& handler) {
+        return Parse<kParseDefaultFlags>(data, length, handler);
+    }
+
+    //! Whether a parse error has occured in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseErrorCode() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+    //! Number of bytes consumed by the last parsing.
+    size_t Tell() const { return static_cast<size_t>(cur_ - begin_); }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericMsgPackReader(const GenericMsgPackReader&);
+    GenericMsgPackReader& operator=(const GenericMsgPackReader&);
+
+    static const size_t kDefaultStackCapacity = 32 * 16;
+
+    struct Level {
+        SizeType count;         //!< Number of members or elements.
+        SizeType remaining;     //!< Number of members or elements not yet parsed.
+        bool isObject;
+    };
+
+    //! Input stream over a string which is not null-terminated, for validating UTF-8.
+    class StringStream {
+    public:
+        typedef char Ch;
+        StringStream(const Ch* src, size_t length) : src_(src), head_(src), end_(src + length) {}
+        Ch Peek() const { return src_ != end_ ? *src_ : '\0'; }
+        Ch Take() { return src_ != end_ ? *src_++ : '\0'; }
+        size_t Tell() const { return static_cast<size_t>(src_ - head_); }
+    private:
+        const Ch* src_;
+        const Ch* head_;
+        const Ch* end_;
+    };
+
+    //! Output stream discarding the characters, for validating UTF-8.
+    struct NullStream {
+        typedef char Ch;
+        void Put(char) {}
+    };
+
+    ParseResult& SetError(ParseErrorCode code) {
+        stack_.Clear();
+        parseResult_.Set(code, static_cast<size_t>(cur_ - begin_));
+        return parseResult_;
+    }
+
+    bool Has(size_t count) const { return static_cast<size_t>(end_ - cur_) >= count; }
+
+    static uint32_t ReadBigEndian16(const unsigned char* p) { return (static_cast<uint32_t>(p[0]) << 8) | p[1]; }
+    static uint32_t ReadBigEndian32(const unsigned char* p) { return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3]; }
+    static uint64_t ReadBigEndian64(const unsigned char* p) { return (static_cast<uint64_t>(ReadBigEndian32(p)) << 32) | ReadBigEndian32(p + 4); }
+
+    //! Reads an unsigned big-endian length of 1, 2 or 4 bytes. Returns false if the buffer ends.
+    bool ReadLength(size_t size, uint32_t* length) {
+        if (RAPIDJSON_UNLIKELY(!Has(size)))
+            return false;
+        *length = size == 1 ? *cur_ : size == 2 ? ReadBigEndian16(cur_) : ReadBigEndian32(cur_);
+        cur_ += size;
+        return true;
+    }
+
+    //! Reads the length of a str or bin. Returns false if \c b is not a string format.
+    bool StringLength(unsigned b, uint32_t* length, bool* truncated) {
+        *truncated = false;
+        if ((b & 0xe0) == internal::kMsgPackFixStr) {
+            *length = b & 0x1f;
+            return true;
+        }
+        size_t size;
+        switch (b) {
+        case internal::kMsgPackStr8:  case internal::kMsgPackBin8:  size = 1; break;
+        case internal::kMsgPackStr16: case internal::kMsgPackBin16: size = 2; break;
+        case internal::kMsgPackStr32: case internal::kMsgPackBin32: size = 4; break;
+        default: return false;
+        }
+        *truncated = !ReadLength(size, length);
+        return true;
+    }
+
+    template<unsigned parseFlags>
+    bool ReadString(uint32_t length, const Ch** str) {
+        if (RAPIDJSON_UNLIKELY(!Has(length))) {
+            SetError(kParseErrorValueInvalid);
+            return false;
+        }
+        *str = reinterpret_cast<const Ch*>(cur_);
+        if (parseFlags & kParseValidateEncodingFlag) {
+            StringStream is(*str, length);
+            NullStream os;
+            while (is.Tell() < length)
+                if (RAPIDJSON_UNLIKELY(!UTF8<Ch>::Validate(is, os))) {
+                    cur_ += is.Tell();
+                    SetError(kParseErrorStringInvalidEncoding);
+                    return false;
+                }
+        }
+        cur_ += length;
+        return true;
+    }
+
+    template<unsigned parseFlags, typename Handler>
+    bool ParseKey(Handler& handler) {
+        if (RAPIDJSON_UNLIKELY(!Has(1))) {
+            SetError(kParseErrorValueInvalid);
+            return false;
+        }
+        uint32_t length;
+        bool truncated;
+        if (RAPIDJSON_UNLIKELY(!StringLength(*cur_++, &length, &truncated))) {
+            cur_--;
+            SetError(kParseErrorObjectMissName);
+            return false;
+        }
+        const Ch* str;
+        if (RAPIDJSON_UNLIKELY(truncated)) {
+            SetError(kParseErrorValueInvalid);
+            return false;
+        }
+        if (!ReadString<parseFlags>(length, &str))
+            return false;
+        if (RAPIDJSON_UNLIKELY(!handler.Key(str, length, true))) {
+            SetError(kParseErrorTermination);
+            return false;
+        }
+        return true;
+    }
+
+    template<typename Handler>
+    bool HandleUint64(Handler& handler, uint64_t u) {
+        return u <= 0xFFFFFFFFu ? handler.Uint(static_cast<unsigned>(u)) : handler.Uint64(u);
+    }
+
+    template<typename Handler>
+    bool HandleInt64(Handler& handler, int64_t i) {
+        if (i >= 0)
+            return HandleUint64(handler, static_cast<uint64_t>(i));
+        return i >= -2147483647 - 1 ? handler.Int(static_cast<int>(i)) : handler.Int64(i);
+    }
+
+    bool StartContainer(uint32_t count, bool isObject) {
+        // Each element takes at least one byte, each member two.
+        if (RAPIDJSON_UNLIKELY(static_cast<size_t>(end_ - cur_) / (isObject ? 2 : 1) < count)) {
+            SetError(kParseErrorValueInvalid);
+            return false;
+        }
+        Level* level = stack_.template Push<Level>();
+        level->count = level->remaining = count;
+        level->isObject = isObject;
+        return true;
+    }
+
+    template<unsigned parseFlags, typename Handler>
+    bool ParseValue(Handler& handler) {
+        if (RAPIDJSON_UNLIKELY(!Has(1))) {
+            SetError(kParseErrorValueInvalid);
+            return false;
+        }
+
+        const unsigned char* start = cur_;
+        const unsigned b = *cur_++;
+        bool ok;
+
+        if (b <= internal::kMsgPackPositiveFixIntMax)
+            ok = handler.Uint(b);
+        else if (b >= internal::kMsgPackNegativeFixIntMin)
+            ok = handler.Int(static_cast<int>(b) - 256);
+        else if ((b & 0xf0) == internal::kMsgPackFixMap)
+            ok = StartContainer(b & 0x0f, true) && handler.StartObject();
+        else if ((b & 0xf0) == internal::kMsgPackFixArray)
+            ok = StartContainer(b & 0x0f, false) && handler.StartArray();
+        else {
+            uint32_t length;
+            bool truncated;
+            if (StringLength(b, &length, &truncated)) {
+                const Ch* str;
+                if (RAPIDJSON_UNLIKELY(truncated)) {
+                    cur_ = start;
+                    SetError(kParseErrorValueInvalid);
+                    return false;
+                }
+                if (!ReadString<parseFlags>(length, &str))
+                    return false;
+                ok = handler.String(str, length, true);
+            }
+            else {
+                static const unsigned char kSizes[] = {
+                    // 0xc0 - 0xcf: nil, (never used), false, true, bin 8/16/32, ext 8/16/32, float 32/64, uint 8/16/32/64
+                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 8, 1, 2, 4, 8,
+                    // 0xd0 - 0xdf: int 8/16/32/64, fixext 1/2/4/8/16, str 8/16/32, array 16/32, map 16/32
+                    1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 2, 4
+                };
+                const size_t size = kSizes[b - internal::kMsgPackNil];
+                if (RAPIDJSON_UNLIKELY(!Has(size))) {
+                    cur_ = start;
+                    SetError(kParseErrorValueInvalid);
+                    return false;
+                }
+                const unsigned char* p = cur_;
+                cur_ += size;
+
+                switch (b) {
+                case internal::kMsgPackNil:     ok = handler.Null(); break;
+                case internal::kMsgPackFalse:   ok = handler.Bool(false); break;
+                case internal::kMsgPackTrue:    ok = handler.Bool(true); break;
+                case internal::kMsgPackFloat32:
+                    {
+                        union { uint32_t u; float f; } bits;
+                        bits.u = ReadBigEndian32(p);
+                        ok = handler.Double(static_cast<double>(bits.f));
+                    }
+                    break;
+                case internal::kMsgPackFloat64:
+                    {
+                        union { uint64_t u; double d; } bits;
+                        bits.u = ReadBigEndian64(p);
+                        ok = handler.Double(bits.d);
+                    }
+                    break;
+                case internal::kMsgPackUint8:   ok = handler.Uint(*p); break;
+                case internal::kMsgPackUint16:  ok = handler.Uint(ReadBigEndian16(p)); break;
+                case internal::kMsgPackUint32:  ok = handler.Uint(ReadBigEndian32(p)); break;
+                case internal::kMsgPackUint64:  ok = HandleUint64(handler, ReadBigEndian64(p)); break;
+                case internal::kMsgPackInt8:    ok = HandleInt64(handler, static_cast<int8_t>(*p)); break;
+                case internal::kMsgPackInt16:   ok = HandleInt64(handler, static_cast<int16_t>(ReadBigEndian16(p))); break;
+                case internal::kMsgPackInt32:   ok = HandleInt64(handler, static_cast<int32_t>(ReadBigEndian32(p))); break;
+                case internal::kMsgPackInt64:   ok = HandleInt64(handler, static_cast<int64_t>(ReadBigEndian64(p))); break;
+                case internal::kMsgPackArray16: ok = StartContainer(ReadBigEndian16(p), false) && handler.StartArray(); break;
+                case internal::kMsgPackArray32: ok = StartContainer(ReadBigEndian32(p), false) && handler.StartArray(); break;
+                case internal::kMsgPackMap16:   ok = StartContainer(ReadBigEndian16(p), true) && handler.StartObject(); break;
+                case internal::kMsgPackMap32:   ok = StartContainer(ReadBigEndian32(p), true) && handler.StartObject(); break;
+                default:
+                    cur_ = start;
+                    SetError(kParseErrorValueInvalid);
+                    return false;
+                }
+            }
+        }
+
+        if (RAPIDJSON_UNLIKELY(!ok)) {
+            if (!HasParseError())
+                SetError(kParseErrorTermination);
+            return false;
+        }
+        return true;
+    }
+
+    internal::Stack<StackAllocator> stack_;  //!< Open containers (Level).
+    ParseResult parseResult_;
+    const unsigned char* begin_;
+    const unsigned char* cur_;
+    const unsigned char* end_;
+};
+
+//! MessagePack reader with UTF-8 strings and the default allocator.
+typedef GenericMsgPackReader<CrtAllocator> MsgPackReader;
+
+//! A generator parsing MessagePack, for GenericDocument::Populate().
+/*!
+    \tparam MsgPackReaderType Type of the MessagePack reader, e.g. MsgPackReader.
+    \tparam parseFlags Combination of \ref ParseFlag.
+*/
+template <typename MsgPackReaderType, unsigned parseFlags = kParseDefaultFlags>
+class MsgPackParser {
+public:
+    //! Constructor
+    /*!
+        \param reader Reader used for parsing, its parse result is available after populating.
+        \param data Start of the MessagePack data.
+        \param length Length of the data in bytes.
+    */
+    MsgPackParser(MsgPackReaderType& reader, const void* data, size_t length) : reader_(reader), data_(data), length_(length) {}
+
+    template <typename Handler>
+    bool operator()(Handler& handler) {
+        return reader_.template Parse<parseFlags>(data_, length_, handler);
+    }
+
+private:
+    MsgPackParser(const MsgPackParser&);
+    MsgPackParser& operator=(const MsgPackParser&);
+
+    MsgPackReaderType& reader_;
+    const void* data_;
+    size_t length_;
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_MSGPACK_H_
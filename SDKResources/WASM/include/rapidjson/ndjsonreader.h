@@ -0,0 +1,430 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_NDJSONREADER_H_
+#define RAPIDJSON_NDJSONREADER_H_
+
+#include "document.h"
+#include "memorymappedfile.h"
+
+#if __cplusplus < 201103L && !(defined(_MSC_VER) && _MSC_VER >= 1900)
+#error ndjsonreader.h requires C++11 (std::thread).
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Order in which GenericNdjsonReader delivers the records.
+enum NdjsonDelivery {
+    kNdjsonOrdered,     //!< Records are delivered one at a time, in input order.
+    kNdjsonUnordered    //!< Records are delivered concurrently by the workers, as soon as they are parsed.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericNdjsonReader
+
+//! Parallel reader of newline-delimited JSON (one value per line).
+/*! The input is cut into fixed-size chunks which are parsed by a pool of
+    worker threads. A chunk holds the records whose first byte lies in it; each
+    worker finds the record boundaries of its chunk itself, so there is no
+    serial splitting pass. Blank lines are skipped.
+
+    Every worker owns a DocumentType with its own MemoryPoolAllocator, which is
+    Reset() after each chunk. In ordered mode a parsed chunk is kept until all
+    preceding chunks have been delivered, so the DOM memory is bounded by about
+    one chunk per worker.
+
+    A callback has the signature \c bool(ValueType& record, size_t offset),
+    where \c offset is the byte offset of the record in the input. The record
+    lives in the allocator of a worker and is only valid during the call: use
+    CopyFrom() to keep it. Returning false stops the reader with
+    kParseErrorTermination.
+
+    On failure the error with the smallest input offset is reported, in the
+    same way as a sequential parse. In ordered mode all records before it have
+    been delivered.
+
+    \tparam DocumentType Document type of the workers. Its allocator must be a pool (kNeedFree == false).
+    \note Requires C++11. The callback is called from the worker threads and,
+          in unordered mode, concurrently.
+*/
+template <typename DocumentType = Document>
+class GenericNdjsonReader {
+public:
+    typedef typename DocumentType::ValueType ValueType;         //!< Type of a record.
+    typedef typename DocumentType::AllocatorType AllocatorType; //!< Allocator of a worker.
+    typedef typename DocumentType::Ch Ch;                       //!< Character type.
+
+    static const size_t kDefaultChunkSize = 4 * 1024 * 1024;   //!< Default chunk size in bytes.
+
+    //! Constructor.
+    /*! The worker threads are started by the first Parse().
+        \param workerCount Number of workers, including the calling thread. 0 for one per hardware thread.
+        \param chunkSize Size of the chunks in bytes.
+    */
+    explicit GenericNdjsonReader(unsigned workerCount = 0, size_t chunkSize = kDefaultChunkSize) :
+        workers_(), threads_(), mutex_(), wake_(), done_(), turn_(), generation_(0), busy_(0), exit_(false),
+        job_(0), jobContext_(0), chunkSize_(chunkSize), nextChunk_(0), stopOffset_(0), recordCount_(0),
+        deliverTurn_(0), aborted_(false), result_()
+    {
+        RAPIDJSON_STATIC_ASSERT(!AllocatorType::kNeedFree);
+        RAPIDJSON_STATIC_ASSERT(sizeof(Ch) == 1);
+        RAPIDJSON_ASSERT(chunkSize > 0);
+        if (workerCount == 0)
+            workerCount = std::thread::hardware_concurrency();
+        workerCount_ = workerCount > 0 ? workerCount : 1;
+    }
+
+    //! Destructor, stops the worker threads.
+    ~GenericNdjsonReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            exit_ = true;
+        }
+        wake_.notify_all();
+        for (size_t i = 0; i < threads_.size(); i++)
+            threads_[i].join();
+    }
+
+    //!@name Parse NDJSON
+    //@{
+
+    //! Parses NDJSON text from a read-only buffer.
+    /*! \tparam parseFlags Combination of \ref ParseFlag applied to every record. kParseInsituFlag is not allowed.
+        \tparam Callback Type of the callback.
+        \param str NDJSON text, need not be zero-terminated.
+        \param length Length of \c str in bytes.
+        \param callback Receives the records.
+        \param delivery Whether the records are delivered in order.
+        \return Result of the parse; the offset of an error is relative to \c str.
+    */
+    template <unsigned parseFlags, typename Callback>
+    ParseResult Parse(const Ch* str, size_t length, Callback& callback, NdjsonDelivery delivery = kNdjsonOrdered) {
+        return ParseImpl<parseFlags>(str, length, callback, delivery, 0);
+    }
+
+    //! Parses NDJSON text from a read-only buffer (with \ref kParseDefaultFlags).
+    template <typename Callback>
+    ParseResult Parse(const Ch* str, size_t length, Callback& callback, NdjsonDelivery delivery = kNdjsonOrdered) {
+        return Parse<kParseDefaultFlags>(str, length, callback, delivery);
+    }
+
+    //! Parses a memory-mapped NDJSON file.
+    /*! The pages of each chunk are released once the chunk is done, which keeps
+        the resident set of huge files bounded.
+        \see Parse(const Ch*, size_t, Callback&, NdjsonDelivery)
+    */
+    template <unsigned parseFlags, typename Callback>
+    ParseResult Parse(MemoryMappedFile& file, Callback& callback, NdjsonDelivery delivery = kNdjsonOrdered) {
+        return ParseImpl<parseFlags>(file.GetData(), file.GetSize(), callback, delivery, &file);
+    }
+
+    //! Parses a memory-mapped NDJSON file (with \ref kParseDefaultFlags).
+    template <typename Callback>
+    ParseResult Parse(MemoryMappedFile& file, Callback& callback, NdjsonDelivery delivery = kNdjsonOrdered) {
+        return Parse<kParseDefaultFlags>(file, callback, delivery);
+    }
+
+    //@}
+
+    //! Number of records delivered by the last Parse().
+    size_t GetRecordCount() const { return recordCount_.load(); }
+
+    //! Number of workers, including the calling thread.
+    unsigned GetWorkerCount() const { return workerCount_; }
+
+    //! Chunk size in bytes.
+    size_t GetChunkSize() const { return chunkSize_; }
+
+    //! Sum of the allocator high-water marks of all workers.
+    /*! \see MemoryPoolAllocator::PeakSize()
+    */
+    size_t GetAllocatorPeakSize() const {
+        size_t size = 0;
+        for (size_t i = 0; i < workers_.size(); i++)
+            size += workers_[i]->allocator.PeakSize();
+        return size;
+    }
+
+private:
+    GenericNdjsonReader(const GenericNdjsonReader&);
+    GenericNdjsonReader& operator=(const GenericNdjsonReader&);
+
+    struct Record {
+        ValueType value;
+        size_t offset;
+    };
+
+    struct Worker {
+        Worker() : allocator(), document(&allocator), records(0, 256 * sizeof(Record)), error() {}
+
+        AllocatorType allocator;
+        DocumentType document;
+        internal::Stack<CrtAllocator> records;  // parsed records of the chunk in ordered mode
+        ParseResult error;                      // parse error of the chunk in ordered mode
+    };
+
+    template <typename Callback>
+    struct Job {
+        GenericNdjsonReader* reader;
+        const Ch* str;
+        size_t length;
+        Callback* callback;
+        NdjsonDelivery delivery;
+        MemoryMappedFile* file;
+    };
+
+    template <unsigned parseFlags, typename Callback>
+    ParseResult ParseImpl(const Ch* str, size_t length, Callback& callback, NdjsonDelivery delivery, MemoryMappedFile* file) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        RAPIDJSON_ASSERT(str != 0 || length == 0);
+
+        if (workers_.empty()) {
+            for (unsigned i = 0; i < workerCount_; i++)
+                workers_.push_back(std::unique_ptr<Worker>(new Worker));
+            for (unsigned i = 1; i < workerCount_; i++)
+                threads_.push_back(std::thread(&GenericNdjsonReader::ThreadMain, this, i));
+        }
+
+        Job<Callback> job = { this, str, length, &callback, delivery, file };
+        nextChunk_.store(0);
+        stopOffset_.store(~size_t(0));
+        recordCount_.store(0);
+        deliverTurn_ = 0;
+        aborted_ = false;
+        result_.Clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &GenericNdjsonReader::template RunJob<parseFlags, Callback>;
+            jobContext_ = &job;
+            busy_ = static_cast<unsigned>(threads_.size());
+            generation_++;
+        }
+        wake_.notify_all();
+
+        RunJob<parseFlags, Callback>(&job, *workers_[0]);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (busy_ != 0)
+            done_.wait(lock);
+        job_ = 0;
+        jobContext_ = 0;
+        return result_;
+    }
+
+    void ThreadMain(unsigned index) {
+        unsigned generation = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            while (!exit_ && generation_ == generation)
+                wake_.wait(lock);
+            if (exit_)
+                return;
+            generation = generation_;
+            void (*job)(void*, Worker&) = job_;
+            void* context = jobContext_;
+            lock.unlock();
+            job(context, *workers_[index]);
+            lock.lock();
+            if (--busy_ == 0)
+                done_.notify_one();
+        }
+    }
+
+    template <unsigned parseFlags, typename Callback>
+    static void RunJob(void* context, Worker& worker) {
+        Job<Callback>& job = *static_cast<Job<Callback>*>(context);
+        GenericNdjsonReader& r = *job.reader;
+        for (;;) {
+            // Chunks are taken in increasing order, so none is needed after the first one beyond an error.
+            size_t chunk = r.nextChunk_.fetch_add(1);
+            if (chunk >= (job.length + r.chunkSize_ - 1) / r.chunkSize_)
+                break;
+            size_t begin = chunk * r.chunkSize_;
+            if (begin > r.stopOffset_.load(std::memory_order_relaxed))
+                break;
+            size_t end = job.length - begin > r.chunkSize_ ? begin + r.chunkSize_ : job.length;
+
+            r.template ParseChunk<parseFlags>(job, worker, begin, end);
+            if (job.delivery == kNdjsonOrdered)
+                r.DeliverChunk(job, worker, chunk);
+            worker.allocator.Reset();
+            if (job.file)
+                job.file->Release(begin, end - begin);
+        }
+    }
+
+    template <unsigned parseFlags, typename Callback>
+    void ParseChunk(Job<Callback>& job, Worker& worker, size_t begin, size_t end) {
+        const Ch* const str = job.str;
+        const Ch* const last = str + end;
+        const Ch* const eof = str + job.length;
+        const Ch* p = str + begin;
+        if (begin != 0) {
+            // The first record of the chunk starts after the first newline at begin - 1 or later.
+            const Ch* nl = static_cast<const Ch*>(std::memchr(p - 1, '\n', static_cast<size_t>(eof - (p - 1))));
+            if (!nl)
+                return;
+            p = nl + 1;
+        }
+
+        DocumentType& d = worker.document;
+        size_t count = 0;
+        while (p < last) {
+            size_t offset = static_cast<size_t>(p - str);
+            if (offset > stopOffset_.load(std::memory_order_relaxed))
+                break;
+            const Ch* nl = static_cast<const Ch*>(std::memchr(p, '\n', static_cast<size_t>(eof - p)));
+            const Ch* lineEnd = nl ? nl : eof;
+
+            if (!IsBlank(p, lineEnd)) {
+                d.template Parse<parseFlags>(p, static_cast<size_t>(lineEnd - p));
+                if (RAPIDJSON_UNLIKELY(d.HasParseError())) {
+                    if (job.delivery == kNdjsonOrdered) {
+                        worker.error.Set(d.GetParseError(), offset + d.GetErrorOffset());
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        Stop(worker.error.Offset());
+                    }
+                    else
+                        ReportError(d.GetParseError(), offset + d.GetErrorOffset());
+                    break;
+                }
+                if (job.delivery == kNdjsonOrdered) {
+                    Record* record = new (worker.records.template Push<Record>()) Record();
+                    record->value = static_cast<ValueType&>(d);    // move, the memory stays in the worker allocator
+                    record->offset = offset;
+                }
+                else {
+                    if (!(*job.callback)(static_cast<ValueType&>(d), offset)) {
+                        ReportError(kParseErrorTermination, offset);
+                        break;
+                    }
+                    count++;
+                    worker.allocator.Reset();
+                }
+            }
+
+            if (!nl)
+                break;
+            p = nl + 1;
+        }
+        if (count)
+            recordCount_.fetch_add(count);
+    }
+
+    template <typename Callback>
+    void DeliverChunk(Job<Callback>& job, Worker& worker, size_t chunk) {
+        bool deliver;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!aborted_ && deliverTurn_ != chunk)
+                turn_.wait(lock);
+            deliver = !aborted_;
+        }
+
+        if (deliver) {
+            ParseResult stop = worker.error;
+            Record* records = worker.records.template Bottom<Record>();
+            size_t count = worker.records.GetSize() / sizeof(Record);
+            size_t i = 0;
+            for (; i < count; i++)
+                if (!(*job.callback)(records[i].value, records[i].offset)) {
+                    stop.Set(kParseErrorTermination, records[i].offset);
+                    break;
+                }
+            recordCount_.fetch_add(i);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop.IsError()) {
+                    aborted_ = true;
+                    result_ = stop;
+                    Stop(stop.Offset());
+                }
+                else
+                    deliverTurn_++;
+            }
+            turn_.notify_all();
+        }
+
+        worker.records.Clear();
+        worker.error.Clear();
+    }
+
+    // Both called with mutex_ held or taking it, stopOffset_ is only written under it.
+    void Stop(size_t offset) {
+        if (offset < stopOffset_.load(std::memory_order_relaxed))
+            stopOffset_.store(offset, std::memory_order_relaxed);
+    }
+
+    void ReportError(ParseErrorCode code, size_t offset) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!result_.IsError() || offset < result_.Offset())
+            result_.Set(code, offset);
+        Stop(offset);
+    }
+
+    static bool IsBlank(const Ch* p, const Ch* end) {
+        for (; p != end; ++p)
+            if (*p != ' ' && *p != '\t' && *p != '\r')
+                return false;
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Worker> > workers_;
+    std::vector<std::thread> threads_;
+    unsigned workerCount_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;  // a job was posted or the reader is destroyed
+    std::condition_variable done_;  // all threads finished the job
+    std::condition_variable turn_;  // deliverTurn_ advanced or delivery was aborted
+    unsigned generation_;
+    unsigned busy_;
+    bool exit_;
+    void (*job_)(void*, Worker&);
+    void* jobContext_;
+
+    size_t chunkSize_;
+    std::atomic<size_t> nextChunk_;
+    std::atomic<size_t> stopOffset_;    // no record starting after it is needed
+    std::atomic<size_t> recordCount_;
+    size_t deliverTurn_;                // next chunk to deliver in ordered mode
+    bool aborted_;
+    ParseResult result_;
+};
+
+//! NDJSON reader with the default Document.
+typedef GenericNdjsonReader<Document> NdjsonReader;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_NDJSONREADER_H_
@@ -0,0 +1,687 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PATCH_H_
+#define RAPIDJSON_PATCH_H_
+
+/*! \file patch.h */
+
+#include "pointer.h"
+#include "internal/stack.h"
+#include <cmath>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(switch-enum)
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Error code of applying a JSON Patch.
+/*! \ingroup RAPIDJSON_ERRORS
+    \see ApplyPatch
+*/
+enum PatchErrorCode {
+    kPatchErrorNone = 0,            //!< The patch is applied successfully
+
+    kPatchErrorInvalidOperation,    //!< The patch is not an array of operation objects, or an operation misses a member
+    kPatchErrorInvalidPointer,      //!< A "path" or "from" member is not a valid JSON pointer
+    kPatchErrorPathNotFound,        //!< A "path" or "from" member does not resolve in the document
+    kPatchErrorTestFailed           //!< A "test" operation did not match
+};
+
+namespace internal {
+
+//! Member names and operation names of RFC 6902 in the encoding of ValueType.
+template <typename ValueType>
+struct PatchKeywords {
+    typedef typename ValueType::Ch Ch;
+
+#define RAPIDJSON_STRING_(name, ...) \
+    static const ValueType& Get##name##String() {\
+        static const Ch s[] = { __VA_ARGS__, '\0' };\
+        static const ValueType v(s, sizeof(s) / sizeof(Ch) - 1);\
+        return v;\
+    }
+
+    RAPIDJSON_STRING_(Op, 'o', 'p')
+    RAPIDJSON_STRING_(Path, 'p', 'a', 't', 'h')
+    RAPIDJSON_STRING_(From, 'f', 'r', 'o', 'm')
+    RAPIDJSON_STRING_(Value, 'v', 'a', 'l', 'u', 'e')
+    RAPIDJSON_STRING_(Add, 'a', 'd', 'd')
+    RAPIDJSON_STRING_(Remove, 'r', 'e', 'm', 'o', 'v', 'e')
+    RAPIDJSON_STRING_(Replace, 'r', 'e', 'p', 'l', 'a', 'c', 'e')
+    RAPIDJSON_STRING_(Move, 'm', 'o', 'v', 'e')
+    RAPIDJSON_STRING_(Copy, 'c', 'o', 'p', 'y')
+    RAPIDJSON_STRING_(Test, 't', 'e', 's', 't')
+
+#undef RAPIDJSON_STRING_
+};
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericDiffer
+
+//! Computes RFC 6902 "JavaScript Object Notation (JSON) Patch" documents (https://tools.ietf.org/html/rfc6902).
+/*!
+    Diff() walks two DOM trees side by side and appends to a patch array the
+    "add", "remove" and "replace" operations which turn the first tree into the
+    second. Operations are addressed with JSON pointers (see GenericPointer) and
+    can be applied with ApplyPatch().
+
+    - Object members are matched by name, the member order is ignored. Objects
+      of the second tree with many members are hashed first, so that matching
+      objects of n and m members costs O(n + m).
+    - Array elements are matched by index: common elements are compared, extra
+      elements are added or removed at the end.
+    - Numbers are equal when they differ by no more than the epsilon of their
+      path, see SetEpsilon(). Integers are compared exactly with a zero epsilon.
+
+    The trees are neither copied nor modified. Only the patch allocates: its
+    operation objects, path strings and copies of the new values all come from the
+    allocator passed to Diff(), e.g. the MemoryPoolAllocator of a patch document
+    which is reset every frame. The current path, the epsilon table and the
+    member hash tables live in buffers of the differ which are kept across
+    calls, so a long-lived differ stops allocating after the first few calls.
+
+\code
+    Differ differ;
+    differ.SetEpsilon(Pointer("/position"), 1e-6);
+    Document patch;
+    differ.Diff(previous, current, patch);
+    // patch: [{"op":"replace","path":"/position/lat","value":47.26}, ...]
+\endcode
+
+    \tparam ValueType Type of the DOM trees, e.g. GenericValue<UTF8<> >.
+    \tparam StackAllocator Allocator for the path, epsilon and hash table buffers.
+*/
+template <typename ValueType, typename StackAllocator = CrtAllocator>
+class GenericDiffer {
+public:
+    typedef typename ValueType::Ch Ch;                          //!< Character type from Value
+    typedef typename ValueType::AllocatorType AllocatorType;    //!< Allocator type of the patch
+    typedef GenericPointer<ValueType, StackAllocator> PointerType; //!< JSON pointer type addressing epsilons
+
+    //! Constructor.
+    /*! \param allocator Optional allocator for the path, epsilon and hash table buffers. If null, the buffers create their own.
+    */
+    GenericDiffer(StackAllocator* allocator = 0) :
+        path_(allocator, kDefaultPathCapacity), epsilons_(allocator, kDefaultEpsilonCapacity), epsilonPaths_(allocator, kDefaultPathCapacity),
+        tables_(allocator, kDefaultTableCapacity), epsilon_(0.0) {}
+
+    //!@name Numeric epsilons
+    //@{
+
+    //! Sets the epsilon for all numbers without a more specific one.
+    /*! \param epsilon Largest absolute difference of two numbers considered equal. 0 compares exactly.
+    */
+    void SetEpsilon(double epsilon) { epsilon_ = epsilon; }
+
+    //! Sets the epsilon for the numbers at a path and below it.
+    /*! The longest matching path wins, e.g. "/position/alt" overrides "/position".
+        \param pointer Path of the value or subtree.
+        \param epsilon Largest absolute difference of two numbers considered equal.
+        \return Whether the pointer is valid.
+    */
+    bool SetEpsilon(const PointerType& pointer, double epsilon) {
+        if (!pointer.IsValid())
+            return false;
+
+        const size_t offset = epsilonPaths_.GetSize() / sizeof(Ch);
+        PathStream os(epsilonPaths_);
+        pointer.Stringify(os);
+        const size_t length = epsilonPaths_.GetSize() / sizeof(Ch) - offset;
+
+        for (Epsilon* e = epsilons_.template Bottom<Epsilon>(); e != epsilons_.template End<Epsilon>(); ++e)
+            if (e->length == length && std::memcmp(GetEpsilonPath(*e), GetEpsilonPath(offset), length * sizeof(Ch)) == 0) {
+                epsilonPaths_.template Pop<Ch>(length);
+                e->epsilon = epsilon;
+                return true;
+            }
+
+        Epsilon* e = epsilons_.template Push<Epsilon>();
+        e->offset = offset;
+        e->length = length;
+        e->epsilon = epsilon;
+        return true;
+    }
+
+    //! Removes all path specific epsilons.
+    void ClearEpsilons() {
+        epsilons_.Clear();
+        epsilonPaths_.Clear();
+    }
+
+    //@}
+
+    //!@name Diff
+    //@{
+
+    //! Appends to \c patch the operations turning \c a into \c b.
+    /*!
+        \param a Source value.
+        \param b Target value.
+        \param patch Receives the operations. It is made an array if it is not one; existing operations are kept.
+        \param allocator Allocator for the operations, normally the allocator of \c patch's document.
+        \return \c patch.
+    */
+    ValueType& Diff(const ValueType& a, const ValueType& b, ValueType& patch, AllocatorType& allocator) {
+        if (!patch.IsArray())
+            patch.SetArray();
+        path_.Clear();
+        DiffValue(a, b, patch, allocator);
+        return patch;
+    }
+
+    //! Stores in a document the operations turning \c a into \c b.
+    /*!
+        \param a Source value.
+        \param b Target value.
+        \param patch Document receiving the operations, its previous content is discarded.
+        \return \c patch.
+    */
+    template <typename DocumentType>
+    DocumentType& Diff(const ValueType& a, const ValueType& b, DocumentType& patch) {
+        patch.SetArray();
+        Diff(a, b, patch, patch.GetAllocator());
+        return patch;
+    }
+
+    //@}
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericDiffer(const GenericDiffer&);
+    GenericDiffer& operator=(const GenericDiffer&);
+
+    typedef internal::PatchKeywords<ValueType> Keywords;
+
+    struct Epsilon {
+        size_t offset;      //!< Offset of the path in epsilonPaths_, in characters.
+        size_t length;      //!< Length of the path.
+        double epsilon;
+    };
+
+    //! Slot of the hash table of an object's members: position + 1 of a member, 0 for an empty slot.
+    struct MemberSlot {
+        SizeType hash;
+        SizeType pos;
+    };
+
+    //! Hash table over the members of an object, kept in tables_ and addressed by offset since nested objects may move the buffer.
+    struct MemberTable {
+        size_t offset;      //!< Offset of the slots in tables_, in bytes, followed by one matched flag per member.
+        SizeType mask;      //!< Slot count - 1.
+        SizeType count;     //!< Member count.
+    };
+
+    //! Output stream appending to a character stack, for GenericPointer::Stringify().
+    class PathStream {
+    public:
+        typedef typename ValueType::Ch Ch;
+        PathStream(internal::Stack<StackAllocator>& stack) : stack_(stack) {}
+        void Put(Ch c) { *stack_.template Push<Ch>() = c; }
+        void Flush() {}
+    private:
+        PathStream(const PathStream&);
+        PathStream& operator=(const PathStream&);
+        internal::Stack<StackAllocator>& stack_;
+    };
+
+    const Ch* GetEpsilonPath(size_t offset) const { return epsilonPaths_.template Bottom<Ch>() + offset; }
+    const Ch* GetEpsilonPath(const Epsilon& e) const { return GetEpsilonPath(e.offset); }
+
+    //! Epsilon of the current path: the longest epsilon path which is the path itself or one of its parents.
+    double GetEpsilon() const {
+        const Ch* path = path_.template Bottom<Ch>();
+        const size_t length = path_.GetSize() / sizeof(Ch);
+        double epsilon = epsilon_;
+        size_t matched = 0;
+        for (const Epsilon* e = epsilons_.template Bottom<Epsilon>(); e != epsilons_.template End<Epsilon>(); ++e)
+            if (e->length <= length && (e->length == length || path[e->length] == '/') &&
+                (e->length > matched || (e->length == 0 && matched == 0)) &&
+                std::memcmp(path, GetEpsilonPath(*e), e->length * sizeof(Ch)) == 0) {
+                epsilon = e->epsilon;
+                matched = e->length;
+            }
+        return epsilon;
+    }
+
+    bool NumberEqual(const ValueType& a, const ValueType& b) const {
+        if (a == b)
+            return true;
+        const double epsilon = GetEpsilon();
+        return epsilon > 0.0 && std::fabs(a.GetDouble() - b.GetDouble()) <= epsilon;
+    }
+
+    void DiffValue(const ValueType& a, const ValueType& b, ValueType& patch, AllocatorType& allocator) {
+        const Type type = a.GetType();
+        if (type != b.GetType()) {
+            AddOperation(Keywords::GetReplaceString(), &b, patch, allocator);
+            return;
+        }
+
+        switch (type) {
+        case kObjectType:
+            if (b.MemberCount() >= kHashedMemberCount) {
+                DiffHashedObject(a, b, patch, allocator);
+                break;
+            }
+            for (typename ValueType::ConstMemberIterator m = a.MemberBegin(); m != a.MemberEnd(); ++m) {
+                const size_t length = PushName(m->name);
+                typename ValueType::ConstMemberIterator n = b.FindMember(m->name);
+                if (n == b.MemberEnd())
+                    AddOperation(Keywords::GetRemoveString(), 0, patch, allocator);
+                else
+                    DiffValue(m->value, n->value, patch, allocator);
+                path_.template Pop<Ch>(length);
+            }
+            for (typename ValueType::ConstMemberIterator n = b.MemberBegin(); n != b.MemberEnd(); ++n)
+                if (a.FindMember(n->name) == a.MemberEnd()) {
+                    const size_t length = PushName(n->name);
+                    AddOperation(Keywords::GetAddString(), &n->value, patch, allocator);
+                    path_.template Pop<Ch>(length);
+                }
+            break;
+
+        case kArrayType:
+            {
+                const SizeType sizeA = a.Size();
+                const SizeType sizeB = b.Size();
+                const SizeType common = sizeA < sizeB ? sizeA : sizeB;
+                for (SizeType i = 0; i < common; i++) {
+                    const size_t length = PushIndex(i);
+                    DiffValue(a[i], b[i], patch, allocator);
+                    path_.template Pop<Ch>(length);
+                }
+                for (SizeType i = common; i < sizeB; i++) {
+                    const size_t length = PushIndex(i);
+                    AddOperation(Keywords::GetAddString(), &b[i], patch, allocator);
+                    path_.template Pop<Ch>(length);
+                }
+                // Remove from the end, so that the indices of the remaining elements stay valid.
+                for (SizeType i = sizeA; i > common; i--) {
+                    const size_t length = PushIndex(i - 1);
+                    AddOperation(Keywords::GetRemoveString(), 0, patch, allocator);
+                    path_.template Pop<Ch>(length);
+                }
+            }
+            break;
+
+        case kNumberType:
+            if (!NumberEqual(a, b))
+                AddOperation(Keywords::GetReplaceString(), &b, patch, allocator);
+            break;
+
+        case kStringType:
+            if (a != b)
+                AddOperation(Keywords::GetReplaceString(), &b, patch, allocator);
+            break;
+
+        default: // null, true, false: equal types are equal values
+            break;
+        }
+    }
+
+    //! Diffs two objects through a hash table over the members of \c b, in the member order of the linear matching.
+    void DiffHashedObject(const ValueType& a, const ValueType& b, ValueType& patch, AllocatorType& allocator) {
+        const SizeType count = b.MemberCount();
+        SizeType slots = 1;
+        while (slots < count * 2)
+            slots <<= 1;
+
+        MemberTable table;
+        table.offset = tables_.GetSize();
+        table.mask = slots - 1;
+        table.count = count;
+        const size_t size = slots * sizeof(MemberSlot) + RAPIDJSON_ALIGN(count);   // keeps the next table aligned
+        std::memset(tables_.template Push<char>(size), 0, size);
+
+        typename ValueType::ConstMemberIterator members = b.MemberBegin();
+        for (SizeType i = 0; i < count; i++) {    // linear probing, earlier members win on duplicate names
+            const SizeType hash = internal::HashString(members[i].name.GetString(), members[i].name.GetStringLength());
+            MemberSlot* slot = GetSlots(table);
+            SizeType k = hash & table.mask;
+            while (slot[k].pos != 0)
+                k = (k + 1) & table.mask;
+            slot[k].hash = hash;
+            slot[k].pos = i + 1;
+        }
+
+        for (typename ValueType::ConstMemberIterator m = a.MemberBegin(); m != a.MemberEnd(); ++m) {
+            const size_t length = PushName(m->name);
+            const SizeType pos = FindSlot(table, members, m->name);
+            if (pos == count)
+                AddOperation(Keywords::GetRemoveString(), 0, patch, allocator);
+            else {
+                GetMatched(table)[pos] = 1;
+                DiffValue(m->value, members[pos].value, patch, allocator);
+            }
+            path_.template Pop<Ch>(length);
+        }
+        // A member of b exists in a when the first member of b with its name was matched.
+        for (SizeType i = 0; i < count; i++)
+            if (!GetMatched(table)[FindSlot(table, members, members[i].name)]) {
+                const size_t length = PushName(members[i].name);
+                AddOperation(Keywords::GetAddString(), &members[i].value, patch, allocator);
+                path_.template Pop<Ch>(length);
+            }
+
+        tables_.template Pop<char>(size);
+    }
+
+    MemberSlot* GetSlots(const MemberTable& table) { return reinterpret_cast<MemberSlot*>(tables_.template Bottom<char>() + table.offset); }
+    char* GetMatched(const MemberTable& table) { return reinterpret_cast<char*>(GetSlots(table) + table.mask + 1); }
+
+    //! Position of the first member named \c name, or the member count if there is none.
+    SizeType FindSlot(const MemberTable& table, typename ValueType::ConstMemberIterator members, const ValueType& name) {
+        const SizeType hash = internal::HashString(name.GetString(), name.GetStringLength());
+        const MemberSlot* slot = GetSlots(table);
+        for (SizeType k = hash & table.mask; slot[k].pos != 0; k = (k + 1) & table.mask)
+            if (slot[k].hash == hash && members[slot[k].pos - 1].name == name)
+                return slot[k].pos - 1;
+        return table.count;
+    }
+
+    //! Appends an escaped name token to the current path, returns the number of characters appended.
+    size_t PushName(const ValueType& name) {
+        const Ch* s = name.GetString();
+        const SizeType length = name.GetStringLength();
+        size_t count = 1;
+        for (SizeType i = 0; i < length; i++)
+            count += (s[i] == '~' || s[i] == '/') ? 2 : 1;
+
+        Ch* p = path_.template Push<Ch>(count);
+        *p++ = '/';
+        for (SizeType i = 0; i < length; i++) {
+            if (s[i] == '~') {
+                *p++ = '~';
+                *p++ = '0';
+            }
+            else if (s[i] == '/') {
+                *p++ = '~';
+                *p++ = '1';
+            }
+            else
+                *p++ = s[i];
+        }
+        return count;
+    }
+
+    //! Appends an index token to the current path, returns the number of characters appended.
+    size_t PushIndex(SizeType index) {
+        char buffer[21];
+        const char* end = internal::u32toa(static_cast<uint32_t>(index), buffer);
+        const size_t count = static_cast<size_t>(end - buffer) + 1;
+        Ch* p = path_.template Push<Ch>(count);
+        *p++ = '/';
+        for (const char* q = buffer; q != end; ++q)
+            *p++ = static_cast<Ch>(*q);
+        return count;
+    }
+
+    void AddOperation(const ValueType& op, const ValueType* value, ValueType& patch, AllocatorType& allocator) {
+        static const Ch kRootPath[] = { '\0' };
+        ValueType operation(kObjectType);
+        operation.AddMember(ValueType(Keywords::GetOpString(), allocator).Move(), ValueType(op, allocator).Move(), allocator);
+        operation.AddMember(ValueType(Keywords::GetPathString(), allocator).Move(), path_.Empty() ? ValueType(kRootPath, 0).Move() :
+            ValueType(path_.template Bottom<Ch>(), static_cast<SizeType>(path_.GetSize() / sizeof(Ch)), allocator).Move(), allocator);
+        if (value) {
+            ValueType copy;
+            CopyValue(copy, *value, allocator);
+            operation.AddMember(ValueType(Keywords::GetValueString(), allocator).Move(), copy, allocator);
+        }
+        patch.PushBack(operation, allocator);
+    }
+
+    //! Deep copy using only \c allocator (the copy constructor of GenericValue goes through a temporary document stack).
+    static void CopyValue(ValueType& copy, const ValueType& v, AllocatorType& allocator) {
+        switch (v.GetType()) {
+        case kObjectType:
+            copy.SetObject();
+            for (typename ValueType::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+                ValueType value;
+                CopyValue(value, m->value, allocator);
+                copy.AddMember(ValueType(m->name, allocator).Move(), value, allocator);
+            }
+            break;
+        case kArrayType:
+            copy.SetArray().Reserve(v.Size(), allocator);
+            for (typename ValueType::ConstValueIterator e = v.Begin(); e != v.End(); ++e) {
+                ValueType value;
+                CopyValue(value, *e, allocator);
+                copy.PushBack(value, allocator);
+            }
+            break;
+        default:
+            copy.CopyFrom(v, allocator);
+            break;
+        }
+    }
+
+    static const size_t kDefaultPathCapacity = 256;     //!< Default capacity of the path buffers in bytes.
+    static const size_t kDefaultEpsilonCapacity = 8 * sizeof(Epsilon);
+    static const size_t kDefaultTableCapacity = 1024;   //!< Default capacity of the hash table buffer in bytes.
+    static const SizeType kHashedMemberCount = 16;      //!< Objects of \c b with fewer members are matched linearly.
+
+    internal::Stack<StackAllocator> path_;          //!< Escaped JSON pointer of the values being compared.
+    internal::Stack<StackAllocator> epsilons_;      //!< Path specific epsilons (Epsilon).
+    internal::Stack<StackAllocator> epsilonPaths_;  //!< Stringified paths of epsilons_.
+    internal::Stack<StackAllocator> tables_;        //!< Member hash tables of the objects being compared, see MemberTable.
+    double epsilon_;                                //!< Default epsilon.
+};
+
+//! GenericDiffer for Value (UTF-8, default allocator).
+typedef GenericDiffer<Value> Differ;
+
+//!@name Helper functions for JSON Patch
+//@{
+
+//! Stores in \c patch the RFC 6902 operations turning \c a into \c b, comparing numbers exactly.
+/*! \see GenericDiffer for numeric epsilons and reusing buffers across calls.
+*/
+template <typename DocumentType>
+DocumentType& Diff(const typename DocumentType::ValueType& a, const typename DocumentType::ValueType& b, DocumentType& patch) {
+    GenericDiffer<typename DocumentType::ValueType> differ;
+    return differ.Diff(a, b, patch);
+}
+
+//! Appends to \c patch the RFC 6902 operations turning \c a into \c b, comparing numbers exactly.
+template <typename T>
+T& Diff(const T& a, const T& b, T& patch, typename T::AllocatorType& allocator) {
+    GenericDiffer<T> differ;
+    return differ.Diff(a, b, patch, allocator);
+}
+
+namespace internal {
+
+// Adds a value at a path as the "add" operation of RFC 6902 does: replaces an existing member,
+// inserts into an array (or appends with "-"), or replaces the whole document with an empty path.
+template <typename ValueType, typename PointerType>
+PatchErrorCode PatchAdd(ValueType& root, const PointerType& pointer, ValueType& value, typename ValueType::AllocatorType& allocator) {
+    const size_t count = pointer.GetTokenCount();
+    if (count == 0) {
+        root = value;
+        return kPatchErrorNone;
+    }
+
+    const typename PointerType::Token& last = pointer.GetTokens()[count - 1];
+    PointerType parentPointer(pointer.GetTokens(), count - 1);
+    ValueType* parent = parentPointer.Get(root);
+    if (!parent)
+        return kPatchErrorPathNotFound;
+
+    if (parent->IsObject()) {
+        typename ValueType::MemberIterator m = parent->FindMember(GenericStringRef<typename ValueType::Ch>(last.name, last.length));
+        if (m != parent->MemberEnd())
+            m->value = value;
+        else
+            parent->AddMember(ValueType(last.name, last.length, allocator).Move(), value, allocator);
+        return kPatchErrorNone;
+    }
+
+    if (parent->IsArray()) {
+        if (last.length == 1 && last.name[0] == '-') {
+            parent->PushBack(value, allocator);
+            return kPatchErrorNone;
+        }
+        if (last.index == kPointerInvalidIndex || last.index > parent->Size())
+            return kPatchErrorPathNotFound;
+        parent->PushBack(value, allocator);
+        for (SizeType i = parent->Size() - 1; i > last.index; i--)
+            (*parent)[i].Swap((*parent)[i - 1]);
+        return kPatchErrorNone;
+    }
+
+    return kPatchErrorPathNotFound;
+}
+
+template <typename ValueType>
+const ValueType* GetPatchMember(const ValueType& operation, const ValueType& name) {
+    typename ValueType::ConstMemberIterator m = operation.FindMember(name);
+    return m != operation.MemberEnd() ? &m->value : 0;
+}
+
+template <typename ValueType>
+PatchErrorCode ApplyPatchOperation(ValueType& root, const ValueType& operation, typename ValueType::AllocatorType& allocator) {
+    typedef PatchKeywords<ValueType> Keywords;
+    typedef GenericPointer<ValueType> PointerType;
+
+    if (!operation.IsObject())
+        return kPatchErrorInvalidOperation;
+    const ValueType* op = GetPatchMember(operation, Keywords::GetOpString());
+    const ValueType* path = GetPatchMember(operation, Keywords::GetPathString());
+    if (!op || !op->IsString() || !path || !path->IsString())
+        return kPatchErrorInvalidOperation;
+
+    const PointerType pointer(path->GetString(), path->GetStringLength());
+    if (!pointer.IsValid())
+        return kPatchErrorInvalidPointer;
+
+    if (*op == Keywords::GetRemoveString()) {
+        // The root cannot be removed, GenericPointer::Erase() fails for it.
+        return pointer.Erase(root) ? kPatchErrorNone : kPatchErrorPathNotFound;
+    }
+
+    if (*op == Keywords::GetMoveString() || *op == Keywords::GetCopyString()) {
+        const ValueType* from = GetPatchMember(operation, Keywords::GetFromString());
+        if (!from || !from->IsString())
+            return kPatchErrorInvalidOperation;
+        const PointerType fromPointer(from->GetString(), from->GetStringLength());
+        if (!fromPointer.IsValid())
+            return kPatchErrorInvalidPointer;
+        ValueType* source = fromPointer.Get(root);
+        if (!source)
+            return kPatchErrorPathNotFound;
+
+        ValueType value;
+        if (*op == Keywords::GetCopyString())
+            value.CopyFrom(*source, allocator);
+        else {
+            if (fromPointer == pointer)
+                return kPatchErrorNone;
+            // A value cannot be moved into one of its own children.
+            const size_t n = fromPointer.GetTokenCount();
+            if (n < pointer.GetTokenCount() && PointerType(pointer.GetTokens(), n) == fromPointer)
+                return kPatchErrorInvalidOperation;
+            value = *source;
+            fromPointer.Erase(root);
+        }
+        return PatchAdd(root, pointer, value, allocator);
+    }
+
+    const ValueType* value = GetPatchMember(operation, Keywords::GetValueString());
+    if (!value)
+        return kPatchErrorInvalidOperation;
+
+    if (*op == Keywords::GetAddString()) {
+        ValueType copy(*value, allocator);
+        return PatchAdd(root, pointer, copy, allocator);
+    }
+
+    if (*op == Keywords::GetReplaceString()) {
+        ValueType* target = pointer.Get(root);
+        if (!target)
+            return kPatchErrorPathNotFound;
+        target->CopyFrom(*value, allocator);
+        return kPatchErrorNone;
+    }
+
+    if (*op == Keywords::GetTestString()) {
+        const ValueType* target = pointer.Get(root);
+        if (!target)
+            return kPatchErrorPathNotFound;
+        return *target == *value ? kPatchErrorNone : kPatchErrorTestFailed;
+    }
+
+    return kPatchErrorInvalidOperation;
+}
+
+} // namespace internal
+
+//! Applies an RFC 6902 patch to a DOM subtree.
+/*!
+    Supports the "add", "remove", "replace", "move", "copy" and "test" operations.
+    Operations are applied in order; on failure the operations before the failing one
+    remain applied.
+
+    \param root Root value of the DOM subtree to be patched.
+    \param patch Array of operation objects, e.g. produced by Diff().
+    \param allocator Allocator for the values added to \c root.
+    \param errorIndex If not null, receives the index of the failing operation.
+    \return kPatchErrorNone on success, otherwise the error of the failing operation.
+*/
+template <typename T>
+PatchErrorCode ApplyPatch(T& root, const T& patch, typename T::AllocatorType& allocator, SizeType* errorIndex = 0) {
+    if (!patch.IsArray())
+        return kPatchErrorInvalidOperation;
+    for (SizeType i = 0; i < patch.Size(); i++) {
+        PatchErrorCode e = internal::ApplyPatchOperation(root, patch[i], allocator);
+        if (e != kPatchErrorNone) {
+            if (errorIndex)
+                *errorIndex = i;
+            return e;
+        }
+    }
+    return kPatchErrorNone;
+}
+
+//! Applies an RFC 6902 patch to a document.
+/*! \see ApplyPatch(T&, const T&, typename T::AllocatorType&, SizeType*)
+*/
+template <typename DocumentType>
+PatchErrorCode ApplyPatch(DocumentType& document, const typename DocumentType::ValueType& patch, SizeType* errorIndex = 0) {
+    return ApplyPatch<typename DocumentType::ValueType>(document, patch, document.GetAllocator(), errorIndex);
+}
+
+//@}
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PATCH_H_
@@ -0,0 +1,1125 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PERSISTENTVALUE_H_
+#define RAPIDJSON_PERSISTENTVALUE_H_
+
+#include "document.h"
+#include "pointer.h"
+
+/*! \def RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT
+    \ingroup RAPIDJSON_CONFIG
+    \brief Use atomic reference counts in GenericPersistentValue.
+
+    Defaults to 1 when compiling as C++11, so that versions sharing nodes can
+    be copied and released from different threads. Define it to 0 to use
+    plain counters, e.g. in single-threaded WebAssembly modules.
+*/
+#ifndef RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT 1
+#else
+#define RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT 0
+#endif
+#endif // RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT
+
+#if RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericPersistentValue
+
+//! Immutable JSON value whose versions share unchanged subtrees.
+/*!
+    A GenericPersistentValue is a handle to a reference-counted tree of
+    immutable nodes. Copying a handle is O(1). Set(), Remove() and Update()
+    never modify the value they are called on: they return a new version which
+    refers to every node of the old one that did not change. A rolling history
+    of snapshots therefore costs one snapshot plus the changed paths, instead
+    of one GenericDocument::CopyFrom() per entry.
+
+    Members of objects and elements of arrays are stored in a radix tree with
+    32 slots per node, so replacing or appending a member of an object with
+    thousands of members copies O(log32 n) nodes of 32 slots, and a member
+    name is stored once for all versions. Objects also keep a hash array
+    mapped trie from the hashes of the member names to their positions, which
+    versions share in the same way: finding, setting or removing a member by
+    name costs O(log32 n) as well.
+
+    \code
+    PersistentValue::AllocatorType allocator;
+    PersistentValue v0(snapshot, allocator);                           // from any GenericValue
+    PersistentValue v1 = v0.Set(Pointer("/state/LIGHT LANDING"), Value(true), allocator);
+    PersistentValue v2 = v1.Update(nextSnapshot, allocator);           // shares all equal subtrees
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    v1.Accept(writer);                                                 // v0 is unchanged
+    \endcode
+
+    RemoveMember() semantics apply to objects: removing a member moves the last
+    member into its place. Duplicate member names are kept; lookups find the
+    first one.
+
+    \tparam Encoding Encoding of strings.
+    \tparam Allocator Allocator of the nodes. Nodes are freed individually
+        when their last version is released, so it should not be a
+        MemoryPoolAllocator. CrtAllocator by default.
+    \note Every version created with an allocator must be released before
+        the allocator is destroyed.
+*/
+template <typename Encoding, typename Allocator = CrtAllocator>
+class GenericPersistentValue {
+public:
+    typedef typename Encoding::Ch Ch;                           //!< Character type derived from Encoding.
+    typedef Encoding EncodingType;                              //!< Encoding type from template parameter.
+    typedef Allocator AllocatorType;                            //!< Allocator type from template parameter.
+    typedef GenericValue<Encoding, Allocator> ScalarType;       //!< Storage of null, boolean, number and string values.
+
+    //!@name Construction
+    //@{
+
+    //! Default constructor, creates a null value.
+    GenericPersistentValue() : node_() {}
+
+    //! Create a persistent copy of a value.
+    /*! \param value Value to copy, strings are always copied.
+        \param allocator Allocator for the nodes.
+    */
+    template <typename SourceAllocator>
+    GenericPersistentValue(const GenericValue<Encoding, SourceAllocator>& value, Allocator& allocator) : node_(Graft(0, value, allocator)) {}
+
+    //! Copy constructor, shares the tree.
+    GenericPersistentValue(const GenericPersistentValue& rhs) : node_(AddRef(rhs.node_)) {}
+
+#if RAPIDJSON_HAS_CXX11_RVALUE_REFS
+    //! Move constructor in C++11
+    GenericPersistentValue(GenericPersistentValue&& rhs) RAPIDJSON_NOEXCEPT : node_(rhs.node_) { rhs.node_ = 0; }
+#endif
+
+    //! Destructor, frees the nodes not shared with another version.
+    ~GenericPersistentValue() { Release(node_); }
+
+    //! Assignment, shares the tree.
+    GenericPersistentValue& operator=(const GenericPersistentValue& rhs) {
+        const Node* old = node_;
+        node_ = AddRef(rhs.node_);
+        Release(old);
+        return *this;
+    }
+
+#if RAPIDJSON_HAS_CXX11_RVALUE_REFS
+    //! Move assignment in C++11
+    GenericPersistentValue& operator=(GenericPersistentValue&& rhs) RAPIDJSON_NOEXCEPT {
+        if (this != &rhs) {
+            Release(node_);
+            node_ = rhs.node_;
+            rhs.node_ = 0;
+        }
+        return *this;
+    }
+#endif
+
+    //! Exchange the trees of two handles.
+    GenericPersistentValue& Swap(GenericPersistentValue& rhs) RAPIDJSON_NOEXCEPT {
+        internal::Swap(node_, rhs.node_);
+        return *this;
+    }
+
+    //@}
+
+    //!@name Type
+    //@{
+
+    Type GetType() const {
+        if (!node_)
+            return kNullType;
+        switch (node_->kind) {
+        case kObjectNode: return kObjectType;
+        case kArrayNode:  return kArrayType;
+        default:          return GetScalar().GetType();
+        }
+    }
+
+    bool IsNull()   const { return node_ == 0; }
+    bool IsFalse()  const { return IsScalar() && GetScalar().IsFalse(); }
+    bool IsTrue()   const { return IsScalar() && GetScalar().IsTrue(); }
+    bool IsBool()   const { return IsScalar() && GetScalar().IsBool(); }
+    bool IsObject() const { return node_ && node_->kind == kObjectNode; }
+    bool IsArray()  const { return node_ && node_->kind == kArrayNode; }
+    bool IsNumber() const { return IsScalar() && GetScalar().IsNumber(); }
+    bool IsInt()    const { return IsScalar() && GetScalar().IsInt(); }
+    bool IsUint()   const { return IsScalar() && GetScalar().IsUint(); }
+    bool IsInt64()  const { return IsScalar() && GetScalar().IsInt64(); }
+    bool IsUint64() const { return IsScalar() && GetScalar().IsUint64(); }
+    bool IsDouble() const { return IsScalar() && GetScalar().IsDouble(); }
+    bool IsString() const { return IsScalar() && GetScalar().IsString(); }
+
+    //! Whether both handles refer to the same tree, i.e. one is an unchanged version of the other.
+    bool IsSameNode(const GenericPersistentValue& rhs) const { return node_ == rhs.node_; }
+
+    //@}
+
+    //!@name Scalars
+    //@{
+
+    bool GetBool() const { return GetScalar().GetBool(); }
+    int GetInt() const { return GetScalar().GetInt(); }
+    unsigned GetUint() const { return GetScalar().GetUint(); }
+    int64_t GetInt64() const { return GetScalar().GetInt64(); }
+    uint64_t GetUint64() const { return GetScalar().GetUint64(); }
+    double GetDouble() const { return GetScalar().GetDouble(); }
+    const Ch* GetString() const { return GetScalar().GetString(); }
+    SizeType GetStringLength() const { return GetScalar().GetStringLength(); }
+
+    //@}
+
+    //!@name Objects and arrays
+    //@{
+
+    //! Number of members of an object.
+    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); return GetContainer()->size; }
+
+    //! Name of the member at a position, 0 <= index < MemberCount().
+    GenericPersistentValue GetMemberName(SizeType index) const {
+        RAPIDJSON_ASSERT(IsObject() && index < GetContainer()->size);
+        return Share(EntryAt(GetContainer(), index).name);
+    }
+
+    //! Value of the member at a position, 0 <= index < MemberCount().
+    GenericPersistentValue GetMemberValue(SizeType index) const {
+        RAPIDJSON_ASSERT(IsObject() && index < GetContainer()->size);
+        return Share(EntryAt(GetContainer(), index).value);
+    }
+
+    //! Find a member by name.
+    /*! \return Position of the member, MemberCount() if there is no such member.
+    */
+    SizeType FindMember(const Ch* name, SizeType length) const {
+        RAPIDJSON_ASSERT(IsObject());
+        SizeType index = Find(GetContainer(), name, length, internal::HashString(name, length));
+        return index == kNotFound ? GetContainer()->size : index;
+    }
+
+    SizeType FindMember(const Ch* name) const { return FindMember(name, internal::StrLen(name)); }
+
+    bool HasMember(const Ch* name) const { return FindMember(name) != MemberCount(); }
+
+    //! Value of a member, which must exist.
+    GenericPersistentValue operator[](const Ch* name) const {
+        SizeType index = FindMember(name);
+        RAPIDJSON_ASSERT(index != MemberCount());
+        return GetMemberValue(index);
+    }
+
+    //! Number of elements of an array.
+    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); return GetContainer()->size; }
+
+    bool Empty() const { RAPIDJSON_ASSERT(IsObject() || IsArray()); return GetContainer()->size == 0; }
+
+    //! Element of an array, 0 <= index < Size().
+    GenericPersistentValue operator[](SizeType index) const {
+        RAPIDJSON_ASSERT(IsArray() && index < GetContainer()->size);
+        return Share(EntryAt(GetContainer(), index).value);
+    }
+
+    //@}
+
+    //!@name Versions
+    //@{
+
+    //! Get the value a JSON pointer refers to.
+    /*! \param pointer A valid pointer.
+        \param found Optional, receives whether the pointer refers to a value.
+        \return The value, or null if it does not exist.
+    */
+    template <typename T, typename PointerAllocator>
+    GenericPersistentValue Get(const GenericPointer<T, PointerAllocator>& pointer, bool* found = 0) const {
+        RAPIDJSON_ASSERT(pointer.IsValid());
+        const Node* n = node_;
+        bool exist = true;
+        for (const typename GenericPointer<T, PointerAllocator>::Token* t = pointer.GetTokens(); exist && t != pointer.GetTokens() + pointer.GetTokenCount(); ++t) {
+            SizeType index = kNotFound;
+            if (n && n->kind == kObjectNode)
+                index = Find(static_cast<const ContainerNode*>(n), t->name, t->length, internal::HashString(t->name, t->length));
+            else if (n && n->kind == kArrayNode && t->index < static_cast<const ContainerNode*>(n)->size)
+                index = t->index;
+            if (index == kNotFound)
+                exist = false;
+            else
+                n = EntryAt(static_cast<const ContainerNode*>(n), index).value;
+        }
+        if (found)
+            *found = exist;
+        return exist ? Share(n) : GenericPersistentValue();
+    }
+
+    //! Create a version in which a JSON pointer refers to a copy of a value.
+    /*! Missing members, elements and containers along the path are created as
+        GenericPointer::Set() does. Only the nodes on the path are copied.
+        \return The new version, this one is unchanged.
+    */
+    template <typename T, typename PointerAllocator, typename SourceAllocator>
+    GenericPersistentValue Set(const GenericPointer<T, PointerAllocator>& pointer, const GenericValue<Encoding, SourceAllocator>& value, Allocator& allocator) const {
+        GenericPersistentValue v(value, allocator);
+        return Set(pointer, v, allocator);
+    }
+
+    //! Create a version in which a JSON pointer refers to another persistent value, whose tree is shared.
+    template <typename T, typename PointerAllocator>
+    GenericPersistentValue Set(const GenericPointer<T, PointerAllocator>& pointer, const GenericPersistentValue& value, Allocator& allocator) const {
+        RAPIDJSON_ASSERT(pointer.IsValid());
+        return Adopt(SetPath(node_, pointer.GetTokens(), pointer.GetTokenCount(), value.node_, allocator));
+    }
+
+    //! Create a version without the value a JSON pointer refers to.
+    /*! \return The new version, or a handle to this one if the pointer does not refer to a value or is the root.
+        \note Removing an object member moves the last member into its place.
+    */
+    template <typename T, typename PointerAllocator>
+    GenericPersistentValue Remove(const GenericPointer<T, PointerAllocator>& pointer, Allocator& allocator) const {
+        RAPIDJSON_ASSERT(pointer.IsValid());
+        if (pointer.GetTokenCount() == 0)
+            return *this;   // the root cannot be removed, as in GenericPointer::Erase()
+        return Adopt(RemovePath(node_, pointer.GetTokens(), pointer.GetTokenCount(), allocator));
+    }
+
+    //! Create a version equal to a value, sharing every subtree of this version that compares equal.
+    /*! Intended for sources which produce a full state each time: the new
+        version costs only the subtrees that changed. Members are matched by
+        name, expecting the order of the previous version. The member index of
+        an object is shared when its names keep their positions, and rebuilt
+        in O(n) otherwise.
+        \param value The new state.
+        \param allocator Allocator for the changed nodes.
+    */
+    template <typename SourceAllocator>
+    GenericPersistentValue Update(const GenericValue<Encoding, SourceAllocator>& value, Allocator& allocator) const {
+        return Adopt(Graft(node_, value, allocator));
+    }
+
+    //@}
+
+    //! Generate SAX events of the value.
+    template <typename Handler>
+    bool Accept(Handler& handler) const { return Accept(node_, handler); }
+
+    //! Deep comparison, O(1) for versions sharing the tree.
+    bool operator==(const GenericPersistentValue& rhs) const { return Equal(node_, rhs.node_); }
+    bool operator!=(const GenericPersistentValue& rhs) const { return !Equal(node_, rhs.node_); }
+
+private:
+#if RAPIDJSON_PERSISTENT_ATOMIC_REFCOUNT
+    typedef std::atomic<SizeType> RefCount;
+#else
+    typedef SizeType RefCount;
+#endif
+
+    enum NodeKind {
+        kScalarNode,
+        kObjectNode,
+        kArrayNode,
+        kLeafNode,      //!< radix tree node holding entries
+        kBranchNode,    //!< radix tree node holding child nodes
+        kHashLeafNode,  //!< member index node holding the positions of one name hash
+        kHashBranchNode //!< member index node holding child nodes
+    };
+
+    struct Node {
+        explicit Node(unsigned k) : refCount(1), kind(k) {}
+        mutable RefCount refCount;
+        unsigned kind;
+    };
+
+    struct ScalarNode : Node {
+        ScalarNode() : Node(kScalarNode), value() {}
+        ScalarType value;
+    };
+
+    //! Object or array: size members/elements in a radix tree of height shift / kBits + 1.
+    struct ContainerNode : Node {
+        ContainerNode(unsigned k, SizeType s, SizeType sh, const Node* r, const Node* i) : Node(k), size(s), shift(sh), root(r), index(i) {}
+        SizeType size;
+        SizeType shift;
+        const Node* root;   //!< null for an empty container
+        const Node* index;  //!< member index of an object, null for an empty object and for arrays
+    };
+
+    //! Leaf or branch of a radix tree, followed by count entries or children.
+    struct TrieNode : Node {
+        TrieNode(unsigned k, SizeType c) : Node(k), count(c) {}
+        SizeType count;
+    };
+
+    //! Node of the member index, a hash array mapped trie, followed by count children or positions.
+    /*! A branch consumes kBits bits of the hash per level and stores only its occupied
+        slots; a leaf holds the ascending positions of the members whose names have its hash.
+    */
+    struct HashNode : Node {
+        HashNode(unsigned k, SizeType c, uint32_t b) : Node(k), count(c), bits(b) {}
+        SizeType count;
+        uint32_t bits;      //!< bitmap of the occupied slots of a branch, hash of a leaf
+    };
+
+    //! Hash and position of a member, for building a member index.
+    struct IndexEntry {
+        uint32_t hash;
+        SizeType pos;
+    };
+
+    //! Member of an object (name is null for array elements). A null value node is a JSON null.
+    struct Entry {
+        const Node* name;
+        const Node* value;
+        SizeType hash;
+    };
+
+    static const SizeType kBits = 5;
+    static const SizeType kBranch = 1u << kBits;
+    static const SizeType kMask = kBranch - 1;
+    static const SizeType kNotFound = ~SizeType(0);
+    static const size_t kTrieHeaderSize = RAPIDJSON_ALIGN(sizeof(TrieNode));
+    static const size_t kHashHeaderSize = RAPIDJSON_ALIGN(sizeof(HashNode));
+
+    bool IsScalar() const { return node_ && node_->kind == kScalarNode; }
+    const ScalarType& GetScalar() const { RAPIDJSON_ASSERT(IsScalar()); return static_cast<const ScalarNode*>(node_)->value; }
+    const ContainerNode* GetContainer() const { return static_cast<const ContainerNode*>(node_); }
+
+    static GenericPersistentValue Share(const Node* n) { GenericPersistentValue v; v.node_ = AddRef(n); return v; }
+    static GenericPersistentValue Adopt(const Node* n) { GenericPersistentValue v; v.node_ = n; return v; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Nodes
+
+    static const Node* AddRef(const Node* n) {
+        if (n)
+            ++n->refCount;
+        return n;
+    }
+
+    static void Release(const Node* n) {
+        if (!n || --n->refCount != 0)
+            return;
+        switch (n->kind) {
+        case kScalarNode:
+            static_cast<ScalarNode*>(const_cast<Node*>(n))->~ScalarNode();
+            break;
+        case kObjectNode:
+        case kArrayNode:
+            Release(static_cast<const ContainerNode*>(n)->root);
+            Release(static_cast<const ContainerNode*>(n)->index);
+            break;
+        case kHashLeafNode:
+            break;
+        case kHashBranchNode:
+            for (SizeType i = 0; i < static_cast<const HashNode*>(n)->count; i++)
+                Release(HashChildren(n)[i]);
+            break;
+        case kLeafNode:
+            for (SizeType i = 0; i < static_cast<const TrieNode*>(n)->count; i++) {
+                Release(Entries(n)[i].name);
+                Release(Entries(n)[i].value);
+            }
+            break;
+        default:
+            for (SizeType i = 0; i < static_cast<const TrieNode*>(n)->count; i++)
+                Release(Children(n)[i]);
+            break;
+        }
+        Allocator::Free(const_cast<Node*>(n));
+    }
+
+    static Entry* Entries(const Node* n) {
+        return reinterpret_cast<Entry*>(reinterpret_cast<char*>(const_cast<Node*>(n)) + kTrieHeaderSize);
+    }
+
+    static const Node** Children(const Node* n) {
+        return reinterpret_cast<const Node**>(reinterpret_cast<char*>(const_cast<Node*>(n)) + kTrieHeaderSize);
+    }
+
+    static SizeType Count(const Node* n) { return static_cast<const TrieNode*>(n)->count; }
+
+    static const Node** HashChildren(const Node* n) {
+        return reinterpret_cast<const Node**>(reinterpret_cast<char*>(const_cast<Node*>(n)) + kHashHeaderSize);
+    }
+
+    static SizeType* Positions(const Node* n) {
+        return reinterpret_cast<SizeType*>(reinterpret_cast<char*>(const_cast<Node*>(n)) + kHashHeaderSize);
+    }
+
+    static const HashNode* AsHash(const Node* n) { return static_cast<const HashNode*>(n); }
+
+    template <typename SourceAllocator>
+    static const Node* NewScalar(const GenericValue<Encoding, SourceAllocator>& value, Allocator& allocator) {
+        ScalarNode* n = new (allocator.Malloc(sizeof(ScalarNode))) ScalarNode();
+        if (value.IsString())   // const strings must not be shared with the source
+            n->value.SetString(value.GetString(), value.GetStringLength(), allocator);
+        else
+            n->value.CopyFrom(value, allocator);
+        return n;
+    }
+
+    static const Node* NewString(const Ch* str, SizeType length, Allocator& allocator) {
+        ScalarNode* n = new (allocator.Malloc(sizeof(ScalarNode))) ScalarNode();
+        n->value.SetString(str, length, allocator);
+        return n;
+    }
+
+    //! Takes the references to root and index.
+    static const Node* NewContainer(unsigned kind, SizeType size, SizeType shift, const Node* root, const Node* index, Allocator& allocator) {
+        return new (allocator.Malloc(sizeof(ContainerNode))) ContainerNode(kind, size, shift, root, index);
+    }
+
+    static TrieNode* NewTrie(unsigned kind, SizeType count, Allocator& allocator) {
+        size_t slotSize = kind == kLeafNode ? sizeof(Entry) : sizeof(const Node*);
+        return new (allocator.Malloc(kTrieHeaderSize + count * slotSize)) TrieNode(kind, count);
+    }
+
+    static HashNode* NewHash(unsigned kind, SizeType count, uint32_t bits, Allocator& allocator) {
+        size_t slotSize = kind == kHashLeafNode ? sizeof(SizeType) : sizeof(const Node*);
+        return new (allocator.Malloc(kHashHeaderSize + count * slotSize)) HashNode(kind, count, bits);
+    }
+
+    static void SetEntry(Entry& dst, const Entry& src) {
+        dst.name = AddRef(src.name);
+        dst.value = AddRef(src.value);
+        dst.hash = src.hash;
+    }
+
+    //! Copy of a radix tree node with count slots, referencing the first slots of t except the one at skip.
+    static TrieNode* CopyTrie(const Node* t, SizeType count, SizeType skip, Allocator& allocator) {
+        TrieNode* copy = NewTrie(t->kind, count, allocator);
+        const SizeType n = Count(t) < count ? Count(t) : count;
+        for (SizeType i = 0; i < n; i++)
+            if (i != skip) {
+                if (t->kind == kLeafNode)
+                    SetEntry(Entries(copy)[i], Entries(t)[i]);
+                else
+                    Children(copy)[i] = AddRef(Children(t)[i]);
+            }
+        return copy;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Radix tree
+
+    static const Entry& EntryAt(const ContainerNode* c, SizeType index) {
+        const Node* n = c->root;
+        for (SizeType shift = c->shift; shift > 0; shift -= kBits)
+            n = Children(n)[(index >> shift) & kMask];
+        return Entries(n)[index & kMask];
+    }
+
+    static bool NameEquals(const Node* name, const Ch* str, SizeType length) {
+        const ScalarType& s = static_cast<const ScalarNode*>(name)->value;
+        return s.GetStringLength() == length && std::memcmp(s.GetString(), str, length * sizeof(Ch)) == 0;
+    }
+
+    //! Position of the first member with a name, through the member index.
+    static SizeType Find(const ContainerNode* c, const Ch* name, SizeType length, SizeType hash) {
+        const Node* leaf = IndexFind(c->index, static_cast<uint32_t>(hash));
+        for (SizeType k = 0; leaf && k < AsHash(leaf)->count; k++)
+            if (NameEquals(EntryAt(c, Positions(leaf)[k]).name, name, length))
+                return Positions(leaf)[k];
+        return kNotFound;
+    }
+
+    static const Node* TrieSet(const Node* t, SizeType shift, SizeType index, const Entry& e, Allocator& allocator) {
+        const SizeType i = (index >> shift) & kMask;
+        TrieNode* copy = CopyTrie(t, Count(t), i, allocator);
+        if (shift == 0)
+            SetEntry(Entries(copy)[i], e);
+        else
+            Children(copy)[i] = TrieSet(Children(t)[i], shift - kBits, index, e, allocator);
+        return copy;
+    }
+
+    static const Node* NewPath(SizeType shift, const Entry& e, Allocator& allocator) {
+        TrieNode* t = NewTrie(shift == 0 ? kLeafNode : kBranchNode, 1, allocator);
+        if (shift == 0)
+            SetEntry(Entries(t)[0], e);
+        else
+            Children(t)[0] = NewPath(shift - kBits, e, allocator);
+        return t;
+    }
+
+    static const Node* TriePush(const Node* t, SizeType shift, SizeType index, const Entry& e, Allocator& allocator) {
+        const SizeType i = (index >> shift) & kMask;
+        if (shift == 0) {
+            TrieNode* copy = CopyTrie(t, Count(t) + 1, kNotFound, allocator);
+            SetEntry(Entries(copy)[i], e);
+            return copy;
+        }
+        if (i < Count(t)) {
+            TrieNode* copy = CopyTrie(t, Count(t), i, allocator);
+            Children(copy)[i] = TriePush(Children(t)[i], shift - kBits, index, e, allocator);
+            return copy;
+        }
+        TrieNode* copy = CopyTrie(t, Count(t) + 1, kNotFound, allocator);
+        Children(copy)[i] = NewPath(shift - kBits, e, allocator);
+        return copy;
+    }
+
+    //! Returns a copy without the last entry, which is at index, or null if nothing is left.
+    static const Node* TriePop(const Node* t, SizeType shift, SizeType index, Allocator& allocator) {
+        if (shift == 0)
+            return Count(t) == 1 ? 0 : CopyTrie(t, Count(t) - 1, kNotFound, allocator);
+        const SizeType i = (index >> shift) & kMask;
+        const Node* child = TriePop(Children(t)[i], shift - kBits, index, allocator);
+        if (!child && i == 0)
+            return 0;
+        TrieNode* copy = CopyTrie(t, child ? Count(t) : Count(t) - 1, child ? i : kNotFound, allocator);
+        if (child)
+            Children(copy)[i] = child;
+        return copy;
+    }
+
+    //! The container operations take the reference to the member index of the result, null for arrays.
+    static const Node* Replace(const ContainerNode* c, SizeType index, const Entry& e, const Node* names, Allocator& allocator) {
+        return NewContainer(c->kind, c->size, c->shift, TrieSet(c->root, c->shift, index, e, allocator), names, allocator);
+    }
+
+    static const Node* Push(unsigned kind, const ContainerNode* c, const Entry& e, const Node* names, Allocator& allocator) {
+        if (!c || c->size == 0)
+            return NewContainer(kind, 1, 0, NewPath(0, e, allocator), names, allocator);
+        if (c->shift + kBits < sizeof(SizeType) * 8 && c->size == (SizeType(1) << (c->shift + kBits))) {
+            TrieNode* root = NewTrie(kBranchNode, 2, allocator);    // full, grow by one level
+            Children(root)[0] = AddRef(c->root);
+            Children(root)[1] = NewPath(c->shift, e, allocator);
+            return NewContainer(kind, c->size + 1, c->shift + kBits, root, names, allocator);
+        }
+        return NewContainer(kind, c->size + 1, c->shift, TriePush(c->root, c->shift, c->size, e, allocator), names, allocator);
+    }
+
+    static const Node* Pop(const ContainerNode* c, const Node* names, Allocator& allocator) {
+        RAPIDJSON_ASSERT(c->size > 0);
+        const Node* root = TriePop(c->root, c->shift, c->size - 1, allocator);
+        SizeType shift = c->shift;
+        if (root && shift > 0 && Count(root) == 1) {   // shrink by one level
+            const Node* child = AddRef(Children(root)[0]);
+            Release(root);
+            root = child;
+            shift -= kBits;
+        }
+        return NewContainer(c->kind, c->size - 1, shift, root, names, allocator);
+    }
+
+    //! Node of the old tree covering the same entries as the node at a position in the level of shift.
+    static const Node* OldTrie(const ContainerNode* old, SizeType shift, SizeType position) {
+        if (!old || !old->root || shift > old->shift)
+            return 0;
+        if (shift == old->shift)
+            return position == 0 ? old->root : 0;
+        const SizeType first = position << (shift + kBits);  // first entry covered, shift + kBits <= old->shift
+        if (first >= old->size)
+            return 0;
+        const Node* n = old->root;
+        for (SizeType s = old->shift; s > shift; s -= kBits) {
+            const SizeType i = (first >> s) & kMask;
+            if (i >= Count(n))
+                return 0;
+            n = Children(n)[i];
+        }
+        return n;
+    }
+
+    //! Build a container over entries, reusing the radix tree nodes of old with identical contents.
+    static const Node* Build(unsigned kind, const Entry* entries, SizeType count, const ContainerNode* old, Allocator& allocator) {
+        if (count == 0)
+            return old && old->size == 0 ? AddRef(old) : NewContainer(kind, 0, 0, 0, 0, allocator);
+
+        SizeType levelCount = (count + kMask) >> kBits;
+        const Node** level = static_cast<const Node**>(allocator.Malloc(levelCount * sizeof(const Node*)));
+        for (SizeType j = 0; j < levelCount; j++) {
+            const Entry* first = entries + (j << kBits);
+            const SizeType n = count - (j << kBits) < kBranch ? count - (j << kBits) : kBranch;
+            const Node* o = OldTrie(old, 0, j);
+            bool same = o && Count(o) == n;
+            for (SizeType k = 0; same && k < n; k++)
+                same = Entries(o)[k].name == first[k].name && Entries(o)[k].value == first[k].value;
+            if (same)
+                level[j] = AddRef(o);
+            else {
+                TrieNode* leaf = NewTrie(kLeafNode, n, allocator);
+                for (SizeType k = 0; k < n; k++)
+                    SetEntry(Entries(leaf)[k], first[k]);
+                level[j] = leaf;
+            }
+        }
+
+        SizeType shift = 0;
+        while (levelCount > 1) {
+            shift += kBits;
+            const SizeType parentCount = (levelCount + kMask) >> kBits;
+            for (SizeType j = 0; j < parentCount; j++) {
+                const Node** first = level + (j << kBits);
+                const SizeType n = levelCount - (j << kBits) < kBranch ? levelCount - (j << kBits) : kBranch;
+                const Node* o = OldTrie(old, shift, j);
+                bool same = o && Count(o) == n;
+                for (SizeType k = 0; same && k < n; k++)
+                    same = Children(o)[k] == first[k];
+                if (same) {
+                    for (SizeType k = 0; k < n; k++)
+                        Release(first[k]);
+                    level[j] = AddRef(o);
+                }
+                else {
+                    TrieNode* branch = NewTrie(kBranchNode, n, allocator);
+                    for (SizeType k = 0; k < n; k++)
+                        Children(branch)[k] = first[k];    // takes the references
+                    level[j] = branch;
+                }
+            }
+            levelCount = parentCount;
+        }
+
+        const Node* root = level[0];
+        Allocator::Free(level);
+        if (old && old->size == count && old->shift == shift && old->root == root) {
+            Release(root);
+            return AddRef(old);
+        }
+        return NewContainer(kind, count, shift, root, kind == kObjectNode ? MakeIndex(entries, count, old, allocator) : 0, allocator);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Member index
+
+    static SizeType PopCount(uint32_t x) {
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        return static_cast<SizeType>((((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+    }
+
+    //! Slot of a hash in a branch at shift. Two different hashes get different slots by shift 30 at the latest.
+    static uint32_t HashBit(uint32_t hash, SizeType shift) { return uint32_t(1) << ((hash >> shift) & kMask); }
+
+    //! Position of the child of a slot among the occupied slots of a branch.
+    static SizeType ChildIndex(uint32_t bits, uint32_t bit) { return PopCount(bits & (bit - 1)); }
+
+    //! Leaf holding the positions of the names with a hash, or null.
+    static const Node* IndexFind(const Node* n, uint32_t hash) {
+        for (SizeType shift = 0; n && n->kind == kHashBranchNode; shift += kBits) {
+            const uint32_t bit = HashBit(hash, shift);
+            n = (AsHash(n)->bits & bit) ? HashChildren(n)[ChildIndex(AsHash(n)->bits, bit)] : 0;
+        }
+        return n && AsHash(n)->bits == hash ? n : 0;
+    }
+
+    //! Copy of a branch with the occupied slots bits, leaving out the child at skip and
+    //! leaving the child at open (kNotFound for neither) for the caller to set.
+    static HashNode* CopyBranch(const Node* n, uint32_t bits, SizeType skip, SizeType open, Allocator& allocator) {
+        HashNode* copy = NewHash(kHashBranchNode, PopCount(bits), bits, allocator);
+        SizeType d = 0;
+        for (SizeType k = 0; k < AsHash(n)->count; k++) {
+            if (d == open)
+                d++;
+            if (k != skip)
+                HashChildren(copy)[d++] = AddRef(HashChildren(n)[k]);
+        }
+        return copy;
+    }
+
+    //! Copy of the member index at shift with pos added to the positions of hash.
+    static const Node* IndexInsert(const Node* n, uint32_t hash, SizeType pos, SizeType shift, Allocator& allocator) {
+        if (!n) {
+            HashNode* leaf = NewHash(kHashLeafNode, 1, hash, allocator);
+            Positions(leaf)[0] = pos;
+            return leaf;
+        }
+        if (n->kind == kHashLeafNode) {
+            const SizeType count = AsHash(n)->count;
+            if (AsHash(n)->bits == hash) {     // keep the positions ascending, the first one wins
+                HashNode* leaf = NewHash(kHashLeafNode, count + 1, hash, allocator);
+                SizeType k = 0;
+                for (; k < count && Positions(n)[k] < pos; k++)
+                    Positions(leaf)[k] = Positions(n)[k];
+                Positions(leaf)[k] = pos;
+                for (; k < count; k++)
+                    Positions(leaf)[k + 1] = Positions(n)[k];
+                return leaf;
+            }
+            HashNode* branch = NewHash(kHashBranchNode, 1, HashBit(AsHash(n)->bits, shift), allocator);
+            HashChildren(branch)[0] = AddRef(n);    // push the leaf down, then insert beside it
+            const Node* result = IndexInsert(branch, hash, pos, shift, allocator);
+            Release(branch);
+            return result;
+        }
+        const uint32_t bit = HashBit(hash, shift);
+        const uint32_t bits = AsHash(n)->bits;
+        const SizeType i = ChildIndex(bits, bit);
+        HashNode* copy = CopyBranch(n, bits | bit, (bits & bit) ? i : kNotFound, i, allocator);
+        HashChildren(copy)[i] = IndexInsert((bits & bit) ? HashChildren(n)[i] : 0, hash, pos, shift + kBits, allocator);
+        return copy;
+    }
+
+    //! Copy of the member index at shift without pos among the positions of hash, null if nothing is left.
+    static const Node* IndexRemove(const Node* n, uint32_t hash, SizeType pos, SizeType shift, Allocator& allocator) {
+        RAPIDJSON_ASSERT(n);
+        if (n->kind == kHashLeafNode) {
+            RAPIDJSON_ASSERT(AsHash(n)->bits == hash);
+            const SizeType count = AsHash(n)->count;
+            if (count == 1)
+                return 0;
+            HashNode* leaf = NewHash(kHashLeafNode, count - 1, hash, allocator);
+            for (SizeType k = 0, d = 0; k < count; k++)
+                if (Positions(n)[k] != pos)
+                    Positions(leaf)[d++] = Positions(n)[k];
+            return leaf;
+        }
+        const uint32_t bit = HashBit(hash, shift);
+        const uint32_t bits = AsHash(n)->bits;
+        RAPIDJSON_ASSERT(bits & bit);
+        const SizeType i = ChildIndex(bits, bit);
+        const Node* child = IndexRemove(HashChildren(n)[i], hash, pos, shift + kBits, allocator);
+        if (child) {
+            HashNode* copy = CopyBranch(n, bits, i, i, allocator);
+            HashChildren(copy)[i] = child;
+            return copy;
+        }
+        return bits == bit ? 0 : CopyBranch(n, bits & ~bit, i, kNotFound, allocator);
+    }
+
+    //! Member index over entries sorted by position, distributed through scratch of the same size.
+    static const Node* BuildIndex(IndexEntry* entries, IndexEntry* scratch, SizeType count, SizeType shift, Allocator& allocator) {
+        bool single = true;
+        for (SizeType k = 1; single && k < count; k++)
+            single = entries[k].hash == entries[0].hash;
+        if (single) {
+            HashNode* leaf = NewHash(kHashLeafNode, count, entries[0].hash, allocator);
+            for (SizeType k = 0; k < count; k++)
+                Positions(leaf)[k] = entries[k].pos;
+            return leaf;
+        }
+
+        SizeType start[kBranch + 1] = {};
+        for (SizeType k = 0; k < count; k++)
+            start[((entries[k].hash >> shift) & kMask) + 1]++;
+        uint32_t bits = 0;
+        for (SizeType slot = 0; slot < kBranch; slot++) {
+            if (start[slot + 1])
+                bits |= uint32_t(1) << slot;
+            start[slot + 1] += start[slot];
+        }
+        SizeType next[kBranch];
+        std::memcpy(next, start, sizeof(next));
+        for (SizeType k = 0; k < count; k++)    // stable, so that the positions stay ascending
+            scratch[next[(entries[k].hash >> shift) & kMask]++] = entries[k];
+
+        HashNode* branch = NewHash(kHashBranchNode, PopCount(bits), bits, allocator);
+        for (SizeType slot = 0, d = 0; slot < kBranch; slot++)
+            if (start[slot + 1] != start[slot])
+                HashChildren(branch)[d++] = BuildIndex(scratch + start[slot], entries + start[slot], start[slot + 1] - start[slot], shift + kBits, allocator);
+        return branch;
+    }
+
+    //! Member index of an object over entries, the one of old if every name kept its position.
+    static const Node* MakeIndex(const Entry* entries, SizeType count, const ContainerNode* old, Allocator& allocator) {
+        if (old && old->size == count) {
+            SizeType k = 0;
+            while (k < count && EntryAt(old, k).name == entries[k].name)
+                k++;
+            if (k == count)
+                return AddRef(old->index);
+        }
+        IndexEntry* buffer = static_cast<IndexEntry*>(allocator.Malloc(2 * count * sizeof(IndexEntry)));
+        for (SizeType k = 0; k < count; k++) {
+            buffer[k].hash = static_cast<uint32_t>(entries[k].hash);
+            buffer[k].pos = k;
+        }
+        const Node* result = BuildIndex(buffer, buffer + count, count, 0, allocator);
+        Allocator::Free(buffer);
+        return result;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Versions
+
+    template <typename Token>
+    static const Node* SetPath(const Node* n, const Token* t, SizeType tokenCount, const Node* value, Allocator& allocator) {
+        if (tokenCount == 0)
+            return AddRef(value);
+
+        // Same rules as GenericPointer::Create(): "-" appends to an array, an index
+        // addresses an array unless the value is an object, anything else is a member name.
+        const bool isArray = n && n->kind == kArrayNode;
+        const bool append = isArray && t->length == 1 && t->name[0] == '-';
+        if (!append && (t->index == kPointerInvalidIndex || (n && n->kind == kObjectNode))) {
+            const ContainerNode* c = n && n->kind == kObjectNode ? static_cast<const ContainerNode*>(n) : 0;
+            const SizeType hash = internal::HashString(t->name, t->length);
+            const SizeType index = c ? Find(c, t->name, t->length, hash) : kNotFound;
+            if (index != kNotFound) {
+                const Entry& old = EntryAt(c, index);
+                Entry e = { old.name, SetPath(old.value, t + 1, tokenCount - 1, value, allocator), hash };
+                const Node* result = e.value == old.value ? AddRef(c) : Replace(c, index, e, AddRef(c->index), allocator);
+                Release(e.value);
+                return result;
+            }
+            Entry e = { NewString(t->name, t->length, allocator), SetPath(0, t + 1, tokenCount - 1, value, allocator), hash };
+            const Node* names = IndexInsert(c ? c->index : 0, static_cast<uint32_t>(hash), c ? c->size : 0, 0, allocator);
+            const Node* result = Push(kObjectNode, c, e, names, allocator);
+            Release(e.name);
+            Release(e.value);
+            return result;
+        }
+
+        const ContainerNode* c = isArray ? static_cast<const ContainerNode*>(n) : 0;
+        const SizeType size = c ? c->size : 0;
+        const SizeType index = append ? size : t->index;
+        if (index < size) {
+            const Entry& old = EntryAt(c, index);
+            Entry e = { 0, SetPath(old.value, t + 1, tokenCount - 1, value, allocator), 0 };
+            const Node* result = e.value == old.value ? AddRef(c) : Replace(c, index, e, 0, allocator);
+            Release(e.value);
+            return result;
+        }
+
+        const Node* array = AddRef(c);
+        const Entry null = { 0, 0, 0 };
+        for (SizeType i = size; i < index; i++) {   // pad with null like GenericPointer::Create()
+            const Node* next = Push(kArrayNode, static_cast<const ContainerNode*>(array), null, 0, allocator);
+            Release(array);
+            array = next;
+        }
+        Entry e = { 0, SetPath(0, t + 1, tokenCount - 1, value, allocator), 0 };
+        const Node* result = Push(kArrayNode, static_cast<const ContainerNode*>(array), e, 0, allocator);
+        Release(array);
+        Release(e.value);
+        return result;
+    }
+
+    template <typename Token>
+    static const Node* RemovePath(const Node* n, const Token* t, SizeType tokenCount, Allocator& allocator) {
+        if (!n || (n->kind != kObjectNode && n->kind != kArrayNode))
+            return AddRef(n);
+        const ContainerNode* c = static_cast<const ContainerNode*>(n);
+
+        SizeType index = kNotFound;
+        if (n->kind == kObjectNode)
+            index = Find(c, t->name, t->length, internal::HashString(t->name, t->length));
+        else if (t->index < c->size)
+            index = t->index;
+        if (index == kNotFound)
+            return AddRef(n);
+
+        const Entry& old = EntryAt(c, index);
+        if (tokenCount > 1) {
+            Entry e = { old.name, RemovePath(old.value, t + 1, tokenCount - 1, allocator), old.hash };
+            const Node* result = e.value == old.value ? AddRef(c) : Replace(c, index, e, AddRef(c->index), allocator);
+            Release(e.value);
+            return result;
+        }
+
+        if (n->kind == kObjectNode) {   // move the last member into the hole, like GenericValue::RemoveMember()
+            const Node* names = IndexRemove(c->index, static_cast<uint32_t>(old.hash), index, 0, allocator);
+            if (index + 1 == c->size)
+                return Pop(c, names, allocator);
+            const Entry& last = EntryAt(c, c->size - 1);
+            const Node* without = IndexRemove(names, static_cast<uint32_t>(last.hash), c->size - 1, 0, allocator);
+            Release(names);
+            names = IndexInsert(without, static_cast<uint32_t>(last.hash), index, 0, allocator);
+            Release(without);
+            const Node* moved = Replace(c, index, last, 0, allocator);
+            const Node* result = Pop(static_cast<const ContainerNode*>(moved), names, allocator);
+            Release(moved);
+            return result;
+        }
+
+        // Erase the element, keeping the order; nodes before it are reused
+        Entry* entries = static_cast<Entry*>(allocator.Malloc((c->size - 1) * sizeof(Entry) + 1));
+        for (SizeType i = 0, k = 0; i < c->size; i++)
+            if (i != index)
+                entries[k++] = EntryAt(c, i);
+        const Node* result = Build(kArrayNode, entries, c->size - 1, c, allocator);
+        Allocator::Free(entries);
+        return result;
+    }
+
+    static bool SameScalar(const ScalarType& a, const ScalarType& b) {
+        if (a.GetType() != b.GetType())
+            return false;
+        if (a.IsString())
+            return a.GetStringLength() == b.GetStringLength() && std::memcmp(a.GetString(), b.GetString(), a.GetStringLength() * sizeof(Ch)) == 0;
+        if (a.IsNumber()) {
+            if (a.IsDouble() != b.IsDouble())
+                return false;
+            if (a.IsDouble()) {     // bitwise, so that -0.0 and 0.0 stay distinct
+                const double x = a.GetDouble(), y = b.GetDouble();
+                return std::memcmp(&x, &y, sizeof(double)) == 0;
+            }
+            return a.IsUint64() ? (b.IsUint64() && a.GetUint64() == b.GetUint64()) : (!b.IsUint64() && a.GetInt64() == b.GetInt64());
+        }
+        return true;
+    }
+
+    template <typename SourceAllocator>
+    static const Node* Graft(const Node* old, const GenericValue<Encoding, SourceAllocator>& value, Allocator& allocator) {
+        switch (value.GetType()) {
+        case kNullType:
+            return 0;
+
+        case kObjectType: {
+            const ContainerNode* o = old && old->kind == kObjectNode ? static_cast<const ContainerNode*>(old) : 0;
+            const SizeType count = value.MemberCount();
+            Entry* entries = static_cast<Entry*>(allocator.Malloc(count * sizeof(Entry) + 1));
+            SizeType k = 0, offset = 0;
+            for (typename GenericValue<Encoding, SourceAllocator>::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m, ++k) {
+                const Ch* name = m->name.GetString();
+                const SizeType length = m->name.GetStringLength();
+                const SizeType hash = internal::HashString(name, length);
+                SizeType index = kNotFound;
+                if (o) {    // expect the previous order, shifted by insertions and removals seen so far
+                    const SizeType guess = k + offset;
+                    if (guess < o->size && EntryAt(o, guess).hash == hash && NameEquals(EntryAt(o, guess).name, name, length))
+                        index = guess;
+                    else if ((index = Find(o, name, length, hash)) != kNotFound)
+                        offset = index - k;
+                }
+                if (index != kNotFound) {
+                    const Entry& prev = EntryAt(o, index);
+                    entries[k].name = AddRef(prev.name);
+                    entries[k].value = Graft(prev.value, m->value, allocator);
+                }
+                else {
+                    entries[k].name = NewString(name, length, allocator);
+                    entries[k].value = Graft(0, m->value, allocator);
+                }
+                entries[k].hash = hash;
+            }
+            const Node* result = Build(kObjectNode, entries, count, o, allocator);
+            for (k = 0; k < count; k++) {
+                Release(entries[k].name);
+                Release(entries[k].value);
+            }
+            Allocator::Free(entries);
+            return result;
+        }
+
+        case kArrayType: {
+            const ContainerNode* o = old && old->kind == kArrayNode ? static_cast<const ContainerNode*>(old) : 0;
+            const SizeType count = value.Size();
+            Entry* entries = static_cast<Entry*>(allocator.Malloc(count * sizeof(Entry) + 1));
+            for (SizeType k = 0; k < count; k++) {
+                entries[k].name = 0;
+                entries[k].value = Graft(o && k < o->size ? EntryAt(o, k).value : 0, value[k], allocator);
+                entries[k].hash = 0;
+            }
+            const Node* result = Build(kArrayNode, entries, count, o, allocator);
+            for (SizeType k = 0; k < count; k++)
+                Release(entries[k].value);
+            Allocator::Free(entries);
+            return result;
+        }
+
+        default:
+            if (old && old->kind == kScalarNode) {
+                ScalarType probe;   // compares without copying strings
+                if (value.IsString())
+                    probe.SetString(StringRef(value.GetString(), value.GetStringLength()));
+                else
+                    probe.CopyFrom(value, allocator);
+                if (SameScalar(static_cast<const ScalarNode*>(old)->value, probe))
+                    return AddRef(old);
+            }
+            return NewScalar(value, allocator);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Traversal
+
+    template <typename Handler>
+    static bool AcceptTrie(const Node* t, bool object, Handler& handler) {
+        for (SizeType i = 0; i < Count(t); i++)
+            if (t->kind == kLeafNode) {
+                const Entry& e = Entries(t)[i];
+                if (object) {
+                    const ScalarType& name = static_cast<const ScalarNode*>(e.name)->value;
+                    if (RAPIDJSON_UNLIKELY(!handler.Key(name.GetString(), name.GetStringLength(), true)))
+                        return false;
+                }
+                if (RAPIDJSON_UNLIKELY(!Accept(e.value, handler)))
+                    return false;
+            }
+            else if (RAPIDJSON_UNLIKELY(!AcceptTrie(Children(t)[i], object, handler)))
+                return false;
+        return true;
+    }
+
+    template <typename Handler>
+    static bool Accept(const Node* n, Handler& handler) {
+        if (!n)
+            return handler.Null();
+        if (n->kind == kScalarNode)
+            return static_cast<const ScalarNode*>(n)->value.Accept(handler);
+
+        const ContainerNode* c = static_cast<const ContainerNode*>(n);
+        const bool object = n->kind == kObjectNode;
+        if (RAPIDJSON_UNLIKELY(!(object ? handler.StartObject() : handler.StartArray())))
+            return false;
+        if (c->root && RAPIDJSON_UNLIKELY(!AcceptTrie(c->root, object, handler)))
+            return false;
+        return object ? handler.EndObject(c->size) : handler.EndArray(c->size);
+    }
+
+    static bool Equal(const Node* a, const Node* b) {
+        if (a == b)
+            return true;
+        if (!a || !b || a->kind != b->kind)
+            return false;
+        if (a->kind == kScalarNode)
+            return static_cast<const ScalarNode*>(a)->value == static_cast<const ScalarNode*>(b)->value;
+
+        const ContainerNode* ca = static_cast<const ContainerNode*>(a);
+        const ContainerNode* cb = static_cast<const ContainerNode*>(b);
+        if (ca->size != cb->size)
+            return false;
+        if (ca->root == cb->root)
+            return true;
+        for (SizeType i = 0; i < ca->size; i++) {
+            const Entry& e = EntryAt(ca, i);
+            if (a->kind == kObjectNode) {
+                const ScalarType& name = static_cast<const ScalarNode*>(e.name)->value;
+                const SizeType j = i < cb->size && EntryAt(cb, i).name == e.name ? i : Find(cb, name.GetString(), name.GetStringLength(), e.hash);
+                if (j == kNotFound || !Equal(e.value, EntryAt(cb, j).value))
+                    return false;
+            }
+            else if (!Equal(e.value, EntryAt(cb, i).value))
+                return false;
+        }
+        return true;
+    }
+
+    const Node* node_;
+};
+
+//! GenericPersistentValue with UTF8 encoding
+typedef GenericPersistentValue<UTF8<> > PersistentValue;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PERSISTENTVALUE_H_
@@ -1048,6 +1048,182 @@ private:
 //! GenericPointer for Value (UTF-8, default allocator).
 typedef GenericPointer<Value> Pointer;
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericBoundPointer
+
+//! A JSON pointer which remembers where it resolved in the last document.
+/*!
+    GenericPointer::Get() looks up every object token by name. For paths
+    resolved over and over in documents of the same shape (e.g. "/engines/0/rpm"
+    in a document rebuilt every frame), GenericBoundPointer caches the index of
+    the member found at each level. A later Get() checks the cached member first
+    with a single name comparison and only falls back to a lookup by name when
+    the member moved, i.e. when the shape of the document changed.
+
+    The cache holds indices only, so it stays valid when the document is
+    modified, reallocated or replaced by another one: a stale index is detected
+    and resolved again.
+
+    \note Objects with duplicate member names are not supported. A lookup by
+    name resolves the first member of that name, as GenericPointer::Get() does,
+    but a cached index which lands on a later member of the same name is taken
+    as is. Verifying that no earlier member matches would cost the scan the
+    cache exists to avoid. Use GenericPointer for documents which may contain
+    duplicate names.
+
+\code
+    Document d;
+    BoundPointer rpm(Pointer("/engines/0/rpm"));
+    for (;;) {
+        d.Parse(json);
+        if (Value* v = rpm.Get(d))
+            Use(v->GetDouble());
+    }
+\endcode
+
+    \tparam ValueType The value type of the DOM tree. E.g. GenericValue<UTF8<> >
+    \tparam Allocator The allocator type for the pointer and the cache.
+*/
+template <typename ValueType, typename Allocator = CrtAllocator>
+class GenericBoundPointer {
+public:
+    typedef GenericPointer<ValueType, Allocator> PointerType;   //!< Type of the bound pointer
+    typedef typename PointerType::Token Token;                  //!< Token type of the bound pointer
+    typedef typename ValueType::Ch Ch;                          //!< Character type from Value
+
+    //! Constructor.
+    /*!
+        \param pointer A valid pointer, which is copied.
+        \param allocator User supplied allocator for the copy of the pointer and the cache. If no allocator is provided, it creates a self-owned one.
+    */
+    explicit GenericBoundPointer(const PointerType& pointer, Allocator* allocator = 0) : pointer_(pointer, allocator), allocator_(allocator), ownAllocator_(), memberIndices_(), missCount_() {
+        Bind();
+    }
+
+    //! Copy constructor, copies the cache too.
+    GenericBoundPointer(const GenericBoundPointer& rhs, Allocator* allocator = 0) : pointer_(rhs.pointer_, allocator), allocator_(allocator), ownAllocator_(), memberIndices_(), missCount_() {
+        Bind();
+        if (memberIndices_)
+            std::memcpy(memberIndices_, rhs.memberIndices_, pointer_.GetTokenCount() * sizeof(SizeType));
+    }
+
+    //! Destructor.
+    ~GenericBoundPointer() {
+        Allocator::Free(memberIndices_);
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Assignment operator, copies the pointer and its cache.
+    GenericBoundPointer& operator=(const GenericBoundPointer& rhs) {
+        if (this != &rhs) {
+            Allocator::Free(memberIndices_);
+            memberIndices_ = 0;
+            pointer_ = rhs.pointer_;
+            Bind();
+            if (memberIndices_)
+                std::memcpy(memberIndices_, rhs.memberIndices_, pointer_.GetTokenCount() * sizeof(SizeType));
+            missCount_ = rhs.missCount_;
+        }
+        return *this;
+    }
+
+    //! Gets the bound pointer.
+    const PointerType& GetPointer() const { return pointer_; }
+
+    //! Number of cached member indices which had to be resolved by name since construction.
+    size_t GetMissCount() const { return missCount_; }
+
+    //! Forgets the cached member indices.
+    void Invalidate() {
+        for (size_t i = 0; i < pointer_.GetTokenCount(); i++)
+            memberIndices_[i] = kPointerInvalidIndex;
+    }
+
+    //! Query a value in a subtree, using and updating the cached member indices.
+    /*!
+        Resolves the same value as GenericPointer::Get(), unless an object on the path has duplicate member names.
+        \param root Root value of a DOM sub-tree to be resolved. It can be any value other than document root.
+        \param unresolvedTokenIndex If the pointer cannot resolve a token in the pointer, this parameter can obtain the index of unresolved token.
+        \return Pointer to the value if it can be resolved. Otherwise null.
+        \see GenericPointer::Get()
+    */
+    ValueType* Get(ValueType& root, size_t* unresolvedTokenIndex = 0) {
+        RAPIDJSON_ASSERT(pointer_.IsValid());
+        ValueType* v = &root;
+        const Token* tokens = pointer_.GetTokens();
+        for (size_t i = 0; i < pointer_.GetTokenCount(); i++) {
+            const Token& t = tokens[i];
+            switch (v->GetType()) {
+            case kObjectType:
+                {
+                    const SizeType index = memberIndices_[i];
+                    if (RAPIDJSON_LIKELY(index < v->MemberCount())) {
+                        typename ValueType::Member& m = v->MemberBegin()[index];
+                        if (RAPIDJSON_LIKELY(NameEqual(m.name, t))) {
+                            v = &m.value;
+                            continue;
+                        }
+                    }
+
+                    missCount_++;
+                    typename ValueType::MemberIterator m = v->FindMember(GenericStringRef<Ch>(t.name, t.length));
+                    if (m == v->MemberEnd())
+                        break;
+                    memberIndices_[i] = static_cast<SizeType>(m - v->MemberBegin());
+                    v = &m->value;
+                }
+                continue;
+            case kArrayType:
+                if (t.index == kPointerInvalidIndex || t.index >= v->Size())
+                    break;
+                v = &((*v)[t.index]);
+                continue;
+            default:
+                break;
+            }
+
+            // Error: unresolved token
+            if (unresolvedTokenIndex)
+                *unresolvedTokenIndex = i;
+            return 0;
+        }
+        return v;
+    }
+
+    //! Query a const value in a const subtree, using and updating the cached member indices.
+    const ValueType* Get(const ValueType& root, size_t* unresolvedTokenIndex = 0) {
+        return Get(const_cast<ValueType&>(root), unresolvedTokenIndex);
+    }
+
+private:
+    void Bind() {
+        const size_t count = pointer_.GetTokenCount();
+        if (count == 0)
+            return;
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+        memberIndices_ = static_cast<SizeType*>(allocator_->Malloc(count * sizeof(SizeType)));
+        Invalidate();
+    }
+
+    static bool NameEqual(const ValueType& name, const Token& t) {
+        const SizeType length = name.GetStringLength();
+        if (length != t.length)
+            return false;
+        const Ch* s = name.GetString();
+        return s == t.name || std::memcmp(s, t.name, length * sizeof(Ch)) == 0;
+    }
+
+    PointerType pointer_;       //!< Copy of the bound pointer.
+    Allocator* allocator_;      //!< The current allocator. It is either user-supplied or equal to ownAllocator_.
+    Allocator* ownAllocator_;   //!< Allocator owned by this bound pointer.
+    SizeType* memberIndices_;   //!< Cached member index for each token, kPointerInvalidIndex if unknown.
+    size_t missCount_;          //!< Number of cache misses.
+};
+
+//! GenericBoundPointer for Value (UTF-8, default allocator).
+typedef GenericBoundPointer<Value> BoundPointer;
+
 //!@name Helper functions for GenericPointer
 //@{
 
@@ -1087,6 +1263,16 @@ const typename T::ValueType* GetValueByPointer(const T& root, const GenericPoint
     return pointer.Get(root, unresolvedTokenIndex);
 }
 
+template <typename T>
+typename T::ValueType* GetValueByPointer(T& root, GenericBoundPointer<typename T::ValueType>& pointer, size_t* unresolvedTokenIndex = 0) {
+    return pointer.Get(root, unresolvedTokenIndex);
+}
+
+template <typename T>
+const typename T::ValueType* GetValueByPointer(const T& root, GenericBoundPointer<typename T::ValueType>& pointer, size_t* unresolvedTokenIndex = 0) {
+    return pointer.Get(root, unresolvedTokenIndex);
+}
+
 template <typename T, typename CharType, size_t N>
 typename T::ValueType* GetValueByPointer(T& root, const CharType (&source)[N], size_t* unresolvedTokenIndex = 0) {
     return GenericPointer<typename T::ValueType>(source, N - 1).Get(root, unresolvedTokenIndex);
@@ -89,6 +89,7 @@ public:
     bool Int64(int64_t i64)     { PrettyPrefix(kNumberType); return Base::WriteInt64(i64); }
     bool Uint64(uint64_t u64)   { PrettyPrefix(kNumberType); return Base::WriteUint64(u64);  }
     bool Double(double d)       { PrettyPrefix(kNumberType); return Base::WriteDouble(d); }
+    bool Float(float f)         { PrettyPrefix(kNumberType); return Base::WriteFloat(f); }
 
     bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
         (void)copy;
@@ -0,0 +1,409 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PUSHREADER_H_
+#define RAPIDJSON_PUSHREADER_H_
+
+/*! \file pushreader.h */
+
+#include "reader.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericPushReader
+
+//! SAX-style JSON parser fed with fragments of the input.
+/*! GenericPushReader parses a JSON text which arrives in arbitrary pieces, e.g.
+    the chunks delivered by an asynchronous HTTP request or a message bus callback,
+    without reassembling the whole text first. Each call to Feed() parses as many
+    tokens as the fragment completes and emits the corresponding handler events;
+    a token cut by the end of the fragment is suspended and resumed by the next
+    call. Finish() marks the end of the input.
+
+    Tokens lying entirely inside one fragment are parsed straight from the caller's
+    buffer, only the token crossing a fragment boundary is copied into an internal
+    buffer. The fragment therefore does not need to outlive the Feed() call.
+
+    Parsing is driven by GenericReader::IterativeParseNext(), so the same events,
+    errors and flags as GenericReader::Parse() apply, except \ref kParseInsituFlag
+    which is not supported. Error offsets are counted from the start of the whole
+    input, not of the current fragment.
+
+\code
+    PushReader reader;
+    MyHandler handler;
+    while (const char* chunk = NextChunk(&length))
+        if (!reader.Feed(chunk, length, handler))
+            break;
+    if (!reader.HasParseError())
+        reader.Finish(handler);
+\endcode
+
+    \tparam SourceEncoding Encoding of the input stream.
+    \tparam TargetEncoding Encoding of the parse output.
+    \tparam StackAllocator Allocator type for the reader's stack and the fragment buffer.
+    \note The parse flags given to Feed() and Finish() must be identical for one JSON text.
+*/
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator = CrtAllocator>
+class GenericPushReader {
+public:
+    typedef typename SourceEncoding::Ch Ch; //!< SourceEncoding character type
+    typedef GenericReader<SourceEncoding, TargetEncoding, StackAllocator> ReaderType; //!< Underlying reader type
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
+        \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
+    */
+    GenericPushReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        reader_(stackAllocator, stackCapacity), pending_(stackAllocator, stackCapacity), pendingOffset_(), offset_(), scan_(kScanNone)
+    {
+        reader_.IterativeParseInit();
+    }
+
+    //! Discard any partial input and start parsing a new JSON text.
+    /*! The reader's buffers are kept for the next text. */
+    void Reset() {
+        reader_.IterativeParseInit();
+        pending_.Clear();
+        pendingOffset_ = 0;
+        offset_ = 0;
+        scan_ = kScanNone;
+    }
+
+    //! Parse the next fragment of the JSON text.
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param data Fragment of the input, need not be null-terminated.
+        \param length Number of characters in \c data.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful so far.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool Feed(const Ch* data, size_t length, Handler& handler) {
+        RAPIDJSON_STATIC_ASSERT(!(parseFlags & kParseInsituFlag));
+
+        if (RAPIDJSON_UNLIKELY(reader_.HasParseError()))
+            return false;
+
+        const Ch* p = data;
+        const Ch* end = data + length;
+
+        // Resume the token suspended by the previous fragment.
+        if (scan_ != kScanNone) {
+            const Ch* q = ScanToken<parseFlags>(p, end);
+            Append(p, q ? q : end);
+            if (!q) {
+                offset_ += length;
+                return true;
+            }
+            p = q;
+            if (!ParsePending<parseFlags>(true, handler)) {
+                offset_ += length;
+                return false;
+            }
+        }
+
+        while (p != end) {
+            if ((parseFlags & kParseStopWhenDoneFlag) && reader_.IterativeParseComplete())
+                break;
+
+            Ch c = *p;
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                ++p;
+                continue;
+            }
+
+            scan_ = BeginToken<parseFlags>(c);
+            const Ch* q = ScanToken<parseFlags>(p + 1, end);
+            if (!q) {
+                // Suspend the token until the next fragment.
+                pendingOffset_ = offset_ + static_cast<size_t>(p - data);
+                Append(p, end);
+                break;
+            }
+            scan_ = kScanNone;
+
+            // Comments are skipped here, only a stray '/' is left to the reader for reporting.
+            if ((parseFlags & kParseCommentsFlag) && c == '/' && q - p > 1) {
+                p = q;
+                continue;
+            }
+
+            if (!ParseToken<parseFlags>(p, q, offset_ + static_cast<size_t>(p - data), handler)) {
+                offset_ += length;
+                return false;
+            }
+            p = q;
+        }
+
+        offset_ += length;
+        return true;
+    }
+
+    //! Parse the next fragment of the JSON text (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    bool Feed(const Ch* data, size_t length, Handler& handler) {
+        return Feed<kParseDefaultFlags>(data, length, handler);
+    }
+
+    //! Mark the end of the JSON text.
+    /*! Completes a suspended number or literal and checks that a complete root value has been parsed.
+        \tparam parseFlags Combination of \ref ParseFlag, identical to the one given to Feed().
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param handler The handler to receive events.
+        \return Whether the JSON text has been parsed successfully.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool Finish(Handler& handler) {
+        if (RAPIDJSON_UNLIKELY(reader_.HasParseError()))
+            return false;
+
+        if ((parseFlags & kParseStopWhenDoneFlag) && reader_.IterativeParseComplete())
+            return true;
+
+        if (scan_ != kScanNone) {
+            // A line comment may be closed by the end of the input. Unterminated strings
+            // and block comments are handed to the reader, which reports them.
+            bool skip = scan_ == kScanLineComment;
+            scan_ = kScanNone;
+            if (skip)
+                pending_.Clear();
+            else if (!ParsePending<parseFlags>(false, handler))
+                return false;
+        }
+
+        TokenStream is(0, 0, offset_);
+        return reader_.template IterativeParseNext<parseFlags>(is, handler);
+    }
+
+    //! Mark the end of the JSON text (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    bool Finish(Handler& handler) {
+        return Finish<kParseDefaultFlags>(handler);
+    }
+
+    //! Whether a complete root value has been parsed, or parsing has failed.
+    bool IsComplete() const { return reader_.IterativeParseComplete(); }
+
+    //! Whether a parse error has occured.
+    bool HasParseError() const { return reader_.HasParseError(); }
+
+    //! Get the \ref ParseErrorCode of the parse error.
+    ParseErrorCode GetParseErrorCode() const { return reader_.GetParseErrorCode(); }
+
+    //! Get the position of the parse error in the whole input, 0 otherwise.
+    size_t GetErrorOffset() const { return reader_.GetErrorOffset(); }
+
+    //! Number of characters fed so far.
+    size_t Tell() const { return offset_; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericPushReader(const GenericPushReader&);
+    GenericPushReader& operator=(const GenericPushReader&);
+
+    //! Kind of the token being scanned.
+    enum ScanState {
+        kScanNone,              //!< No token in progress.
+        kScanSingle,            //!< Single character token.
+        kScanString,
+        kScanStringEscape,      //!< Inside a string, after a backslash.
+        kScanNumber,
+        kScanLiteral,           //!< true, false or null.
+        kScanComment,           //!< After '/', with kParseCommentsFlag.
+        kScanLineComment,
+        kScanBlockComment,
+        kScanBlockCommentStar   //!< Inside a block comment, after '*'.
+    };
+
+    //! Bounded stream over one token, reporting offsets within the whole input.
+    struct TokenStream {
+        typedef typename SourceEncoding::Ch Ch;
+
+        TokenStream(const Ch* begin, const Ch* end, size_t offset) : src_(begin), begin_(begin), end_(end), offset_(offset) {}
+
+        Ch Peek() const { return RAPIDJSON_UNLIKELY(src_ == end_) ? Ch('\0') : *src_; }
+        Ch Take() { return RAPIDJSON_UNLIKELY(src_ == end_) ? Ch('\0') : *src_++; }
+        size_t Tell() const { return offset_ + static_cast<size_t>(src_ - begin_); }
+
+        Ch* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+        void Put(Ch) { RAPIDJSON_ASSERT(false); }
+        void Flush() { RAPIDJSON_ASSERT(false); }
+        size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+        const Ch* src_;     //!< Current read position.
+        const Ch* begin_;   //!< Start of the token.
+        const Ch* end_;     //!< End of the token.
+        size_t offset_;     //!< Offset of the token in the whole input.
+    };
+
+    static bool IsDigit(Ch c) { return c >= '0' && c <= '9'; }
+    static bool IsAlpha(Ch c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    template <unsigned parseFlags>
+    static ScanState BeginToken(Ch c) {
+        if (c == '"')
+            return kScanString;
+        if (c == '-' || IsDigit(c))
+            return kScanNumber;
+        if ((parseFlags & kParseNanAndInfFlag) && (c == 'N' || c == 'I'))
+            return kScanNumber;
+        if (c == 't' || c == 'f' || c == 'n')
+            return kScanLiteral;
+        if ((parseFlags & kParseCommentsFlag) && c == '/')
+            return kScanComment;
+        return kScanSingle;
+    }
+
+    //! Continue scanning the current token.
+    /*! \return Past the end of the token, or 0 if the token is not complete within [p, end).
+        Numbers and literals are terminated by the first character not belonging to them,
+        so they are never complete at the end of a fragment.
+    */
+    template <unsigned parseFlags>
+    const Ch* ScanToken(const Ch* p, const Ch* end) {
+        for (; p != end; ++p) {
+            Ch c = *p;
+            switch (scan_) {
+            case kScanSingle:
+                return p;
+
+            case kScanString:
+                if (c == '"')
+                    return p + 1;
+                if (c == '\\')
+                    scan_ = kScanStringEscape;
+                break;
+
+            case kScanStringEscape:
+                scan_ = kScanString;
+                break;
+
+            case kScanNumber:
+                if (!(IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' ||
+                      ((parseFlags & kParseNanAndInfFlag) && IsAlpha(c))))
+                    return p;
+                break;
+
+            case kScanLiteral:
+                if (!IsAlpha(c))
+                    return p;
+                break;
+
+            case kScanComment:
+                if (c == '*')
+                    scan_ = kScanBlockComment;
+                else if (c == '/')
+                    scan_ = kScanLineComment;
+                else
+                    return p;
+                break;
+
+            case kScanLineComment:
+                if (c == '\n')
+                    return p + 1;
+                break;
+
+            case kScanBlockComment:
+                if (c == '*')
+                    scan_ = kScanBlockCommentStar;
+                break;
+
+            case kScanBlockCommentStar:
+                if (c == '/')
+                    return p + 1;
+                if (c != '*')
+                    scan_ = kScanBlockComment;
+                break;
+
+            default:
+                RAPIDJSON_ASSERT(false);
+                return p;
+            }
+        }
+        return scan_ == kScanSingle ? p : 0;
+    }
+
+    void Append(const Ch* begin, const Ch* end) {
+        size_t count = static_cast<size_t>(end - begin);
+        if (count != 0)
+            std::memcpy(pending_.template Push<Ch>(count), begin, count * sizeof(Ch));
+    }
+
+    //! Parse a complete token (occasionally followed by characters it does not consume).
+    template <unsigned parseFlags, typename Handler>
+    bool ParseToken(const Ch* begin, const Ch* end, size_t offset, Handler& handler) {
+        TokenStream is(begin, end, offset);
+        while (is.src_ != end) {
+            if ((parseFlags & kParseStopWhenDoneFlag) && reader_.IterativeParseComplete())
+                break;
+            const Ch* last = is.src_;
+            if (!reader_.template IterativeParseNext<parseFlags>(is, handler))
+                return false;
+            if (is.src_ == last)
+                break; // a '\0' after the root value ends the text, as in GenericReader::Parse()
+        }
+        return true;
+    }
+
+    //! Parse the token accumulated across fragments.
+    /*! \param complete Whether the token has been terminated, i.e. not cut by the end of the input.
+    */
+    template <unsigned parseFlags, typename Handler>
+    bool ParsePending(bool complete, Handler& handler) {
+        scan_ = kScanNone;
+
+        const Ch* begin = pending_.template Bottom<Ch>();
+        const Ch* end = pending_.template End<Ch>();
+        RAPIDJSON_ASSERT(begin != end);
+        bool comment = (parseFlags & kParseCommentsFlag) && *begin == '/' && end - begin > 1;
+        bool ok = (complete && comment) || ParseToken<parseFlags>(begin, end, pendingOffset_, handler);
+        pending_.Clear();
+        return ok;
+    }
+
+    static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes.
+    ReaderType reader_;                         //!< Reader holding the parse state between fragments.
+    internal::Stack<StackAllocator> pending_;   //!< Characters of the token crossing fragment boundaries.
+    size_t pendingOffset_;                      //!< Offset of the pending token in the whole input.
+    size_t offset_;                             //!< Characters fed before the current fragment.
+    ScanState scan_;                            //!< Kind of the pending token, kScanNone if none.
+};
+
+//! Push reader with UTF8 encoding and default allocator.
+typedef GenericPushReader<UTF8<>, UTF8<> > PushReader;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PUSHREADER_H_
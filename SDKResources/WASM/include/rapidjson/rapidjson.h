@@ -320,31 +320,66 @@
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_SIMD
+// RAPIDJSON_MEMBER_INDEX_THRESHOLD
+
+//! Member count from which objects keep a hashed member index.
+/*!
+    \ingroup RAPIDJSON_CONFIG
+
+    Objects whose member capacity reaches this threshold reserve a hash table
+    right after their member array. It turns member lookup into a constant time
+    operation on large objects. Smaller objects keep the plain member array and
+    linear lookup.
+
+    The index is built lazily by lookups through non-const values, or explicitly
+    by \c GenericValue::BuildMemberIndex(). Lookups through const values never
+    modify the object, so they only use an index which is already built. Call
+    \c BuildMemberIndex() before sharing a large object between threads, and
+    after renaming members in place through iterators.
+
+    Define it to 0 to disable the index altogether.
+*/
+#ifndef RAPIDJSON_MEMBER_INDEX_THRESHOLD
+#define RAPIDJSON_MEMBER_INDEX_THRESHOLD 32
+#endif // RAPIDJSON_MEMBER_INDEX_THRESHOLD
+
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_WASM_SIMD128/RAPIDJSON_SIMD
 
 /*! \def RAPIDJSON_SIMD
     \ingroup RAPIDJSON_CONFIG
-    \brief Enable SSE2/SSE4.2 optimization.
+    \brief Enable SSE2/SSE4.2/WebAssembly SIMD128 optimization.
 
     RapidJSON supports optimized implementations for some parsing operations
     based on the SSE2 or SSE4.2 SIMD extensions on modern Intel-compatible
-    processors.
+    processors, and on the 128-bit SIMD extension of WebAssembly.
 
-    To enable these optimizations, two different symbols can be defined;
+    To enable these optimizations, three different symbols can be defined;
     \code
     // Enable SSE2 optimization.
     #define RAPIDJSON_SSE2
 
     // Enable SSE4.2 optimization.
     #define RAPIDJSON_SSE42
+
+    // Enable WebAssembly SIMD128 optimization.
+    #define RAPIDJSON_WASM_SIMD128
     \endcode
 
-    \c RAPIDJSON_SSE42 takes precedence, if both are defined.
+    \c RAPIDJSON_SSE42 takes precedence over \c RAPIDJSON_SSE2, which takes
+    precedence over \c RAPIDJSON_WASM_SIMD128. The latter is defined
+    automatically when compiling with \c -msimd128 (i.e. \c __wasm_simd128__
+    is defined), unless \c RAPIDJSON_NO_WASM_SIMD128 is defined.
 
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
+#if !defined(RAPIDJSON_WASM_SIMD128) && !defined(RAPIDJSON_NO_WASM_SIMD128) \
+    && defined(__wasm_simd128__) && !defined(RAPIDJSON_SSE2) && !defined(RAPIDJSON_SSE42)
+#define RAPIDJSON_WASM_SIMD128
+#endif
+
+#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) || defined(RAPIDJSON_WASM_SIMD128) \
     || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
 #endif
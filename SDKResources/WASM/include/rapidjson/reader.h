@@ -33,6 +33,8 @@
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
+#elif defined(RAPIDJSON_WASM_SIMD128)
+#include <wasm_simd128.h>
 #endif
 
 #ifdef _MSC_VER
@@ -153,6 +155,7 @@ enum ParseFlag {
     kParseNumbersAsStringsFlag = 64,    //!< Parse all numbers (ints/doubles) as strings.
     kParseTrailingCommasFlag = 128, //!< Allow trailing commas at the end of objects and arrays.
     kParseNanAndInfFlag = 256,      //!< Allow parsing NaN, Inf, Infinity, -Inf and -Infinity as doubles.
+    kParseNoCopyStringsFlag = 512,  //!< Non-destructive zero-copy parsing of strings without escapes. These strings are NOT null-terminated: use their length (see \ref GenericReader::Parse()).
     kParseDefaultFlags = RAPIDJSON_PARSE_DEFAULT_FLAGS  //!< Default parse flags. Can be customized by defining RAPIDJSON_PARSE_DEFAULT_FLAGS
 };
 
@@ -258,7 +261,7 @@ private:
 
 //! Skip the JSON white spaces in a stream.
 /*! \param is A input stream for skipping white spaces.
-    \note This function has SSE2/SSE4.2 specialization.
+    \note This function has SSE2/SSE4.2/WebAssembly SIMD128 specialization.
 */
 template<typename InputStream>
 void SkipWhitespace(InputStream& is) {
@@ -425,7 +428,70 @@ inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
     return SkipWhitespace(p, end);
 }
 
-#endif // RAPIDJSON_SSE2
+#elif defined(RAPIDJSON_WASM_SIMD128)
+
+//! Skip whitespace with WebAssembly SIMD128 instructions, testing 16 8-byte characters at once.
+inline const char *SkipWhitespace_SIMD(const char* p) {
+    // Fast return for single non-whitespace
+    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        ++p;
+    else
+        return p;
+
+    // 16-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    while (p != nextAligned)
+        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        else
+            return p;
+
+    // The rest of string
+    const v128_t w0 = wasm_i8x16_splat(' ');
+    const v128_t w1 = wasm_i8x16_splat('\n');
+    const v128_t w2 = wasm_i8x16_splat('\r');
+    const v128_t w3 = wasm_i8x16_splat('\t');
+
+    for (;; p += 16) {
+        const v128_t s = wasm_v128_load(p);
+        v128_t x = wasm_i8x16_eq(s, w0);
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w1));
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w2));
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w3));
+        const uint32_t r = ~wasm_i8x16_bitmask(x) & 0xFFFFu;
+        if (r != 0)     // some of characters is non-whitespace
+            return p + __builtin_ctz(r);
+    }
+}
+
+inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    else
+        return p;
+
+    // The rest of string
+    const v128_t w0 = wasm_i8x16_splat(' ');
+    const v128_t w1 = wasm_i8x16_splat('\n');
+    const v128_t w2 = wasm_i8x16_splat('\r');
+    const v128_t w3 = wasm_i8x16_splat('\t');
+
+    for (; p <= end - 16; p += 16) {
+        const v128_t s = wasm_v128_load(p);
+        v128_t x = wasm_i8x16_eq(s, w0);
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w1));
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w2));
+        x = wasm_v128_or(x, wasm_i8x16_eq(s, w3));
+        const uint32_t r = ~wasm_i8x16_bitmask(x) & 0xFFFFu;
+        if (r != 0)     // some of characters is non-whitespace
+            return p + __builtin_ctz(r);
+    }
+
+    return SkipWhitespace(p, end);
+}
+
+#endif // RAPIDJSON_WASM_SIMD128
 
 #ifdef RAPIDJSON_SIMD
 //! Template function specialization for InsituStringStream
@@ -471,7 +537,7 @@ public:
     /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
         \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
     */
-    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_() {}
+    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_(), state_(IterativeParsingStartState) {}
 
     //! Parse JSON text.
     /*! \tparam parseFlags Combination of \ref ParseFlag.
@@ -480,6 +546,12 @@ public:
         \param is Input stream to be parsed.
         \param handler The handler to receive events.
         \return Whether the parsing is successful.
+        \note With \ref kParseNoCopyStringsFlag, strings without escapes are passed to
+            the handler with \c copy == \c false, pointing into the source buffer of a
+            GenericStringStream or a UTF-8 EncodedInputStream over a MemoryStream.
+            They are \b not null-terminated: \c str[length] is the closing quote, not
+            \c '\\0'. Other strings and other streams are copied as without the flag,
+            as are all strings when transcoding.
     */
     template <unsigned parseFlags, typename InputStream, typename Handler>
     ParseResult Parse(InputStream& is, Handler& handler) {
@@ -536,6 +608,76 @@ public:
     //! Get the position of last parsing error in input, 0 otherwise.
     size_t GetErrorOffset() const { return parseResult_.Offset(); }
 
+    //! Initialize token-by-token parsing of a JSON text.
+    /*! Resets the parse result and the state stack. Call IterativeParseNext()
+        repeatedly afterwards to consume the text one token at a time.
+    */
+    void IterativeParseInit() {
+        parseResult_.Clear();
+        stack_.Clear();
+        state_ = IterativeParsingStartState;
+    }
+
+    //! Parse the next token of a JSON text.
+    /*! Skips whitespace (and comments with \ref kParseCommentsFlag), then consumes exactly
+        one token and invokes \c handler if the token completes a value or a container.
+        The state machine is kept in the reader between calls, so successive calls may be
+        given different streams, e.g. one per input fragment.
+
+        When \c is is exhausted before a token is found, the end of the JSON text is
+        assumed: this succeeds only if a complete root value has been parsed.
+
+        \tparam parseFlags Combination of \ref ParseFlag. Must be identical for all calls following one IterativeParseInit().
+        \tparam InputStream Type of input stream, implementing Stream concept.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param is Input stream holding (at least) the next token.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful so far.
+        \note Scalar tokens must be entirely contained in \c is, they are not resumed across calls.
+    */
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    bool IterativeParseNext(InputStream& is, Handler& handler) {
+        if (RAPIDJSON_UNLIKELY(HasParseError()))
+            return false;
+
+        SkipWhitespaceAndComments<parseFlags>(is);
+        if (RAPIDJSON_UNLIKELY(HasParseError())) {
+            stack_.Clear();
+            state_ = IterativeParsingErrorState;
+            return false;
+        }
+
+        // Handle the end of file.
+        if (is.Peek() == '\0') {
+            if (state_ != IterativeParsingFinishState) {
+                HandleError(state_, is);
+                stack_.Clear();
+                state_ = IterativeParsingErrorState;
+                return false;
+            }
+            return true;
+        }
+
+        Token t = Tokenize(is.Peek());
+        IterativeParsingState n = Predict(state_, t);
+        IterativeParsingState d = Transit<parseFlags>(state_, t, n, is, handler);
+
+        if (RAPIDJSON_UNLIKELY(d == IterativeParsingErrorState)) {
+            HandleError(state_, is);
+            stack_.Clear();
+            state_ = d;
+            return false;
+        }
+
+        state_ = d;
+        return true;
+    }
+
+    //! Whether token-by-token parsing has parsed a complete root value or failed.
+    bool IterativeParseComplete() const {
+        return state_ == IterativeParsingFinishState || state_ == IterativeParsingErrorState;
+    }
+
 protected:
     void SetParseError(ParseErrorCode code, size_t offset) { parseResult_.Set(code, offset); }
 
@@ -813,7 +955,14 @@ private:
         s.Take();  // Skip '\"'
 
         bool success = false;
-        if (parseFlags & kParseInsituFlag) {
+        const Ch* source = 0;
+        SizeType sourceLength = 0;
+        if ((parseFlags & kParseNoCopyStringsFlag) && !(parseFlags & kParseInsituFlag) &&
+            internal::IsSame<SourceEncoding, TargetEncoding>::Value && ScanNoCopyString<parseFlags>(s, source, sourceLength)) {
+            const typename TargetEncoding::Ch* const str = reinterpret_cast<const typename TargetEncoding::Ch*>(source);
+            success = (isKey ? handler.Key(str, sourceLength, false) : handler.String(str, sourceLength, false));
+        }
+        else if (parseFlags & kParseInsituFlag) {
             typename InputStream::Ch *head = s.PutBegin();
             ParseStringToStream<parseFlags, SourceEncoding, SourceEncoding>(s, s);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
@@ -834,6 +983,45 @@ private:
             RAPIDJSON_PARSE_ERROR(kParseErrorTermination, s.Tell());
     }
 
+    // Find a string without escapes in the source buffer for kParseNoCopyStringsFlag, and skip it with its closing quote.
+    // Returns false, leaving the stream untouched, for other strings and for streams without a contiguous buffer.
+    template<unsigned parseFlags, typename InputStream>
+    static RAPIDJSON_FORCEINLINE bool ScanNoCopyString(InputStream&, const Ch*&, SizeType&) {
+        return false;
+    }
+
+    template<unsigned parseFlags>
+    static RAPIDJSON_FORCEINLINE bool ScanNoCopyString(GenericStringStream<SourceEncoding>& is, const Ch*& str, SizeType& length) {
+        return ScanNoCopyString<parseFlags>(is.src_, 0, str, length);
+    }
+
+    template<unsigned parseFlags>
+    static RAPIDJSON_FORCEINLINE bool ScanNoCopyString(EncodedInputStream<UTF8<>, MemoryStream>& is, const Ch*& str, SizeType& length) {
+        RAPIDJSON_STATIC_ASSERT(sizeof(Ch) == 1);
+        return ScanNoCopyString<parseFlags>(reinterpret_cast<const Ch*&>(is.is_.src_), reinterpret_cast<const Ch*>(is.is_.end_), str, length);
+    }
+
+    // Scan [src, end), or up to the null terminator if end is null.
+    template<unsigned parseFlags>
+    static RAPIDJSON_FORCEINLINE bool ScanNoCopyString(const Ch*& src, const Ch* end, const Ch*& str, SizeType& length) {
+        const Ch* p = src;
+        for (; p != end; ++p) {
+            const Ch c = *p;
+            if (RAPIDJSON_UNLIKELY(c == '\"') || RAPIDJSON_UNLIKELY(c == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(c) < 0x20))
+                break;
+            // Only ASCII is valid by itself in every encoding, let ParseStringToStream() validate the rest.
+            if ((parseFlags & kParseValidateEncodingFlag) && RAPIDJSON_UNLIKELY(static_cast<unsigned>(c) >= 0x80))
+                return false;
+        }
+        if (RAPIDJSON_UNLIKELY(p == end || *p != '\"'))
+            return false;
+        RAPIDJSON_ASSERT(static_cast<size_t>(p - src) <= 0xFFFFFFFF);
+        str = src;
+        length = static_cast<SizeType>(p - src);
+        src = p + 1;
+        return true;
+    }
+
     // Parse string to an output is
     // This function handles the prefix/suffix double quotes, escaping, and optional encoding validation.
     template<unsigned parseFlags, typename SEncoding, typename TEncoding, typename InputStream, typename OutputStream>
@@ -1064,8 +1252,225 @@ private:
 
         is.src_ = is.dst_ = p;
     }
+#elif defined(RAPIDJSON_WASM_SIMD128)
+    // Bytes which end an unescaped run: '"', '\\' and control characters below 0x20.
+    static RAPIDJSON_FORCEINLINE uint32_t EscapeMask_SIMD(v128_t s) {
+        const v128_t t1 = wasm_i8x16_eq(s, wasm_i8x16_splat('\"'));
+        const v128_t t2 = wasm_i8x16_eq(s, wasm_i8x16_splat('\\'));
+        const v128_t t3 = wasm_u8x16_lt(s, wasm_i8x16_splat(0x20));
+        return wasm_i8x16_bitmask(wasm_v128_or(wasm_v128_or(t1, t2), t3));
+    }
+
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+
+        // Scan one by one until alignment (an aligned load never crosses the end of linear memory)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                return;
+            }
+            else
+                os.Put(*p++);
+
+        // The rest of string using SIMD
+        for (;; p += 16) {
+            const v128_t s = wasm_v128_load(p);
+            const uint32_t r = EscapeMask_SIMD(s);
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                SizeType length = static_cast<SizeType>(__builtin_ctz(r));
+                char* q = reinterpret_cast<char*>(os.Push(length));
+                for (size_t i = 0; i < length; i++)
+                    q[i] = p[i];
+
+                p += length;
+                break;
+            }
+            wasm_v128_store(os.Push(16), s);
+        }
+
+        is.src_ = p;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        if (is.src_ == is.dst_) {
+            SkipUnescapedString(is);
+            return;
+        }
+
+        char* p = is.src_;
+        char *q = is.dst_;
+
+        // Scan one by one until alignment (an aligned load never crosses the end of linear memory)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                is.dst_ = q;
+                return;
+            }
+            else
+                *q++ = *p++;
+
+        // The rest of string using SIMD
+        for (;; p += 16, q += 16) {
+            const v128_t s = wasm_v128_load(p);
+            const uint32_t r = EscapeMask_SIMD(s);
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                for (const char* pend = p + __builtin_ctz(r); p != pend; )
+                    *q++ = *p++;
+                break;
+            }
+            wasm_v128_store(q, s);
+        }
+
+        is.src_ = p;
+        is.dst_ = q;
+    }
+
+    // When read/write pointers are the same for insitu stream, just skip unescaped characters
+    static RAPIDJSON_FORCEINLINE void SkipUnescapedString(InsituStringStream& is) {
+        RAPIDJSON_ASSERT(is.src_ == is.dst_);
+        char* p = is.src_;
+
+        // Scan one by one until alignment (an aligned load never crosses the end of linear memory)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+        for (; p != nextAligned; p++)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = is.dst_ = p;
+                return;
+            }
+
+        // The rest of string using SIMD
+        for (;; p += 16) {
+            const uint32_t r = EscapeMask_SIMD(wasm_v128_load(p));
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                p += __builtin_ctz(r);
+                break;
+            }
+        }
+
+        is.src_ = is.dst_ = p;
+    }
+#endif
+
+    // Number of digits of v without leading zeros, 0 for 0.
+    static RAPIDJSON_FORCEINLINE int CountSignificandDigits(uint64_t v) {
+        int n = 0;
+        for (; v != 0; v /= 10)
+            n++;
+        return n;
+    }
+
+    // Next count characters of streams with direct access to their buffer if they can be loaded at once, or null.
+    // Only streams which know where their buffer ends qualify: a null-terminated string may end in any of the
+    // next count characters, and loading them would read past its allocation.
+    template<unsigned count, typename InputStream>
+    static RAPIDJSON_FORCEINLINE const char* PeekBlock(InputStream&) {
+        return 0;
+    }
+
+    template<unsigned count>
+    static RAPIDJSON_FORCEINLINE const char* PeekBlock(EncodedInputStream<UTF8<>, MemoryStream>& is) {
+        return static_cast<size_t>(is.is_.end_ - is.is_.src_) >= count ? is.is_.src_ : 0;
+    }
+
+    template<typename InputStream>
+    static RAPIDJSON_FORCEINLINE void Skip(InputStream& is, unsigned count) {
+        while (count--)
+            is.Take();
+    }
+
+    static RAPIDJSON_FORCEINLINE void Skip(EncodedInputStream<UTF8<>, MemoryStream>& is, unsigned count) { is.is_.src_ += count; }
+
+    // Length of the run of digits at p, up to 8, and its value (SWAR).
+    static RAPIDJSON_FORCEINLINE unsigned ParseDigitRun8(const char* p, uint32_t& value) {
+        uint64_t v;                         // p[0] in the lowest byte
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+        std::memcpy(&v, p, 8);
+#else
+        v = 0;
+        for (unsigned k = 0; k < 8; k++)
+            v |= static_cast<uint64_t>(static_cast<unsigned char>(p[k])) << (8 * k);
+#endif
+        v -= RAPIDJSON_UINT64_C2(0x30303030, 0x30303030);
+
+        // High bit of the bytes above 9. A borrow or carry only spoils the bytes after the first of them.
+        const uint64_t nonDigits = ((v + RAPIDJSON_UINT64_C2(0x76767676, 0x76767676)) | v) & RAPIDJSON_UINT64_C2(0x80808080, 0x80808080);
+        unsigned length = 8;
+        if (nonDigits) {
+            length = static_cast<unsigned>((((nonDigits & (0 - nonDigits)) >> 7) * RAPIDJSON_UINT64_C2(0x00010203, 0x04050607)) >> 56);
+            if (length == 0)
+                return 0;
+            v <<= 8 * (8 - length);         // drop the rest, pad with leading zeros
+        }
+
+        // Combine pairs, then quadruples, then halves.
+        v = (v * 10) + (v >> 8);
+        v = (((v & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x000F4240, 0x00000064)) +
+             (((v >> 16) & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x00002710, 0x00000001))) >> 32;
+        value = static_cast<uint32_t>(v);
+        return length;
+    }
+
+#ifdef RAPIDJSON_WASM_SIMD128
+    // Whether the 16 characters at p are all digits, and their value.
+    static RAPIDJSON_FORCEINLINE bool ParseDigits16(const char* p, uint64_t& value) {
+        const v128_t d = wasm_i8x16_sub(wasm_v128_load(p), wasm_i8x16_splat('0'));
+        if (RAPIDJSON_UNLIKELY(wasm_i8x16_bitmask(wasm_u8x16_gt(d, wasm_i8x16_splat(9))) != 0))
+            return false;
+        const v128_t pairs = wasm_i16x8_narrow_i32x4(       // 8 x 2 digits
+            wasm_i32x4_dot_i16x8(wasm_u16x8_extend_low_u8x16(d), wasm_i16x8_make(10, 1, 10, 1, 10, 1, 10, 1)),
+            wasm_i32x4_dot_i16x8(wasm_u16x8_extend_high_u8x16(d), wasm_i16x8_make(10, 1, 10, 1, 10, 1, 10, 1)));
+        const v128_t quads = wasm_i32x4_dot_i16x8(pairs, wasm_i16x8_make(100, 1, 100, 1, 100, 1, 100, 1));
+        const v128_t halves = wasm_i32x4_dot_i16x8(         // 2 x 8 digits
+            wasm_i16x8_narrow_i32x4(quads, quads), wasm_i16x8_make(10000, 1, 10000, 1, 0, 0, 0, 0));
+        value = static_cast<uint64_t>(wasm_i32x4_extract_lane(halves, 0)) * 100000000u +
+            static_cast<uint32_t>(wasm_i32x4_extract_lane(halves, 1));
+        return true;
+    }
+#else
+    static RAPIDJSON_FORCEINLINE bool ParseDigits16(const char*, uint64_t&) {
+        return false;
+    }
 #endif
 
+    static RAPIDJSON_FORCEINLINE uint32_t Pow10Digits(unsigned length) {
+        static const uint32_t kPow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+        RAPIDJSON_ASSERT(length <= 8);
+        return kPow10[length];
+    }
+
+    // Take the run of up to 8 digits of a number at once if it has at least minLength digits.
+    // Returns its length, 0 for shorter runs or if the stream does not allow it.
+    template<typename NumberStreamType>
+    static RAPIDJSON_FORCEINLINE unsigned TakeDigits8(NumberStreamType& s, uint32_t& value, unsigned minLength = 1) {
+        const char* p = s.template PeekBlock<8>();
+        if (!p)
+            return 0;
+        const unsigned length = ParseDigitRun8(p, value);
+        if (length < minLength)
+            return 0;
+        s.Skip(p, length);
+        return length;
+    }
+
+    // Take 16 digits of a long mantissa at once, with SIMD128 only.
+    template<typename NumberStreamType>
+    static RAPIDJSON_FORCEINLINE bool TakeDigits16(NumberStreamType& s, uint64_t& value) {
+        const char* p = s.template PeekBlock<16>();
+        if (!p || !ParseDigits16(p, value))
+            return false;
+        s.Skip(p, 16);
+        return true;
+    }
+
     template<typename InputStream, bool backup, bool pushOnTake>
     class NumberStream;
 
@@ -1082,6 +1487,10 @@ private:
         RAPIDJSON_FORCEINLINE Ch Take() { return is.Take(); }
 		  RAPIDJSON_FORCEINLINE void Push(char) {}
 
+        template <unsigned count>
+        RAPIDJSON_FORCEINLINE const char* PeekBlock() { return GenericReader::template PeekBlock<count>(is); }
+        RAPIDJSON_FORCEINLINE void Skip(const char*, unsigned count) { GenericReader::Skip(is, count); }
+
         size_t Tell() { return is.Tell(); }
         size_t Length() { return 0; }
         const char* Pop() { return 0; }
@@ -1108,6 +1517,11 @@ private:
             stackStream.Put(c);
         }
 
+        RAPIDJSON_FORCEINLINE void Skip(const char* p, unsigned count) {
+            std::memcpy(stackStream.Push(count), p, count);
+            Base::Skip(p, count);
+        }
+
         size_t Length() { return stackStream.Length(); }
 
         const char* Pop() {
@@ -1156,7 +1570,14 @@ private:
             s.TakePush();
         }
         else if (RAPIDJSON_LIKELY(s.Peek() >= '1' && s.Peek() <= '9')) {
-            i = static_cast<unsigned>(s.TakePush() - '0');
+            // Up to 8 digits stay below the overflow checks of the loops.
+            uint32_t digits;
+            if (const unsigned length = TakeDigits8(s, digits)) {
+                i = digits;
+                significandDigit += static_cast<int>(length) - 1;
+            }
+            else
+                i = static_cast<unsigned>(s.TakePush() - '0');
 
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
@@ -1204,6 +1625,13 @@ private:
         // Parse 64bit int
         bool useDouble = false;
         if (use64bit) {
+            // i64 < 2^32 here, 8 more digits do not reach the overflow checks of the loops.
+            uint32_t digits;
+            if (const unsigned length = TakeDigits8(s, digits)) {
+                i64 = i64 * Pow10Digits(length) + digits;
+                significandDigit += static_cast<int>(length);
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                      if (RAPIDJSON_UNLIKELY(i64 >= RAPIDJSON_UINT64_C2(0x0CCCCCCC, 0xCCCCCCCC))) // 2^63 = 9223372036854775808
@@ -1252,6 +1680,21 @@ private:
                 if (!use64bit)
                     i64 = i;
 
+                // Take long runs of digits at once while the digit-by-digit loop below would not stop at 2^53 in
+                // between. Short fractions are as fast digit by digit.
+                uint64_t digits16;
+                if (i64 <= 8 && TakeDigits16(s, digits16)) {
+                    significandDigit += i64 != 0 ? 16 : CountSignificandDigits(digits16);
+                    i64 = i64 * RAPIDJSON_UINT64_C2(0x002386F2, 0x6FC10000) + digits16;  // 10^16
+                    expFrac -= 16;
+                }
+                uint32_t digits;
+                while (i64 <= 900719924 && TakeDigits8(s, digits, 8)) {
+                    significandDigit += i64 != 0 ? 8 : CountSignificandDigits(digits);
+                    i64 = i64 * 100000000u + digits;
+                    expFrac -= 8;
+                }
+
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (i64 > RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF)) // 2^53 - 1 for fast path
                         break;
@@ -1278,8 +1721,11 @@ private:
                     if (RAPIDJSON_LIKELY(d > 0.0))
                         significandDigit++;
                 }
-                else
-                    s.TakePush();
+                else {
+                    uint32_t digits;
+                    if (!TakeDigits8(s, digits))
+                        s.TakePush();
+                }
             }
         }
         else
@@ -1856,6 +2302,7 @@ private:
     static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing a single decoded string.
     internal::Stack<StackAllocator> stack_;  //!< A stack for storing decoded string temporarily during non-destructive parsing.
     ParseResult parseResult_;
+    IterativeParsingState state_;            //!< State of token-by-token parsing, see IterativeParseNext().
 }; // class GenericReader
 
 //! Reader with UTF8 encoding and default allocator.
@@ -155,6 +155,9 @@ public:
     virtual void DestroryHasher(void* hasher) = 0;
     virtual void* MallocState(size_t size) = 0;
     virtual void FreeState(void* p) = 0;
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    virtual bool IsPatternMatch(const typename SchemaType::RegexType& pattern, const typename SchemaType::Ch* str, SizeType length) = 0;
+#endif
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -215,6 +218,9 @@ public:
 
     bool IsValid() const { return stack_.GetSize() == sizeof(uint64_t); }
 
+    //! Discards the hash codes but keeps the memory, for hashing another value.
+    void Reset() { stack_.Clear(); }
+
     uint64_t GetHashCode() const {
         RAPIDJSON_ASSERT(IsValid());
         return *stack_.template Top<uint64_t>();
@@ -345,6 +351,13 @@ public:
     typedef SchemaValidationContext<SchemaDocumentType> Context;
     typedef Schema<SchemaDocumentType> SchemaType;
     typedef GenericValue<EncodingType, AllocatorType> SValue;
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    typedef internal::GenericRegex<EncodingType> RegexType;
+#elif RAPIDJSON_SCHEMA_USE_STDREGEX
+    typedef std::basic_regex<Ch> RegexType;
+#else
+    typedef char RegexType;
+#endif
     friend class GenericSchemaDocument<ValueType, AllocatorType>;
 
     Schema(SchemaDocumentType* schemaDocument, const PointerType& p, const ValueType& value, const ValueType& document, AllocatorType* allocator) :
@@ -474,7 +487,7 @@ public:
 
             for (ConstMemberIterator itr = v->MemberBegin(); itr != v->MemberEnd(); ++itr) {
                 new (&patternProperties_[patternPropertyCount_]) PatternProperty();
-                patternProperties_[patternPropertyCount_].pattern = CreatePattern(itr->name);
+                patternProperties_[patternPropertyCount_].pattern = schemaDocument->GetPattern(itr->name);
                 schemaDocument->CreateSchema(&patternProperties_[patternPropertyCount_].schema, q.Append(itr->name, allocator_), itr->value, document);
                 patternPropertyCount_++;
             }
@@ -555,7 +568,7 @@ public:
         AssignIfExist(maxLength_, value, GetMaxLengthString());
 
         if (const ValueType* v = GetMember(value, GetPatternString()))
-            pattern_ = CreatePattern(*v);
+            pattern_ = schemaDocument->GetPattern(*v);
 
         // Number
         if (const ValueType* v = GetMember(value, GetMinimumString()))
@@ -589,12 +602,6 @@ public:
             AllocatorType::Free(patternProperties_);
         }
         AllocatorType::Free(itemsTuple_);
-#if RAPIDJSON_SCHEMA_HAS_REGEX
-        if (pattern_) {
-            pattern_->~RegexType();
-            allocator_->Free(pattern_);
-        }
-#endif
     }
 
     bool BeginValue(Context& context) const {
@@ -755,7 +762,7 @@ public:
             }
         }
 
-        if (pattern_ && !IsPatternMatch(pattern_, str, length))
+        if (pattern_ && !IsPatternMatch(context, pattern_, str, length))
             RAPIDJSON_INVALID_KEYWORD_RETURN(GetPatternString());
 
         return CreateParallelValidator(context);
@@ -783,8 +790,9 @@ public:
     bool Key(Context& context, const Ch* str, SizeType len, bool) const {
         if (patternProperties_) {
             context.patternPropertiesSchemaCount = 0;
+            context.valuePatternValidatorType = Context::kPatternValidatorOnly;
             for (SizeType i = 0; i < patternPropertyCount_; i++)
-                if (patternProperties_[i].pattern && IsPatternMatch(patternProperties_[i].pattern, str, len))
+                if (patternProperties_[i].pattern && IsPatternMatch(context, patternProperties_[i].pattern, str, len))
                     context.patternPropertiesSchemas[context.patternPropertiesSchemaCount++] = patternProperties_[i].schema;
         }
 
@@ -822,6 +830,7 @@ public:
         if (context.patternPropertiesSchemaCount == 0) // patternProperties are not additional properties
             RAPIDJSON_INVALID_KEYWORD_RETURN(GetAdditionalPropertiesString());
 
+        context.valueSchema = GetTypeless(); // value is checked by the pattern validators only
         return true;
     }
 
@@ -933,14 +942,6 @@ private:
         kTotalSchemaType
     };
 
-#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
-        typedef internal::GenericRegex<EncodingType> RegexType;
-#elif RAPIDJSON_SCHEMA_USE_STDREGEX
-        typedef std::basic_regex<Ch> RegexType;
-#else
-        typedef char RegexType;
-#endif
-
     struct SchemaArray {
         SchemaArray() : schemas(), count() {}
         ~SchemaArray() { AllocatorType::Free(schemas); }
@@ -997,9 +998,9 @@ private:
 
 #if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
     template <typename ValueType>
-    RegexType* CreatePattern(const ValueType& value) {
+    static RegexType* CreatePattern(const ValueType& value, AllocatorType* allocator) {
         if (value.IsString()) {
-            RegexType* r = new (allocator_->Malloc(sizeof(RegexType))) RegexType(value.GetString());
+            RegexType* r = new (allocator->Malloc(sizeof(RegexType))) RegexType(value.GetString());
             if (!r->IsValid()) {
                 r->~RegexType();
                 AllocatorType::Free(r);
@@ -1010,30 +1011,47 @@ private:
         return 0;
     }
 
-    static bool IsPatternMatch(const RegexType* pattern, const Ch *str, SizeType) {
-        return pattern->Search(str);
+    static void DestroyPattern(RegexType* pattern) {
+        if (pattern) {
+            pattern->~RegexType();
+            AllocatorType::Free(pattern);
+        }
+    }
+
+    // Matching changes the regex search state, which is kept by the validator.
+    static bool IsPatternMatch(Context& context, const RegexType* pattern, const Ch *str, SizeType length) {
+        return context.factory.IsPatternMatch(*pattern, str, length);
     }
 #elif RAPIDJSON_SCHEMA_USE_STDREGEX
     template <typename ValueType>
-    RegexType* CreatePattern(const ValueType& value) {
+    static RegexType* CreatePattern(const ValueType& value, AllocatorType* allocator) {
         if (value.IsString())
             try {
-                return new (allocator_->Malloc(sizeof(RegexType))) RegexType(value.GetString(), std::size_t(value.GetStringLength()), std::regex_constants::ECMAScript);
+                return new (allocator->Malloc(sizeof(RegexType))) RegexType(value.GetString(), std::size_t(value.GetStringLength()), std::regex_constants::ECMAScript);
             }
             catch (const std::regex_error&) {
             }
         return 0;
     }
 
-    static bool IsPatternMatch(const RegexType* pattern, const Ch *str, SizeType length) {
+    static void DestroyPattern(RegexType* pattern) {
+        if (pattern) {
+            pattern->~RegexType();
+            AllocatorType::Free(pattern);
+        }
+    }
+
+    static bool IsPatternMatch(Context&, const RegexType* pattern, const Ch *str, SizeType length) {
         std::match_results<const Ch*> r;
         return std::regex_search(str, str + length, r, *pattern);
     }
 #else
     template <typename ValueType>
-    RegexType* CreatePattern(const ValueType&) { return 0; }
+    static RegexType* CreatePattern(const ValueType&, AllocatorType*) { return 0; }
+
+    static void DestroyPattern(RegexType*) {}
 
-    static bool IsPatternMatch(const RegexType*, const Ch *, SizeType) { return true; }
+    static bool IsPatternMatch(Context&, const RegexType*, const Ch *, SizeType) { return true; }
 #endif // RAPIDJSON_SCHEMA_USE_STDREGEX
 
     void AddType(const ValueType& type) {
@@ -1207,14 +1225,8 @@ private:
 
     struct PatternProperty {
         PatternProperty() : schema(), pattern() {}
-        ~PatternProperty() { 
-            if (pattern) {
-                pattern->~RegexType();
-                AllocatorType::Free(pattern);
-            }
-        }
         const SchemaType* schema;
-        RegexType* pattern;
+        const RegexType* pattern;   // owned by the schema document
     };
 
     AllocatorType* allocator_;
@@ -1249,7 +1261,7 @@ private:
     bool additionalItems_;
     bool uniqueItems_;
 
-    RegexType* pattern_;
+    const RegexType* pattern_;  // owned by the schema document
     SizeType minLength_;
     SizeType maxLength_;
 
@@ -1344,7 +1356,8 @@ public:
         ownAllocator_(),
         root_(),
         schemaMap_(allocator, kInitialSchemaMapSize),
-        schemaRef_(allocator, kInitialSchemaRefSize)
+        schemaRef_(allocator, kInitialSchemaRefSize),
+        patternMap_(allocator, kInitialPatternMapSize)
     {
         if (!allocator_)
             ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
@@ -1381,7 +1394,8 @@ public:
         ownAllocator_(rhs.ownAllocator_),
         root_(rhs.root_),
         schemaMap_(std::move(rhs.schemaMap_)),
-        schemaRef_(std::move(rhs.schemaRef_))
+        schemaRef_(std::move(rhs.schemaRef_)),
+        patternMap_(std::move(rhs.patternMap_))
     {
         rhs.remoteProvider_ = 0;
         rhs.allocator_ = 0;
@@ -1394,6 +1408,12 @@ public:
         while (!schemaMap_.Empty())
             schemaMap_.template Pop<SchemaEntry>(1)->~SchemaEntry();
 
+        while (!patternMap_.Empty()) {
+            PatternEntry* e = patternMap_.template Pop<PatternEntry>(1);
+            SchemaType::DestroyPattern(e->pattern);
+            Allocator::Free(e->source);
+        }
+
         RAPIDJSON_DELETE(ownAllocator_);
     }
 
@@ -1413,6 +1433,12 @@ private:
         const SchemaType** schema;
     };
 
+    struct PatternEntry {
+        Ch* source;
+        SizeType length;
+        typename SchemaType::RegexType* pattern;  // null if invalid
+    };
+
     struct SchemaEntry {
         SchemaEntry(const PointerType& p, SchemaType* s, bool o, Allocator* allocator) : pointer(p, allocator), schema(s), owned(o) {}
         ~SchemaEntry() {
@@ -1508,6 +1534,23 @@ private:
         return 0;
     }
 
+    //! Compiles a pattern once per schema document, for all schemas using it.
+    const typename SchemaType::RegexType* GetPattern(const ValueType& value) {
+        if (!value.IsString())
+            return 0;
+        const SizeType length = value.GetStringLength();
+        for (const PatternEntry* e = patternMap_.template Bottom<PatternEntry>(); e != patternMap_.template End<PatternEntry>(); ++e)
+            if (e->length == length && std::memcmp(e->source, value.GetString(), length * sizeof(Ch)) == 0)
+                return e->pattern;
+
+        PatternEntry* e = patternMap_.template Push<PatternEntry>();
+        e->source = static_cast<Ch*>(allocator_->Malloc((length + 1) * sizeof(Ch)));
+        std::memcpy(e->source, value.GetString(), (length + 1) * sizeof(Ch));
+        e->length = length;
+        e->pattern = SchemaType::CreatePattern(value, allocator_);
+        return e->pattern;
+    }
+
     PointerType GetPointer(const SchemaType* schema) const {
         for (const SchemaEntry* target = schemaMap_.template Bottom<SchemaEntry>(); target != schemaMap_.template End<SchemaEntry>(); ++target)
             if (schema == target->schema)
@@ -1517,6 +1560,7 @@ private:
 
     static const size_t kInitialSchemaMapSize = 64;
     static const size_t kInitialSchemaRefSize = 64;
+    static const size_t kInitialPatternMapSize = 64;
 
     IRemoteSchemaDocumentProviderType* remoteProvider_;
     Allocator *allocator_;
@@ -1524,6 +1568,7 @@ private:
     const SchemaType* root_;                //!< Root schema.
     internal::Stack<Allocator> schemaMap_;  // Stores created Pointer -> Schemas
     internal::Stack<Allocator> schemaRef_;  // Stores Pointer from $ref and schema which holds the $ref
+    internal::Stack<Allocator> patternMap_; // Stores compiled patterns, shared by all schemas
 };
 
 //! GenericSchemaDocument using Value type.
@@ -1574,13 +1619,21 @@ public:
         size_t documentStackCapacity = kDefaultDocumentStackCapacity)
         :
         schemaDocument_(&schemaDocument),
-        root_(schemaDocument.GetRoot()),
+        root_(&schemaDocument.GetRoot()),
         outputHandler_(GetNullHandler()),
         stateAllocator_(allocator),
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        validatorCache_(allocator, kDefaultCacheCapacity),
+        hasherCache_(allocator, kDefaultCacheCapacity),
+        hashCodeArrayCache_(allocator, kDefaultCacheCapacity),
+        stateCache_(),
         valid_(true)
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+        , patternOwner_(0)
+        , patternSearches_(allocator, kDefaultCacheCapacity)
+#endif
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(0)
 #endif
@@ -1602,13 +1655,21 @@ public:
         size_t documentStackCapacity = kDefaultDocumentStackCapacity)
         :
         schemaDocument_(&schemaDocument),
-        root_(schemaDocument.GetRoot()),
+        root_(&schemaDocument.GetRoot()),
         outputHandler_(outputHandler),
         stateAllocator_(allocator),
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        validatorCache_(allocator, kDefaultCacheCapacity),
+        hasherCache_(allocator, kDefaultCacheCapacity),
+        hashCodeArrayCache_(allocator, kDefaultCacheCapacity),
+        stateCache_(),
         valid_(true)
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+        , patternOwner_(0)
+        , patternSearches_(allocator, kDefaultCacheCapacity)
+#endif
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(0)
 #endif
@@ -1618,10 +1679,27 @@ public:
     //! Destructor.
     ~GenericSchemaValidator() {
         Reset();
+        ReleaseCaches();
         RAPIDJSON_DELETE(ownStateAllocator_);
     }
 
     //! Reset the internal states.
+    /*!
+        Call this before validating another document with the same validator.
+        The memory of the validation states (stacks, hashers, sub-validators of
+        allOf/anyOf/oneOf/not/dependencies/patternProperties and their
+        bookkeeping arrays) is kept for the next document, so once a validator
+        has seen documents of a given shape it validates further ones without
+        allocating.
+
+        The regex searches of "pattern" and "patternProperties", with their
+        DFA caches, are kept too.
+
+        The schema document, including its compiled patterns, is not modified
+        by validation, since each validator matches patterns with searches of
+        its own. So validators on different threads can share a schema
+        document. A validator itself is used by one thread at a time.
+    */
     void Reset() {
         while (!schemaStack_.Empty())
             PopSchema();
@@ -1738,21 +1816,37 @@ RAPIDJSON_MULTILINEMACRO_END
 #undef RAPIDJSON_SCHEMA_HANDLE_VALUE_
 
     // Implementation of ISchemaStateFactory<SchemaType>
+    // Destroyed validators, hashers and states are kept in caches and handed out again,
+    // see Reset().
     virtual ISchemaValidator* CreateSchemaValidator(const SchemaType& root) {
-        return new (GetStateAllocator().Malloc(sizeof(GenericSchemaValidator))) GenericSchemaValidator(*schemaDocument_, root,
+        if (!validatorCache_.Empty()) {
+            GenericSchemaValidator* v = *validatorCache_.template Pop<GenericSchemaValidator*>(1);
+            v->root_ = &root;
+#if RAPIDJSON_SCHEMA_VERBOSE
+            v->depth_ = depth_ + 1;
+#endif
+            return v;
+        }
+        GenericSchemaValidator* v = new (GetStateAllocator().Malloc(sizeof(GenericSchemaValidator))) GenericSchemaValidator(*schemaDocument_, root,
 #if RAPIDJSON_SCHEMA_VERBOSE
         depth_ + 1,
 #endif
         &GetStateAllocator());
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+        v->patternOwner_ = patternOwner_ ? patternOwner_ : this;
+#endif
+        return v;
     }
 
     virtual void DestroySchemaValidator(ISchemaValidator* validator) {
         GenericSchemaValidator* v = static_cast<GenericSchemaValidator*>(validator);
-        v->~GenericSchemaValidator();
-        StateAllocator::Free(v);
+        v->Reset();
+        *validatorCache_.template Push<GenericSchemaValidator*>() = v;
     }
 
     virtual void* CreateHasher() {
+        if (!hasherCache_.Empty())
+            return *hasherCache_.template Pop<HasherType*>(1);
         return new (GetStateAllocator().Malloc(sizeof(HasherType))) HasherType(&GetStateAllocator());
     }
 
@@ -1762,22 +1856,58 @@ RAPIDJSON_MULTILINEMACRO_END
 
     virtual void DestroryHasher(void* hasher) {
         HasherType* h = static_cast<HasherType*>(hasher);
-        h->~HasherType();
-        StateAllocator::Free(h);
+        h->Reset();
+        *hasherCache_.template Push<HasherType*>() = h;
     }
 
     virtual void* MallocState(size_t size) {
-        return GetStateAllocator().Malloc(size);
+        // Blocks are rounded up to a power of two and prefixed with their size class.
+        size_t sizeClass = 0;
+        while (sizeClass < kStateSizeClassCount && (kMinStateSize << sizeClass) < size + sizeof(StateHeader))
+            sizeClass++;
+
+        StateHeader* h;
+        if (sizeClass < kStateSizeClassCount && stateCache_[sizeClass]) {
+            h = stateCache_[sizeClass];
+            stateCache_[sizeClass] = h->next;
+        }
+        else
+            h = static_cast<StateHeader*>(GetStateAllocator().Malloc(sizeClass < kStateSizeClassCount ? kMinStateSize << sizeClass : size + sizeof(StateHeader)));
+        h->sizeClass = sizeClass;
+        return h + 1;
     }
 
     virtual void FreeState(void* p) {
-        return StateAllocator::Free(p);
+        StateHeader* h = static_cast<StateHeader*>(p) - 1;
+        const size_t sizeClass = h->sizeClass;
+        if (sizeClass < kStateSizeClassCount) {
+            h->next = stateCache_[sizeClass];
+            stateCache_[sizeClass] = h;
+        }
+        else
+            StateAllocator::Free(h);
     }
 
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    virtual bool IsPatternMatch(const typename SchemaType::RegexType& pattern, const Ch* str, SizeType) {
+        return GetPatternSearch(pattern).Search(str);
+    }
+#endif
+
 private:
     typedef typename SchemaType::Context Context;
     typedef GenericValue<UTF8<>, StateAllocator> HashCodeArray;
     typedef internal::Hasher<EncodingType, StateAllocator> HasherType;
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    typedef typename SchemaType::RegexType RegexType;
+    typedef internal::GenericRegexSearch<RegexType, StateAllocator> RegexSearchType;
+#endif
+
+    //! Prefix of blocks from MallocState(). Links the block in stateCache_ once freed.
+    union StateHeader {
+        size_t sizeClass;
+        StateHeader* next;
+    };
 
     GenericSchemaValidator( 
         const SchemaDocumentType& schemaDocument,
@@ -1790,13 +1920,21 @@ private:
         size_t documentStackCapacity = kDefaultDocumentStackCapacity)
         :
         schemaDocument_(&schemaDocument),
-        root_(root),
+        root_(&root),
         outputHandler_(GetNullHandler()),
         stateAllocator_(allocator),
         ownStateAllocator_(0),
         schemaStack_(allocator, schemaStackCapacity),
         documentStack_(allocator, documentStackCapacity),
+        validatorCache_(allocator, kDefaultCacheCapacity),
+        hasherCache_(allocator, kDefaultCacheCapacity),
+        hashCodeArrayCache_(allocator, kDefaultCacheCapacity),
+        stateCache_(),
         valid_(true)
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+        , patternOwner_(0)
+        , patternSearches_(allocator, kDefaultCacheCapacity)
+#endif
 #if RAPIDJSON_SCHEMA_VERBOSE
         , depth_(depth)
 #endif
@@ -1811,7 +1949,7 @@ private:
 
     bool BeginValue() {
         if (schemaStack_.Empty())
-            PushSchema(root_);
+            PushSchema(*root_);
         else {
             if (CurrentContext().inArray)
                 internal::TokenHelper<internal::Stack<StateAllocator>, Ch>::AppendIndexToken(documentStack_, CurrentContext().arrayElementIndex);
@@ -1861,8 +1999,13 @@ private:
             Context& context = CurrentContext();
             if (context.valueUniqueness) {
                 HashCodeArray* a = static_cast<HashCodeArray*>(context.arrayElementHashCodes);
-                if (!a)
-                    CurrentContext().arrayElementHashCodes = a = new (GetStateAllocator().Malloc(sizeof(HashCodeArray))) HashCodeArray(kArrayType);
+                if (!a) {
+                    if (!hashCodeArrayCache_.Empty())
+                        a = *hashCodeArrayCache_.template Pop<HashCodeArray*>(1);
+                    else
+                        a = new (GetStateAllocator().Malloc(sizeof(HashCodeArray))) HashCodeArray(kArrayType);
+                    CurrentContext().arrayElementHashCodes = a;
+                }
                 for (typename HashCodeArray::ConstValueIterator itr = a->Begin(); itr != a->End(); ++itr)
                     if (itr->GetUint64() == h)
                         RAPIDJSON_INVALID_KEYWORD_RETURN(SchemaType::GetUniqueItemsString());
@@ -1894,15 +2037,65 @@ private:
         }
     }
 
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    //! Gets the search of a pattern, shared by a validator and its sub-validators.
+    /*!
+        The compiled patterns belong to the schema document and are shared by all
+        validators. The search state, including the lazily built DFA, is kept here
+        so that validators on different threads do not share it.
+    */
+    RegexSearchType& GetPatternSearch(const RegexType& pattern) {
+        if (patternOwner_)
+            return patternOwner_->GetPatternSearch(pattern);
+        for (RegexSearchType** s = patternSearches_.template Bottom<RegexSearchType*>(); s != patternSearches_.template End<RegexSearchType*>(); ++s)
+            if (&(*s)->GetRegex() == &pattern)
+                return **s;
+        RegexSearchType* s = new (GetStateAllocator().Malloc(sizeof(RegexSearchType))) RegexSearchType(pattern, &GetStateAllocator());
+        *patternSearches_.template Push<RegexSearchType*>() = s;
+        return *s;
+    }
+#endif
+
     RAPIDJSON_FORCEINLINE void PushSchema(const SchemaType& schema) { new (schemaStack_.template Push<Context>()) Context(*this, &schema); }
     
     RAPIDJSON_FORCEINLINE void PopSchema() {
         Context* c = schemaStack_.template Pop<Context>(1);
         if (HashCodeArray* a = static_cast<HashCodeArray*>(c->arrayElementHashCodes)) {
+            a->Clear();
+            *hashCodeArrayCache_.template Push<HashCodeArray*>() = a;
+        }
+        c->~Context();
+    }
+
+    //! Frees the validation states and pattern searches kept by Reset().
+    void ReleaseCaches() {
+        while (!validatorCache_.Empty()) {
+            GenericSchemaValidator* v = *validatorCache_.template Pop<GenericSchemaValidator*>(1);
+            v->~GenericSchemaValidator();
+            StateAllocator::Free(v);
+        }
+        while (!hasherCache_.Empty()) {
+            HasherType* h = *hasherCache_.template Pop<HasherType*>(1);
+            h->~HasherType();
+            StateAllocator::Free(h);
+        }
+        while (!hashCodeArrayCache_.Empty()) {
+            HashCodeArray* a = *hashCodeArrayCache_.template Pop<HashCodeArray*>(1);
             a->~HashCodeArray();
             StateAllocator::Free(a);
         }
-        c->~Context();
+        for (size_t i = 0; i < kStateSizeClassCount; i++)
+            while (StateHeader* h = stateCache_[i]) {
+                stateCache_[i] = h->next;
+                StateAllocator::Free(h);
+            }
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+        while (!patternSearches_.Empty()) {
+            RegexSearchType* s = *patternSearches_.template Pop<RegexSearchType*>(1);
+            s->~RegexSearchType();
+            StateAllocator::Free(s);
+        }
+#endif
     }
 
     const SchemaType& CurrentSchema() const { return *schemaStack_.template Top<Context>()->schema; }
@@ -1916,14 +2109,25 @@ private:
 
     static const size_t kDefaultSchemaStackCapacity = 1024;
     static const size_t kDefaultDocumentStackCapacity = 256;
+    static const size_t kDefaultCacheCapacity = 8 * sizeof(void*);
+    static const size_t kMinStateSize = 16;             //!< Size of the smallest cached state block, including its header.
+    static const size_t kStateSizeClassCount = 12;      //!< Number of cached state block sizes, 16 bytes to 32 KiB.
     const SchemaDocumentType* schemaDocument_;
-    const SchemaType& root_;
+    const SchemaType* root_;
     OutputHandler& outputHandler_;
     StateAllocator* stateAllocator_;
     StateAllocator* ownStateAllocator_;
     internal::Stack<StateAllocator> schemaStack_;    //!< stack to store the current path of schema (BaseSchemaType *)
     internal::Stack<StateAllocator> documentStack_;  //!< stack to store the current path of validating document (Ch)
+    internal::Stack<StateAllocator> validatorCache_;     //!< destroyed sub-validators (GenericSchemaValidator*)
+    internal::Stack<StateAllocator> hasherCache_;        //!< destroyed hashers (HasherType*)
+    internal::Stack<StateAllocator> hashCodeArrayCache_; //!< destroyed arrays of element hash codes (HashCodeArray*)
+    StateHeader* stateCache_[kStateSizeClassCount];      //!< freed state blocks, one list per size class
     bool valid_;
+#if RAPIDJSON_SCHEMA_USE_INTERNALREGEX
+    GenericSchemaValidator* patternOwner_;               //!< validator keeping the pattern searches, 0 for this one
+    internal::Stack<StateAllocator> patternSearches_;    //!< searches of the patterns met so far (RegexSearchType*)
+#endif
 #if RAPIDJSON_SCHEMA_VERBOSE
     unsigned depth_;
 #endif
@@ -0,0 +1,331 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_SEGMENTEDBUFFER_H_
+#define RAPIDJSON_SEGMENTEDBUFFER_H_
+
+#include "stream.h"
+#include "internal/stack.h"
+
+#if defined(__clang__)
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSegmentPool
+
+//! Free list of fixed-size memory segments.
+/*! Segments released to the pool are kept and handed out again by Acquire(),
+    so once the pool is warm, filling and clearing buffers allocates nothing.
+    A pool can be shared by several GenericSegmentedBuffer, but it is not
+    thread-safe.
+
+    \tparam BaseAllocator the allocator type for allocating segments. Default is CrtAllocator.
+*/
+template <typename BaseAllocator = CrtAllocator>
+class GenericSegmentPool {
+public:
+    static const size_t kDefaultSegmentSize = 4096;     //!< Default segment size in bytes.
+
+    //! Constructor.
+    /*! \param segmentSize Size of a segment in bytes.
+        \param baseAllocator The allocator for allocating segments.
+    */
+    explicit GenericSegmentPool(size_t segmentSize = kDefaultSegmentSize, BaseAllocator* baseAllocator = 0) :
+        freeHead_(0), segmentSize_(segmentSize < sizeof(FreeSegment) ? sizeof(FreeSegment) : segmentSize),
+        segmentCount_(0), freeCount_(0), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+    {
+        if (!baseAllocator_)
+            ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
+    }
+
+    //! Destructor.
+    /*! All segments must have been released.
+    */
+    ~GenericSegmentPool() {
+        RAPIDJSON_ASSERT(freeCount_ == segmentCount_);
+        Shrink();
+        RAPIDJSON_DELETE(ownBaseAllocator_);
+    }
+
+    //! Takes a segment from the free list, or allocates one if the list is empty.
+    /*! \return Segment of GetSegmentSize() bytes.
+    */
+    void* Acquire() {
+        if (freeHead_) {
+            FreeSegment* s = freeHead_;
+            freeHead_ = s->next;
+            freeCount_--;
+            return s;
+        }
+        void* s = baseAllocator_->Malloc(segmentSize_);
+        RAPIDJSON_ASSERT(s != 0);
+        segmentCount_++;
+        return s;
+    }
+
+    //! Returns a segment to the free list.
+    void Release(void* segment) {
+        RAPIDJSON_ASSERT(segment != 0);
+        FreeSegment* s = static_cast<FreeSegment*>(segment);
+        s->next = freeHead_;
+        freeHead_ = s;
+        freeCount_++;
+    }
+
+    //! Allocates segments ahead, until at least \c count are free.
+    void Reserve(size_t count) {
+        while (freeCount_ < count) {
+            Release(baseAllocator_->Malloc(segmentSize_));
+            segmentCount_++;
+        }
+    }
+
+    //! Frees all segments of the free list.
+    void Shrink() {
+        while (freeHead_) {
+            FreeSegment* next = freeHead_->next;
+            BaseAllocator::Free(freeHead_);
+            freeHead_ = next;
+        }
+        segmentCount_ -= freeCount_;
+        freeCount_ = 0;
+    }
+
+    //! Size of a segment in bytes.
+    size_t GetSegmentSize() const { return segmentSize_; }
+
+    //! Number of segments allocated from the base allocator, in use or free.
+    size_t GetSegmentCount() const { return segmentCount_; }
+
+    //! Number of segments in the free list.
+    size_t GetFreeSegmentCount() const { return freeCount_; }
+
+    //! Allocator of the segments.
+    BaseAllocator& GetAllocator() { return *baseAllocator_; }
+
+private:
+    GenericSegmentPool(const GenericSegmentPool&);
+    GenericSegmentPool& operator=(const GenericSegmentPool&);
+
+    struct FreeSegment {
+        FreeSegment* next;
+    };
+
+    FreeSegment* freeHead_;
+    size_t segmentSize_;
+    size_t segmentCount_;
+    size_t freeCount_;
+    BaseAllocator* baseAllocator_;
+    BaseAllocator* ownBaseAllocator_;
+};
+
+//! Segment pool with the default CrtAllocator.
+typedef GenericSegmentPool<> SegmentPool;
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSegmentedBuffer
+
+//! In-memory output stream made of fixed-size segments.
+/*! Unlike GenericStringBuffer, the output is never moved: when a segment is
+    full, the next one is taken from a GenericSegmentPool. The content is read
+    as a list of spans, e.g. to fill the \c iovec array of writev(), or to send
+    it in fragments. Every span but the last one is exactly one segment long,
+    so a segment size equal to the fragment size of the transport gives one
+    span per fragment.
+
+    Clear() returns the segments to the pool. Serializing messages of similar
+    size repeatedly thus needs neither allocation nor copy.
+
+    \code
+    SegmentPool pool(1024);
+    SegmentedBuffer buffer(&pool);
+    Writer<SegmentedBuffer> writer(buffer);
+    d.Accept(writer);
+    for (size_t i = 0; i < buffer.GetSpanCount(); i++)
+        Send(buffer.GetSpans()[i].data, buffer.GetSpans()[i].size);
+    buffer.Clear();
+    \endcode
+
+    \tparam Encoding Encoding of the stream.
+    \tparam BaseAllocator the allocator type of the segment pool.
+    \note implements Stream concept
+*/
+template <typename Encoding, typename BaseAllocator = CrtAllocator>
+class GenericSegmentedBuffer {
+public:
+    typedef typename Encoding::Ch Ch;
+    typedef GenericSegmentPool<BaseAllocator> PoolType;  //!< Segment pool type.
+
+    //! Contiguous part of the content, like \c struct \c iovec.
+    struct Span {
+        const Ch* data; //!< Start of the span.
+        size_t size;    //!< Number of characters.
+    };
+
+    //! Constructor.
+    /*! \param pool Segment pool to use. If null, the buffer creates its own with the default segment size.
+        \param spanCapacity Initial capacity of the span list.
+    */
+    explicit GenericSegmentedBuffer(PoolType* pool = 0, size_t spanCapacity = kDefaultSpanCapacity) :
+        pool_(pool), ownPool_(0), spans_(0, spanCapacity * sizeof(Span)), cur_(0), end_(0), size_(0), segmentCapacity_(0)
+    {
+        if (!pool_)
+            ownPool_ = pool_ = RAPIDJSON_NEW(PoolType());
+        segmentCapacity_ = pool_->GetSegmentSize() / sizeof(Ch);
+        RAPIDJSON_ASSERT(segmentCapacity_ > 0);
+    }
+
+    //! Destructor, returns the segments to the pool.
+    ~GenericSegmentedBuffer() {
+        Clear();
+        RAPIDJSON_DELETE(ownPool_);
+    }
+
+    void Put(Ch c) {
+        if (RAPIDJSON_UNLIKELY(cur_ == end_))
+            NextSegment();
+        *cur_++ = c;
+    }
+
+    void Flush() {}
+
+    //! Appends \c n copies of \c c.
+    void PutN(Ch c, size_t n) {
+        while (n > 0) {
+            if (cur_ == end_)
+                NextSegment();
+            size_t count = Available() < n ? Available() : n;
+            for (Ch* p = cur_; p != cur_ + count; ++p)
+                *p = c;
+            cur_ += count;
+            n -= count;
+        }
+    }
+
+    //! Appends \c n characters.
+    void Write(const Ch* str, size_t n) {
+        while (n > 0) {
+            if (cur_ == end_)
+                NextSegment();
+            size_t count = Available() < n ? Available() : n;
+            std::memcpy(cur_, str, count * sizeof(Ch));
+            cur_ += count;
+            str += count;
+            n -= count;
+        }
+    }
+
+    //! Returns all segments to the pool and empties the buffer.
+    void Clear() {
+        const Span* spans = spans_.template Bottom<Span>();
+        for (size_t i = 0; i < GetSpanCount(); i++)
+            pool_->Release(const_cast<Ch*>(spans[i].data));
+        spans_.Clear();
+        cur_ = end_ = 0;
+        size_ = 0;
+    }
+
+    //! Number of characters written.
+    size_t GetSize() const {
+        return spans_.Empty() ? 0 : size_ + static_cast<size_t>(cur_ - spans_.template Top<Span>()->data);
+    }
+
+    //! Number of spans of the content.
+    size_t GetSpanCount() const { return spans_.GetSize() / sizeof(Span); }
+
+    //! Spans of the content, in order.
+    /*! \return Array of GetSpanCount() spans, valid until the next write or Clear().
+    */
+    const Span* GetSpans() const {
+        if (!spans_.Empty()) {
+            Span* last = spans_.template Top<Span>();
+            last->size = static_cast<size_t>(cur_ - last->data);
+        }
+        return spans_.template Bottom<Span>();
+    }
+
+    //! Copies a part of the content into a contiguous buffer.
+    /*! \param offset Offset of the first character to copy.
+        \param buffer Destination of at least \c count characters.
+        \param count Maximum number of characters to copy.
+        \return Number of characters copied.
+    */
+    size_t CopyTo(size_t offset, Ch* buffer, size_t count) const {
+        const Span* spans = GetSpans();
+        size_t copied = 0;
+        for (size_t i = offset / segmentCapacity_; i < GetSpanCount() && copied < count; i++) {
+            size_t begin = i == offset / segmentCapacity_ ? offset % segmentCapacity_ : 0;
+            if (begin >= spans[i].size)
+                break;
+            size_t n = spans[i].size - begin < count - copied ? spans[i].size - begin : count - copied;
+            std::memcpy(buffer + copied, spans[i].data + begin, n * sizeof(Ch));
+            copied += n;
+        }
+        return copied;
+    }
+
+    //! Segment pool of the buffer.
+    PoolType& GetPool() { return *pool_; }
+
+    static const size_t kDefaultSpanCapacity = 16;
+
+private:
+    GenericSegmentedBuffer(const GenericSegmentedBuffer&);
+    GenericSegmentedBuffer& operator=(const GenericSegmentedBuffer&);
+
+    size_t Available() const { return static_cast<size_t>(end_ - cur_); }
+
+    void NextSegment() {
+        if (!spans_.Empty()) {
+            Span* last = spans_.template Top<Span>();
+            last->size = static_cast<size_t>(cur_ - last->data);
+            size_ += last->size;
+        }
+        Ch* segment = static_cast<Ch*>(pool_->Acquire());
+        Span* span = spans_.template Push<Span>();
+        span->data = segment;
+        span->size = 0;
+        cur_ = segment;
+        end_ = segment + segmentCapacity_;
+    }
+
+    PoolType* pool_;
+    PoolType* ownPool_;
+    mutable internal::Stack<CrtAllocator> spans_;
+    Ch* cur_;
+    Ch* end_;
+    size_t size_;   // characters in all segments but the last one
+    size_t segmentCapacity_;
+};
+
+//! Segmented buffer with UTF8 encoding
+typedef GenericSegmentedBuffer<UTF8<> > SegmentedBuffer;
+
+//! Implement specialized version of PutN() filling whole segments.
+template<typename Encoding, typename BaseAllocator, typename Ch>
+inline void PutN(GenericSegmentedBuffer<Encoding, BaseAllocator>& stream, Ch c, size_t n) {
+    stream.PutN(static_cast<typename Encoding::Ch>(c), n);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#if defined(__clang__)
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_SEGMENTEDBUFFER_H_
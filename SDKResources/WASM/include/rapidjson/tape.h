@@ -0,0 +1,647 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_TAPE_H_
+#define RAPIDJSON_TAPE_H_
+
+/*! \file tape.h
+    \brief Read-only DOM stored as a flat tape of values.
+*/
+
+#include "document.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+//! An entry of the tape of a GenericTapeDocument.
+/*! Every value takes one entry, except strings whose characters follow in the
+    next entries. Objects and arrays are followed by their members (name then
+    value) or elements, and know how many entries to skip to get past them.
+*/
+struct TapeEntry {
+    enum {
+        kTypeMask = 0xff,
+        kIntFlag = 0x100,
+        kUintFlag = 0x200,
+        kInt64Flag = 0x400,
+        kUint64Flag = 0x800,
+        kDoubleFlag = 0x1000
+    };
+
+    uint32_t flags;     //!< Type, and number flags as in GenericValue.
+    SizeType size;      //!< String length, member count or element count.
+    union {
+        int64_t i64;
+        uint64_t u64;
+        double d;
+        uint64_t skip;  //!< Number of entries of an object or array, including its own.
+    } data;
+};
+
+} // namespace internal
+
+template <typename Encoding>
+class GenericTapeValue;
+
+//! Name-value pair of an object on a tape.
+template <typename Encoding>
+struct GenericTapeMember {
+    GenericTapeValue<Encoding> name;     //!< name of member (must be a string)
+    GenericTapeValue<Encoding> value;    //!< value of member.
+};
+
+//! Forward iterator over the members of an object on a tape.
+/*! The iterator only holds the tape position of the member name; the name
+    and value views are resolved when dereferenced, so the end iterator, one
+    past the last member of the tape, is never read.
+*/
+template <typename Encoding>
+class GenericTapeMemberIterator {
+public:
+    typedef GenericTapeMember<Encoding> Member;
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Member value_type;
+    typedef const Member* pointer;
+    typedef const Member& reference;
+    typedef std::ptrdiff_t difference_type;
+
+    GenericTapeMemberIterator() : entry_(), member_() {}
+    explicit GenericTapeMemberIterator(const internal::TapeEntry* name) : entry_(name), member_() {}
+
+    GenericTapeMemberIterator& operator++() { Resolve(); entry_ = member_.value.Next(); return *this; }
+    GenericTapeMemberIterator operator++(int) { GenericTapeMemberIterator old(*this); ++(*this); return old; }
+
+    bool operator==(const GenericTapeMemberIterator& that) const { return entry_ == that.entry_; }
+    bool operator!=(const GenericTapeMemberIterator& that) const { return entry_ != that.entry_; }
+
+    reference operator*() const { Resolve(); return member_; }
+    pointer operator->() const { Resolve(); return &member_; }
+
+private:
+    void Resolve() const {
+        RAPIDJSON_ASSERT(entry_ != 0);
+        if (member_.name.entry_ != entry_) {
+            member_.name.entry_ = entry_;
+            member_.value.entry_ = member_.name.Next();
+        }
+    }
+
+    const internal::TapeEntry* entry_;  //!< Name of the member, on the tape.
+    mutable Member member_;             //!< Views of the member at entry_, once dereferenced.
+};
+
+//! Forward iterator over the elements of an array on a tape.
+template <typename Encoding>
+class GenericTapeValueIterator {
+public:
+    typedef GenericTapeValue<Encoding> ValueType;
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ValueType value_type;
+    typedef const ValueType* pointer;
+    typedef const ValueType& reference;
+    typedef std::ptrdiff_t difference_type;
+
+    GenericTapeValueIterator() : value_() {}
+    explicit GenericTapeValueIterator(const internal::TapeEntry* entry) : value_(entry) {}
+
+    GenericTapeValueIterator& operator++() { value_.entry_ = value_.Next(); return *this; }
+    GenericTapeValueIterator operator++(int) { GenericTapeValueIterator old(*this); ++(*this); return old; }
+
+    bool operator==(const GenericTapeValueIterator& that) const { return value_.entry_ == that.value_.entry_; }
+    bool operator!=(const GenericTapeValueIterator& that) const { return value_.entry_ != that.value_.entry_; }
+
+    reference operator*() const { return value_; }
+    pointer operator->() const { return &value_; }
+
+private:
+    ValueType value_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericTapeValue
+
+//! Read-only view of a value on the tape of a GenericTapeDocument.
+/*!
+    A tape value is a single pointer into the tape, cheap to copy and valid as
+    long as its document is neither destroyed nor parsed again. It offers the
+    query API of GenericValue; nothing is allocated to answer a query.
+
+    Skipping a value, e.g. an unread object while iterating, costs one addition.
+    Looking up a member by name or an element by index walks the preceding
+    siblings: prefer iterating once to many lookups in large objects.
+
+    Use Accept() to materialize a subtree, e.g. into a GenericDocument with
+    GenericDocument::Populate().
+
+    \tparam Encoding Encoding of the strings on the tape.
+*/
+template <typename Encoding>
+class GenericTapeValue {
+public:
+    typedef Encoding EncodingType;                                  //!< Encoding type from template parameter.
+    typedef typename Encoding::Ch Ch;                               //!< Character type derived from Encoding.
+    typedef GenericTapeMember<Encoding> Member;                     //!< Name-value pair in an object.
+    typedef GenericTapeMemberIterator<Encoding> ConstMemberIterator; //!< Member iterator for iterating in object.
+    typedef GenericTapeValueIterator<Encoding> ConstValueIterator;  //!< Value iterator for iterating in array.
+
+    //! Default constructor creates an invalid value, see IsValid().
+    GenericTapeValue() : entry_() {}
+
+    //! Whether the value refers to the tape, i.e. it is not default-constructed nor a missing member.
+    bool IsValid() const { return entry_ != 0; }
+
+    //!@name Type
+    //@{
+
+    Type GetType()  const { return static_cast<Type>(entry_->flags & internal::TapeEntry::kTypeMask); }
+    bool IsNull()   const { return GetType() == kNullType; }
+    bool IsFalse()  const { return GetType() == kFalseType; }
+    bool IsTrue()   const { return GetType() == kTrueType; }
+    bool IsBool()   const { return GetType() == kFalseType || GetType() == kTrueType; }
+    bool IsObject() const { return GetType() == kObjectType; }
+    bool IsArray()  const { return GetType() == kArrayType; }
+    bool IsNumber() const { return GetType() == kNumberType; }
+    bool IsInt()    const { return (entry_->flags & internal::TapeEntry::kIntFlag) != 0; }
+    bool IsUint()   const { return (entry_->flags & internal::TapeEntry::kUintFlag) != 0; }
+    bool IsInt64()  const { return (entry_->flags & internal::TapeEntry::kInt64Flag) != 0; }
+    bool IsUint64() const { return (entry_->flags & internal::TapeEntry::kUint64Flag) != 0; }
+    bool IsDouble() const { return (entry_->flags & internal::TapeEntry::kDoubleFlag) != 0; }
+    bool IsString() const { return GetType() == kStringType; }
+
+    //@}
+
+    //!@name Bool
+    //@{
+
+    bool GetBool() const { RAPIDJSON_ASSERT(IsBool()); return IsTrue(); }
+
+    //@}
+
+    //!@name Number
+    //@{
+
+    int GetInt() const          { RAPIDJSON_ASSERT(IsInt());    return static_cast<int>(entry_->data.i64); }
+    unsigned GetUint() const    { RAPIDJSON_ASSERT(IsUint());   return static_cast<unsigned>(entry_->data.u64); }
+    int64_t GetInt64() const    { RAPIDJSON_ASSERT(IsInt64());  return entry_->data.i64; }
+    uint64_t GetUint64() const  { RAPIDJSON_ASSERT(IsUint64()); return entry_->data.u64; }
+
+    //! Get the value as double type.
+    /*! \note If the value is 64-bit integer type, it may lose precision. Use \c IsLosslessDouble() to check whether the converison is lossless.
+    */
+    double GetDouble() const {
+        RAPIDJSON_ASSERT(IsNumber());
+        if (IsDouble()) return entry_->data.d;
+        if (IsInt64()) return static_cast<double>(entry_->data.i64);
+        return static_cast<double>(entry_->data.u64);
+    }
+
+    //@}
+
+    //!@name String
+    //@{
+
+    //! Get the string, null-terminated. It is stored on the tape, right after its entry.
+    const Ch* GetString() const { RAPIDJSON_ASSERT(IsString()); return reinterpret_cast<const Ch*>(entry_ + 1); }
+
+    //! Get the length of string.
+    SizeType GetStringLength() const { RAPIDJSON_ASSERT(IsString()); return entry_->size; }
+
+    //@}
+
+    //!@name Object
+    //@{
+
+    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); return entry_->size; }
+    bool ObjectEmpty() const { RAPIDJSON_ASSERT(IsObject()); return entry_->size == 0; }
+
+    ConstMemberIterator MemberBegin() const { RAPIDJSON_ASSERT(IsObject()); return ConstMemberIterator(entry_ + 1); }
+    ConstMemberIterator MemberEnd() const { RAPIDJSON_ASSERT(IsObject()); return ConstMemberIterator(Next()); }
+
+    //! Find member by name, in O(n) of the members before it.
+    ConstMemberIterator FindMember(const Ch* name, SizeType length) const {
+        RAPIDJSON_ASSERT(IsObject());
+        ConstMemberIterator end = MemberEnd();
+        for (ConstMemberIterator m = MemberBegin(); m != end; ++m)
+            if (m->name.entry_->size == length && std::memcmp(m->name.GetString(), name, length * sizeof(Ch)) == 0)
+                return m;
+        return end;
+    }
+
+    ConstMemberIterator FindMember(const Ch* name) const { return FindMember(name, internal::StrLen(name)); }
+
+    template <typename SourceAllocator>
+    ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const {
+        RAPIDJSON_ASSERT(name.IsString());
+        return FindMember(name.GetString(), name.GetStringLength());
+    }
+
+    bool HasMember(const Ch* name) const { return FindMember(name) != MemberEnd(); }
+
+    //! Get a value from an object associated with the name.
+    /*! Unlike GenericValue, a missing member is not an error: an invalid value is returned, see IsValid().
+    */
+    template <typename T>
+    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(GenericTapeValue)) operator[](T* name) const {
+        ConstMemberIterator m = FindMember(name);
+        return m != MemberEnd() ? m->value : GenericTapeValue();
+    }
+
+    //@}
+
+    //!@name Array
+    //@{
+
+    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); return entry_->size; }
+    bool Empty() const { RAPIDJSON_ASSERT(IsArray()); return entry_->size == 0; }
+
+    ConstValueIterator Begin() const { RAPIDJSON_ASSERT(IsArray()); return ConstValueIterator(entry_ + 1); }
+    ConstValueIterator End() const { RAPIDJSON_ASSERT(IsArray()); return ConstValueIterator(Next()); }
+
+    //! Get an element from array by index, in O(index).
+    GenericTapeValue operator[](SizeType index) const {
+        RAPIDJSON_ASSERT(IsArray());
+        RAPIDJSON_ASSERT(index < entry_->size);
+        GenericTapeValue v(entry_ + 1);
+        while (index--)
+            v.entry_ = v.Next();
+        return v;
+    }
+
+    //@}
+
+    //! Generate events of this value to a Handler.
+    /*! This function adopts the GoF visitor pattern, see GenericValue::Accept().
+        \param handler An object implementing concept Handler.
+    */
+    template <typename Handler>
+    bool Accept(Handler& handler) const {
+        switch (GetType()) {
+        case kNullType:     return handler.Null();
+        case kFalseType:    return handler.Bool(false);
+        case kTrueType:     return handler.Bool(true);
+
+        case kObjectType:
+            if (RAPIDJSON_UNLIKELY(!handler.StartObject()))
+                return false;
+            for (ConstMemberIterator m = MemberBegin(); m != MemberEnd(); ++m) {
+                if (RAPIDJSON_UNLIKELY(!handler.Key(m->name.GetString(), m->name.GetStringLength(), true)))
+                    return false;
+                if (RAPIDJSON_UNLIKELY(!m->value.Accept(handler)))
+                    return false;
+            }
+            return handler.EndObject(entry_->size);
+
+        case kArrayType:
+            if (RAPIDJSON_UNLIKELY(!handler.StartArray()))
+                return false;
+            for (ConstValueIterator v = Begin(); v != End(); ++v)
+                if (RAPIDJSON_UNLIKELY(!v->Accept(handler)))
+                    return false;
+            return handler.EndArray(entry_->size);
+
+        case kStringType:
+            return handler.String(GetString(), GetStringLength(), true);
+
+        default:
+            RAPIDJSON_ASSERT(GetType() == kNumberType);
+            if (IsDouble())         return handler.Double(entry_->data.d);
+            else if (IsInt())       return handler.Int(static_cast<int>(entry_->data.i64));
+            else if (IsUint())      return handler.Uint(static_cast<unsigned>(entry_->data.u64));
+            else if (IsInt64())     return handler.Int64(entry_->data.i64);
+            else                    return handler.Uint64(entry_->data.u64);
+        }
+    }
+
+    //! Generator functor calling Accept(), to build a GenericDocument with GenericDocument::Populate().
+    template <typename Handler>
+    bool operator()(Handler& handler) const { return Accept(handler); }
+
+    //! Number of tape entries taken by the value, including those of its members or elements.
+    size_t GetEntryCount() const { return static_cast<size_t>(Next() - entry_); }
+
+private:
+    template <typename, typename> friend class GenericTapeDocument;
+    template <typename> friend class GenericTapeMemberIterator;
+    template <typename> friend class GenericTapeValueIterator;
+
+    explicit GenericTapeValue(const internal::TapeEntry* entry) : entry_(entry) {}
+
+    //! Number of entries taken by a string of the given length, including its own.
+    static size_t StringEntryCount(SizeType length) {
+        return 1 + ((length + 1) * sizeof(Ch) + sizeof(internal::TapeEntry) - 1) / sizeof(internal::TapeEntry);
+    }
+
+    //! The entry following this value and its members or elements.
+    const internal::TapeEntry* Next() const {
+        switch (GetType()) {
+        case kObjectType:
+        case kArrayType:    return entry_ + entry_->data.skip;
+        case kStringType:   return entry_ + StringEntryCount(entry_->size);
+        default:            return entry_ + 1;
+        }
+    }
+
+    const internal::TapeEntry* entry_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericTapeDocument
+
+//! A read-only DOM parsed into a single flat buffer.
+/*!
+    GenericDocument creates one GenericValue per value and allocates strings,
+    member and element arrays separately. GenericTapeDocument instead appends
+    every value, in document order, to one contiguous tape: one entry per value,
+    strings inline after their entry, and for each object and array the number
+    of entries to skip it. Reading a few fields of a large document then costs
+    one pass of the parser into one buffer, and the tape is kept across parses.
+
+    Values are accessed as GenericTapeValue views from GetRoot(). The tape
+    cannot be modified; pass a GenericTapeValue to GenericDocument::Populate()
+    to get a modifiable copy of a subtree.
+
+\code
+    TapeDocument d;
+    d.Parse(json);
+    TapeValue engine = d.GetRoot()["engines"][0];
+    double rpm = engine["rpm"].GetDouble();
+\endcode
+
+    \tparam Encoding Encoding for both parsing and string storage.
+    \tparam StackAllocator Allocator for the tape and the parser's stack.
+    \note implements Handler concept
+*/
+template <typename Encoding, typename StackAllocator = CrtAllocator>
+class GenericTapeDocument {
+public:
+    typedef typename Encoding::Ch Ch;                       //!< Character type derived from Encoding.
+    typedef GenericTapeValue<Encoding> ValueType;           //!< Value type of the document.
+    typedef StackAllocator AllocatorType;                   //!< Allocator type from template parameter.
+
+    //! Constructor
+    /*! \param stackAllocator Optional allocator for the tape. If it is null, it will create a private one.
+        \param tapeCapacity Initial capacity of the tape in bytes.
+    */
+    explicit GenericTapeDocument(StackAllocator* stackAllocator = 0, size_t tapeCapacity = kDefaultTapeCapacity) :
+        tape_(stackAllocator, tapeCapacity), open_(kNoContainer), parseResult_() {}
+
+    //! Get the root value. The document must have been parsed successfully.
+    ValueType GetRoot() const {
+        RAPIDJSON_ASSERT(!tape_.Empty() && !HasParseError());
+        return ValueType(tape_.template Bottom<internal::TapeEntry>());
+    }
+
+    //! Number of entries on the tape.
+    size_t GetEntryCount() const { return tape_.GetSize() / sizeof(internal::TapeEntry); }
+
+    //! Get the capacity of the tape in bytes.
+    size_t GetTapeCapacity() const { return tape_.GetCapacity(); }
+
+    //!@name Parse from stream
+    //!@{
+
+    //! Parse JSON text from an input stream (with Encoding conversion)
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam SourceEncoding Encoding of input stream
+        \tparam InputStream Type of input stream, implementing Stream concept
+        \param is Input stream to be parsed.
+        \return The document itself for fluent API.
+    */
+    template <unsigned parseFlags, typename SourceEncoding, typename InputStream>
+    GenericTapeDocument& ParseStream(InputStream& is) {
+        GenericReader<SourceEncoding, Encoding, StackAllocator> reader(
+            tape_.HasAllocator() ? &tape_.GetAllocator() : 0);
+        tape_.Clear();
+        open_ = kNoContainer;
+        parseResult_ = reader.template Parse<parseFlags>(is, *this);
+        if (!parseResult_)
+            tape_.Clear();
+        return *this;
+    }
+
+    template <unsigned parseFlags, typename InputStream>
+    GenericTapeDocument& ParseStream(InputStream& is) {
+        return ParseStream<parseFlags, Encoding, InputStream>(is);
+    }
+
+    template <typename InputStream>
+    GenericTapeDocument& ParseStream(InputStream& is) {
+        return ParseStream<kParseDefaultFlags, Encoding, InputStream>(is);
+    }
+    //!@}
+
+    //!@name Parse from string
+    //!@{
+
+    //! Parse JSON text from a read-only string
+    /*! \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \param str Read-only zero-terminated string to be parsed.
+    */
+    template <unsigned parseFlags>
+    GenericTapeDocument& Parse(const Ch* str) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        GenericStringStream<Encoding> s(str);
+        return ParseStream<parseFlags, Encoding>(s);
+    }
+
+    GenericTapeDocument& Parse(const Ch* str) {
+        return Parse<kParseDefaultFlags>(str);
+    }
+
+    template <unsigned parseFlags>
+    GenericTapeDocument& Parse(const Ch* str, size_t length) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        MemoryStream ms(reinterpret_cast<const char*>(str), length * sizeof(Ch));
+        EncodedInputStream<Encoding, MemoryStream> is(ms);
+        return ParseStream<parseFlags, Encoding>(is);
+    }
+
+    GenericTapeDocument& Parse(const Ch* str, size_t length) {
+        return Parse<kParseDefaultFlags>(str, length);
+    }
+
+#if RAPIDJSON_HAS_STDSTRING
+    template <unsigned parseFlags>
+    GenericTapeDocument& Parse(const std::basic_string<Ch>& str) {
+        return Parse<parseFlags>(str.c_str());
+    }
+
+    GenericTapeDocument& Parse(const std::basic_string<Ch>& str) {
+        return Parse<kParseDefaultFlags>(str);
+    }
+#endif // RAPIDJSON_HAS_STDSTRING
+    //!@}
+
+    //!@name Handling parse errors
+    //!@{
+
+    //! Whether a parse error has occured in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseError() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+    //! Implicit conversion to get the last parse result
+    operator ParseResult() const { return parseResult_; }
+    //!@}
+
+    // Implementation of Handler
+    bool Null() { PushEntry(kNullType); return true; }
+    bool Bool(bool b) { PushEntry(b ? kTrueType : kFalseType); return true; }
+
+    bool Int(int i) {
+        internal::TapeEntry* e = PushEntry(kNumberType | internal::TapeEntry::kIntFlag | internal::TapeEntry::kInt64Flag);
+        e->data.i64 = i;
+        if (i >= 0)
+            e->flags |= internal::TapeEntry::kUintFlag | internal::TapeEntry::kUint64Flag;
+        return true;
+    }
+
+    bool Uint(unsigned u) {
+        internal::TapeEntry* e = PushEntry(kNumberType | internal::TapeEntry::kUintFlag | internal::TapeEntry::kInt64Flag | internal::TapeEntry::kUint64Flag);
+        e->data.u64 = u;
+        if (!(u & 0x80000000))
+            e->flags |= internal::TapeEntry::kIntFlag;
+        return true;
+    }
+
+    bool Int64(int64_t i64) {
+        internal::TapeEntry* e = PushEntry(kNumberType | internal::TapeEntry::kInt64Flag);
+        e->data.i64 = i64;
+        if (i64 >= 0) {
+            e->flags |= internal::TapeEntry::kUint64Flag;
+            if (!(static_cast<uint64_t>(i64) & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x00000000)))
+                e->flags |= internal::TapeEntry::kUintFlag;
+            if (!(static_cast<uint64_t>(i64) & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
+                e->flags |= internal::TapeEntry::kIntFlag;
+        }
+        else if (i64 >= static_cast<int64_t>(RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
+            e->flags |= internal::TapeEntry::kIntFlag;
+        return true;
+    }
+
+    bool Uint64(uint64_t u64) {
+        internal::TapeEntry* e = PushEntry(kNumberType | internal::TapeEntry::kUint64Flag);
+        e->data.u64 = u64;
+        if (!(u64 & RAPIDJSON_UINT64_C2(0x80000000, 0x00000000)))
+            e->flags |= internal::TapeEntry::kInt64Flag;
+        if (!(u64 & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x00000000)))
+            e->flags |= internal::TapeEntry::kUintFlag;
+        if (!(u64 & RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0x80000000)))
+            e->flags |= internal::TapeEntry::kIntFlag;
+        return true;
+    }
+
+    bool Double(double d) {
+        internal::TapeEntry* e = PushEntry(kNumberType | internal::TapeEntry::kDoubleFlag);
+        e->data.d = d;
+        return true;
+    }
+
+    bool RawNumber(const Ch* str, SizeType length, bool copy) { return String(str, length, copy); }
+
+    bool String(const Ch* str, SizeType length, bool) {
+        const size_t count = ValueType::StringEntryCount(length);
+        internal::TapeEntry* e = tape_.template Push<internal::TapeEntry>(count);
+        e->flags = kStringType;
+        e->size = length;
+        e->data.u64 = 0;
+        Ch* s = reinterpret_cast<Ch*>(e + 1);
+        if (length)
+            std::memcpy(s, str, length * sizeof(Ch));
+        std::memset(s + length, 0, (count - 1) * sizeof(internal::TapeEntry) - length * sizeof(Ch));
+        return true;
+    }
+
+    bool StartObject() { return StartContainer(kObjectType); }
+
+    bool Key(const Ch* str, SizeType length, bool copy) { return String(str, length, copy); }
+
+    bool EndObject(SizeType memberCount) { return EndContainer(memberCount); }
+
+    bool StartArray() { return StartContainer(kArrayType); }
+
+    bool EndArray(SizeType elementCount) { return EndContainer(elementCount); }
+
+private:
+    //! Prohibit copying
+    GenericTapeDocument(const GenericTapeDocument&);
+    //! Prohibit assignment
+    GenericTapeDocument& operator=(const GenericTapeDocument&);
+
+    static const size_t kDefaultTapeCapacity = 1024 * sizeof(internal::TapeEntry);
+    static const uint64_t kNoContainer = ~static_cast<uint64_t>(0);
+
+    internal::TapeEntry* PushEntry(unsigned flags) {
+        internal::TapeEntry* e = tape_.template Push<internal::TapeEntry>();
+        e->flags = flags;
+        e->size = 0;
+        return e;
+    }
+
+    // While a container is open, its skip field links to the enclosing open container.
+    bool StartContainer(Type type) {
+        internal::TapeEntry* e = PushEntry(type);
+        e->data.u64 = open_;
+        open_ = GetEntryCount() - 1;
+        return true;
+    }
+
+    bool EndContainer(SizeType count) {
+        RAPIDJSON_ASSERT(open_ != kNoContainer);
+        internal::TapeEntry* e = tape_.template Bottom<internal::TapeEntry>() + open_;
+        const uint64_t parent = e->data.u64;
+        e->size = count;
+        e->data.skip = GetEntryCount() - open_;
+        open_ = parent;
+        return true;
+    }
+
+    internal::Stack<StackAllocator> tape_;
+    uint64_t open_;             //!< Index of the innermost open object or array, kNoContainer at root.
+    ParseResult parseResult_;
+};
+
+//! GenericTapeDocument with UTF8 encoding
+typedef GenericTapeDocument<UTF8<> > TapeDocument;
+
+//! GenericTapeValue with UTF8 encoding
+typedef GenericTapeValue<UTF8<> > TapeValue;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_TAPE_H_
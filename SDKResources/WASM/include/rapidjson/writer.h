@@ -31,6 +31,8 @@
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
+#elif defined(RAPIDJSON_WASM_SIMD128)
+#include <wasm_simd128.h>
 #endif
 
 #ifdef _MSC_VER
@@ -139,7 +141,7 @@ public:
         return maxDecimalPlaces_;
     }
 
-    //! Sets the maximum number of decimal places for double output.
+    //! Sets the maximum number of decimal places for double and float output.
     /*!
         This setting truncates the output with specified number of decimal places.
 
@@ -183,6 +185,15 @@ public:
     */
     bool Double(double d)       { Prefix(kNumberType); return EndValue(WriteDouble(d)); }
 
+    //! Writes the given \c float value to the stream
+    /*!
+        Writes the shortest decimal which reads back as the same single precision value,
+        e.g. 0.3f is written as 0.3 whereas Double(0.3f) writes 0.30000001192092896.
+        \param f The value to be written.
+        \return Whether it is succeed.
+    */
+    bool Float(float f)         { Prefix(kNumberType); return EndValue(WriteFloat(f)); }
+
     bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
         (void)copy;
         Prefix(kNumberType);
@@ -342,6 +353,18 @@ protected:
         return true;
     }
 
+    bool WriteFloat(float f) {
+        if (internal::Double(static_cast<double>(f)).IsNanOrInf())
+            return WriteDouble(static_cast<double>(f));
+
+        char buffer[25];
+        char* end = internal::ftoa(f, buffer, maxDecimalPlaces_);
+        PutReserve(*os_, static_cast<size_t>(end - buffer));
+        for (char* p = buffer; p != end; ++p)
+            PutUnsafe(*os_, static_cast<typename TargetEncoding::Ch>(*p));
+        return true;
+    }
+
     bool WriteString(const Ch* str, SizeType length)  {
         static const typename TargetEncoding::Ch hexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
         static const char escape[256] = {
@@ -534,6 +557,17 @@ inline bool Writer<StringBuffer>::WriteDouble(double d) {
     return true;
 }
 
+template<>
+inline bool Writer<StringBuffer>::WriteFloat(float f) {
+    if (internal::Double(static_cast<double>(f)).IsNanOrInf())
+        return WriteDouble(static_cast<double>(f));
+
+    char *buffer = os_->Push(25);
+    char* end = internal::ftoa(f, buffer, maxDecimalPlaces_);
+    os_->Pop(static_cast<size_t>(25 - (end - buffer)));
+    return true;
+}
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
 template<>
 inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
@@ -595,7 +629,98 @@ inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, siz
     is.src_ = p;
     return RAPIDJSON_LIKELY(is.Tell() < length);
 }
-#endif // defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#elif defined(RAPIDJSON_WASM_SIMD128)
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    if (length < 16)
+        return RAPIDJSON_LIKELY(is.Tell() < length);
+
+    if (!RAPIDJSON_LIKELY(is.Tell() < length))
+        return false;
+
+    const char* p = is.src_;
+    const char* end = is.head_ + length;
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    const char* endAligned = reinterpret_cast<const char*>(reinterpret_cast<size_t>(end) & static_cast<size_t>(~15));
+    if (nextAligned > end)
+        return true;
+
+    while (p != nextAligned)
+        if (static_cast<unsigned char>(*p) < 0x20 || *p == '\"' || *p == '\\'
+            || ((kWriteDefaultFlags & kWriteValidateEncodingFlag) && static_cast<unsigned char>(*p) >= 0x80)) {
+            is.src_ = p;
+            return RAPIDJSON_LIKELY(is.Tell() < length);
+        }
+        else
+            os_->PutUnsafe(*p++);
+
+    // The rest of string using SIMD
+    const v128_t dq = wasm_i8x16_splat('\"');
+    const v128_t bs = wasm_i8x16_splat('\\');
+    const v128_t sp = wasm_i8x16_splat(0x20);
+
+    for (; p != endAligned; p += 16) {
+        const v128_t s = wasm_v128_load(p);
+        v128_t x = wasm_v128_or(wasm_v128_or(wasm_i8x16_eq(s, dq), wasm_i8x16_eq(s, bs)), wasm_u8x16_lt(s, sp));
+        if (kWriteDefaultFlags & kWriteValidateEncodingFlag)
+            x = wasm_v128_or(x, s); // leave non-ASCII bytes to the validating transcoder
+        const uint32_t r = wasm_i8x16_bitmask(x);
+        if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+            const SizeType len = static_cast<SizeType>(__builtin_ctz(r));
+            std::memcpy(os_->PushUnsafe(len), p, len);
+            p += len;
+            break;
+        }
+        wasm_v128_store(os_->PushUnsafe(16), s);
+    }
+
+    is.src_ = p;
+    return RAPIDJSON_LIKELY(is.Tell() < length);
+}
+#else
+//! Word-at-a-time (SWAR) scan of unescaped characters when no SIMD extension is enabled.
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    if (length < 8)
+        return RAPIDJSON_LIKELY(is.Tell() < length);
+
+    if (!RAPIDJSON_LIKELY(is.Tell() < length))
+        return false;
+
+    static const uint64_t kOnes = RAPIDJSON_UINT64_C2(0x01010101, 0x01010101);
+    static const uint64_t kHighs = RAPIDJSON_UINT64_C2(0x80808080, 0x80808080);
+    const uint64_t dq = kOnes * static_cast<unsigned char>('\"');
+    const uint64_t bs = kOnes * static_cast<unsigned char>('\\');
+    const uint64_t sp = kOnes * 0x20u;
+
+    const char* p = is.src_;
+    const char* end = is.head_ + length;
+
+    // A byte is flagged when it is '"', '\\' or below 0x20. Borrows only spill
+    // over from a flagged byte, so a word without such bytes is never flagged.
+    while (end - p >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        const uint64_t q = w ^ dq;
+        const uint64_t b = w ^ bs;
+        uint64_t x = ((q - kOnes) & ~q) | ((b - kOnes) & ~b) | ((w - sp) & ~w);
+        if (kWriteDefaultFlags & kWriteValidateEncodingFlag)
+            x |= w; // leave non-ASCII bytes to the validating transcoder
+        if (RAPIDJSON_UNLIKELY(x & kHighs))
+            break;
+        std::memcpy(os_->PushUnsafe(8), p, 8);
+        p += 8;
+    }
+
+    // Finish the run (at most 7 characters before the escaped one or the end)
+    while (p != end && static_cast<unsigned char>(*p) >= 0x20 && *p != '\"' && *p != '\\'
+        && !((kWriteDefaultFlags & kWriteValidateEncodingFlag) && static_cast<unsigned char>(*p) >= 0x80))
+        os_->PutUnsafe(*p++);
+
+    is.src_ = p;
+    return RAPIDJSON_LIKELY(is.Tell() < length);
+}
+#endif // RAPIDJSON_SSE2 || RAPIDJSON_SSE42 || RAPIDJSON_WASM_SIMD128
 
 RAPIDJSON_NAMESPACE_END
 
@@ -0,0 +1,957 @@
+// Payload-driven benchmark for the vendored rapidjson headers.
+//
+// Measures DOM, SAX, in-situ and iterative parsing, whitespace and string
+// scanning of pretty-printed input, Writer and PrettyWriter
+// output, string escaping, float output, full-precision strtod, number parsing, GenericPointer and member lookup, schema validation and MessagePack
+// encoding and decoding over a synthetic corpus
+// shaped like the sync traffic: full SimStateSnapshot states, SimDiffEngine
+// change sets and SimCommandMessage batches, each at 100, 1,000 and 10,000
+// fields. The corpus is generated from a fixed seed so results of different
+// revisions are comparable.
+//
+// Build (native):
+//   c++ -std=c++11 -O2 -DNDEBUG -I SDKResources/WASM/include
+//       Tools/RapidJsonBench/rapidjsonbench.cpp -o rapidjsonbench
+//   (add -msse4.2 -DRAPIDJSON_SSE42 to measure the SIMD scanners,
+//    -DRAPIDJSON_MEMBER_INDEX_THRESHOLD=0 to measure member lookup without the index)
+//
+// Build (WASM, SDK clang, run under any WASI runtime):
+//   clang++ --target=wasm32-wasi -std=c++11 -O2 -DNDEBUG -msimd128
+//       -I SDKResources/WASM/include Tools/RapidJsonBench/rapidjsonbench.cpp
+//       -o rapidjsonbench.wasm
+//
+// Usage:
+//   rapidjsonbench [--filter substr] [--min-time ms] [--repeat n]
+//                  [--out results.json] [--label text]
+//                  [--baseline old.json] [--threshold percent]
+//                  [--dump-corpus dir]
+//
+// Results are written as one JSON document (stdout unless --out is given):
+//   { "label", "rapidjson", "compiler", "simd", "minTimeMs", "repeat",
+//     "results": [ { "name", "payload", "fields", "bytes", "iterations",
+//                    "minNs", "medianNs", "meanNs", "mbPerSec" } ] }
+// Benchmarks which run a number of operations rather than process the
+// payload, e.g. pointer lookups, report "ops" per call and "opsPerSec"
+// instead of "mbPerSec".
+// With --baseline, the median of every benchmark is compared against the
+// entry of the same name in a previous result file. The process exits with
+// status 2 if any benchmark is slower than the baseline by more than
+// --threshold percent (default 10).
+
+#include "rapidjson/document.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/pointer.h"
+#include "rapidjson/schema.h"
+#include "rapidjson/filewritestream.h"
+#include "rapidjson/msgpack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+///////////////////////////////////////////////////////////////////////////////
+// Corpus
+
+namespace {
+
+// SimVar names as they appear in SimDataDefinition; indexed variants
+// ("GENERAL ENG RPM:2") are derived to reach the larger field counts.
+const char* const kSimVarNames[] = {
+    "PLANE ALTITUDE", "PLANE LATITUDE", "PLANE LONGITUDE", "PLANE HEADING DEGREES TRUE",
+    "PLANE HEADING DEGREES MAGNETIC", "PLANE PITCH DEGREES", "PLANE BANK DEGREES",
+    "AIRSPEED INDICATED", "AIRSPEED TRUE", "VERTICAL SPEED", "GROUND VELOCITY",
+    "GENERAL ENG RPM", "GENERAL ENG THROTTLE LEVER POSITION", "GENERAL ENG MIXTURE LEVER POSITION",
+    "GENERAL ENG PROPELLER LEVER POSITION", "ENG OIL TEMPERATURE", "ENG OIL PRESSURE",
+    "ENG EXHAUST GAS TEMPERATURE", "FUEL TANK LEFT MAIN QUANTITY", "FUEL TANK RIGHT MAIN QUANTITY",
+    "FUEL TOTAL QUANTITY", "ELECTRICAL MASTER BATTERY", "GENERAL ENG MASTER ALTERNATOR",
+    "AVIONICS MASTER SWITCH", "LIGHT LANDING", "LIGHT TAXI", "LIGHT BEACON", "LIGHT NAV",
+    "LIGHT STROBE", "LIGHT PANEL", "AUTOPILOT MASTER", "AUTOPILOT HEADING LOCK DIR",
+    "AUTOPILOT ALTITUDE LOCK VAR", "AUTOPILOT VERTICAL HOLD VAR", "AUTOPILOT AIRSPEED HOLD VAR",
+    "FLAPS HANDLE INDEX", "GEAR HANDLE POSITION", "BRAKE PARKING POSITION", "SPOILERS HANDLE POSITION",
+    "ELEVATOR TRIM POSITION", "RUDDER TRIM PCT", "AILERON TRIM PCT", "KOHLSMAN SETTING MB",
+    "NAV ACTIVE FREQUENCY", "NAV STANDBY FREQUENCY", "COM ACTIVE FREQUENCY", "COM STANDBY FREQUENCY",
+    "TRANSPONDER CODE", "PITOT HEAT", "STRUCTURAL DEICE SWITCH", "CABIN SEATBELTS ALERT SWITCH",
+    "SIM ON GROUND", "TITLE", "ATC ID"
+};
+
+const char* const kSimEventNames[] = {
+    "K:TOGGLE_MASTER_BATTERY", "K:TOGGLE_AVIONICS_MASTER", "K:LANDING_LIGHTS_TOGGLE",
+    "K:TOGGLE_BEACON_LIGHTS", "K:TOGGLE_NAV_LIGHTS", "K:STROBES_TOGGLE", "K:AP_MASTER",
+    "K:HEADING_BUG_SET", "K:AP_ALT_VAR_SET_ENGLISH", "K:AP_VS_VAR_SET_ENGLISH", "K:FLAPS_INCR",
+    "K:FLAPS_DECR", "K:GEAR_TOGGLE", "K:PARKING_BRAKES", "K:THROTTLE_SET", "K:MIXTURE_SET",
+    "K:PROP_PITCH_SET", "K:KOHLSMAN_SET", "K:COM_RADIO_SET_HZ", "K:NAV1_RADIO_SET_HZ",
+    "K:XPNDR_SET", "K:PITOT_HEAT_TOGGLE", "K:ELEV_TRIM_UP", "K:ELEV_TRIM_DN"
+};
+
+const size_t kSimVarNameCount = sizeof(kSimVarNames) / sizeof(kSimVarNames[0]);
+const size_t kSimEventNameCount = sizeof(kSimEventNames) / sizeof(kSimEventNames[0]);
+
+// Deterministic generator (64-bit LCG), so every run sees the same corpus.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+    uint32_t Next() { state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL; return static_cast<uint32_t>(state_ >> 33); }
+    uint32_t Next(uint32_t n) { return Next() % n; }
+    double NextDouble(double lo, double hi) { return lo + (hi - lo) * (Next() / 2147483648.0); }
+
+private:
+    uint64_t state_;
+};
+
+std::string FieldName(size_t i) {
+    std::string name(kSimVarNames[i % kSimVarNameCount]);
+    size_t index = i / kSimVarNameCount;
+    if (index > 0) {
+        char buffer[16];
+        std::sprintf(buffer, ":%u", static_cast<unsigned>(index));
+        name += buffer;
+    }
+    return name;
+}
+
+template <typename Handler>
+void WriteFieldValue(Handler& writer, size_t i, Random& random) {
+    // Mix mirrors the catalog: mostly floating point, then switches/indices,
+    // then a few strings and unset values.
+    switch (random.Next(16)) {
+    case 0: case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8:
+        writer.Double(random.NextDouble(-20000.0, 45000.0));
+        break;
+    case 9: case 10:
+        writer.Bool(random.Next(2) != 0);
+        break;
+    case 11: case 12:
+        writer.Int(static_cast<int>(random.Next(10000)));
+        break;
+    case 13: case 14: {
+        char buffer[32];
+        int length = std::sprintf(buffer, "Asobo C172 %04u", static_cast<unsigned>(i % 10000));
+        writer.String(buffer, static_cast<SizeType>(length));
+        break;
+    }
+    default:
+        writer.Null();
+        break;
+    }
+}
+
+void WriteGuid(Writer<StringBuffer>& writer, Random& random) {
+    char buffer[40];
+    std::sprintf(buffer, "%08x-%04x-%04x-%04x-%04x%08x", random.Next(), random.Next(0x10000), random.Next(0x10000),
+                 random.Next(0x10000), random.Next(0x10000), random.Next());
+    writer.String(buffer);
+}
+
+// SnapshotMessage with full = true.
+std::string MakeFullState(size_t fields, Random& random) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartObject();
+    writer.Key("type"); writer.String("snapshot");
+    writer.Key("originId"); WriteGuid(writer, random);
+    writer.Key("full"); writer.Bool(true);
+    writer.Key("serverTime"); writer.Int64(1760000000000LL + random.Next(100000));
+    writer.Key("state");
+    writer.StartObject();
+    for (size_t i = 0; i < fields; i++) {
+        writer.Key(FieldName(i).c_str());
+        WriteFieldValue(writer, i, random);
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+// SimDiffEngine change set: { "src", "changes": { name: value|null } }.
+std::string MakeDiff(size_t fields, Random& random) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartObject();
+    writer.Key("src"); writer.String("host");
+    writer.Key("changes");
+    writer.StartObject();
+    for (size_t i = 0; i < fields; i++) {
+        writer.Key(FieldName(i).c_str());
+        WriteFieldValue(writer, i, random);
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+// Batch of SimCommandMessage, six fields each.
+std::string MakeCommands(size_t fields, Random& random) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartObject();
+    writer.Key("type"); writer.String("commands");
+    writer.Key("commands");
+    writer.StartArray();
+    for (size_t i = 0; i < (fields + 5) / 6; i++) {
+        writer.StartObject();
+        writer.Key("Command"); writer.String(kSimEventNames[random.Next(static_cast<uint32_t>(kSimEventNameCount))]);
+        writer.Key("Value");
+        if (random.Next(2)) writer.Int(static_cast<int>(random.Next(100000))); else writer.Double(random.NextDouble(0.0, 1.0));
+        writer.Key("Target");
+        if (random.Next(4) == 0) writer.String("copilot"); else writer.Null();
+        writer.Key("OriginId"); WriteGuid(writer, random);
+        writer.Key("Sequence"); writer.Int64(static_cast<int64_t>(i) + 1);
+        writer.Key("ServerTime"); writer.Double(1760000000.0 + i * 0.016);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+const char kFullStateSchema[] =
+    "{\"type\":\"object\",\"required\":[\"type\",\"originId\",\"full\",\"state\"],"
+    "\"properties\":{\"type\":{\"enum\":[\"snapshot\"]},\"originId\":{\"type\":\"string\"},"
+    "\"full\":{\"type\":\"boolean\"},\"serverTime\":{\"type\":\"integer\"},"
+    "\"state\":{\"type\":\"object\",\"additionalProperties\":false,"
+    "\"patternProperties\":{\"^[A-Z][A-Z0-9 _]*(:[0-9]+)?$\":{\"type\":[\"number\",\"boolean\",\"string\",\"null\"]}}}}}";
+
+const char kDiffSchema[] =
+    "{\"type\":\"object\",\"required\":[\"src\",\"changes\"],"
+    "\"properties\":{\"src\":{\"type\":\"string\"},"
+    "\"changes\":{\"type\":\"object\",\"minProperties\":1,\"additionalProperties\":false,"
+    "\"patternProperties\":{\"^[A-Z][A-Z0-9 _]*(:[0-9]+)?$\":{\"type\":[\"number\",\"boolean\",\"string\",\"null\"]}}}}}";
+
+const char kCommandsSchema[] =
+    "{\"type\":\"object\",\"required\":[\"type\",\"commands\"],"
+    "\"properties\":{\"type\":{\"enum\":[\"commands\"]},"
+    "\"commands\":{\"type\":\"array\",\"items\":{\"type\":\"object\",\"required\":[\"Command\",\"OriginId\",\"Sequence\"],"
+    "\"properties\":{\"Command\":{\"type\":\"string\",\"pattern\":\"^K:[A-Z0-9_]+$\"},"
+    "\"Value\":{\"type\":[\"number\",\"string\",\"boolean\",\"null\"]},\"Target\":{\"type\":[\"string\",\"null\"]},"
+    "\"OriginId\":{\"type\":\"string\",\"minLength\":36,\"maxLength\":36},"
+    "\"Sequence\":{\"type\":\"integer\",\"minimum\":0},\"ServerTime\":{\"type\":\"number\"}}}}}}";
+
+struct Payload {
+    std::string name;       // e.g. "full_1000"
+    size_t fields;
+    std::string json;
+    const char* schema;
+    std::vector<std::string> pointers;  // JSON pointers looked up by the pointer benchmark
+    std::string object;                 // JSON pointer to the largest object, searched by the member benchmark
+    std::vector<std::string> members;   // names looked up in it
+};
+
+// Finds the object with the most members.
+void FindLargestObject(const Value& value, const std::string& prefix, std::string& path, SizeType& count) {
+    if (value.IsObject()) {
+        if (value.MemberCount() > count) {
+            count = value.MemberCount();
+            path = prefix;
+        }
+        for (Value::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m)
+            FindLargestObject(m->value, prefix + "/" + std::string(m->name.GetString(), m->name.GetStringLength()), path, count);
+    }
+    else if (value.IsArray()) {
+        for (SizeType i = 0; i < value.Size(); i++) {
+            char buffer[16];
+            std::sprintf(buffer, "/%u", static_cast<unsigned>(i));
+            FindLargestObject(value[i], prefix + buffer, path, count);
+        }
+    }
+}
+
+// Collects up to \c count pointers spread evenly over the leaves of the document.
+void CollectPointers(const Value& value, const std::string& prefix, std::vector<std::string>& all) {
+    if (value.IsObject()) {
+        for (Value::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m) {
+            std::string token(m->name.GetString(), m->name.GetStringLength());
+            std::string escaped;
+            for (size_t i = 0; i < token.size(); i++) {
+                if (token[i] == '~') escaped += "~0";
+                else if (token[i] == '/') escaped += "~1";
+                else escaped += token[i];
+            }
+            CollectPointers(m->value, prefix + "/" + escaped, all);
+        }
+    }
+    else if (value.IsArray()) {
+        for (SizeType i = 0; i < value.Size(); i++) {
+            char buffer[16];
+            std::sprintf(buffer, "/%u", static_cast<unsigned>(i));
+            CollectPointers(value[i], prefix + buffer, all);
+        }
+    }
+    else
+        all.push_back(prefix);
+}
+
+std::vector<Payload> MakeCorpus() {
+    static const size_t kFieldCounts[] = { 100, 1000, 10000 };
+    std::vector<Payload> corpus;
+    Random random(0x5eed5eedULL);
+    for (size_t k = 0; k < 3; k++) {
+        size_t fields = kFieldCounts[k];
+        for (int shape = 0; shape < 3; shape++) {
+            Payload p;
+            char name[32];
+            static const char* const kShapes[] = { "full", "diff", "commands" };
+            std::sprintf(name, "%s_%u", kShapes[shape], static_cast<unsigned>(fields));
+            p.name = name;
+            p.fields = fields;
+            p.json = shape == 0 ? MakeFullState(fields, random) : shape == 1 ? MakeDiff(fields, random) : MakeCommands(fields, random);
+            p.schema = shape == 0 ? kFullStateSchema : shape == 1 ? kDiffSchema : kCommandsSchema;
+
+            Document d;
+            d.Parse(p.json.c_str(), p.json.size());
+            std::vector<std::string> all;
+            CollectPointers(d, std::string(), all);
+            const size_t kPointerCount = 64;
+            for (size_t i = 0; i < kPointerCount && !all.empty(); i++)
+                p.pointers.push_back(all[(i * all.size()) / kPointerCount]);
+
+            // Member names of the corpus have no '~' or '/' to escape.
+            SizeType count = 0;
+            FindLargestObject(d, std::string(), p.object, count);
+            const Value& object = *Pointer(p.object.c_str()).Get(d);
+            const size_t kMemberCount = 64;
+            for (size_t i = 0; i < kMemberCount && i < object.MemberCount(); i++) {
+                const Value& name = object.MemberBegin()[(i * object.MemberCount()) / std::min<size_t>(kMemberCount, object.MemberCount())].name;
+                p.members.push_back(std::string(name.GetString(), name.GetStringLength()));
+            }
+            corpus.push_back(p);
+        }
+    }
+    return corpus;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timing
+
+typedef std::chrono::steady_clock Clock;
+
+volatile size_t g_sink;  // Keeps results observable so the optimizer cannot drop the work.
+
+struct Options {
+    Options() : filter(), minTimeMs(200), repeat(5), out(), label(), baseline(), threshold(10.0), dumpCorpus() {}
+    std::string filter;
+    unsigned minTimeMs;
+    unsigned repeat;
+    std::string out;
+    std::string label;
+    std::string baseline;
+    double threshold;
+    std::string dumpCorpus;
+};
+
+struct Result {
+    std::string name;
+    std::string payload;
+    size_t fields;
+    size_t bytes;
+    size_t ops;         // Operations per call, 0 when the call processes the payload.
+    uint64_t iterations;
+    double minNs;
+    double medianNs;
+    double meanNs;
+};
+
+// Calibrates an iteration count that runs for at least options.minTimeMs / repeat,
+// then times \c repeat batches of that many calls.
+template <typename Fn>
+Result Measure(const Options& options, Fn fn) {
+    uint64_t iterations = 1;
+    const double target = options.minTimeMs * 1e6 / options.repeat;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            g_sink = g_sink + fn();
+        double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        if (elapsed >= target || iterations >= (1ULL << 40))
+            break;
+        uint64_t next = elapsed > 0 ? static_cast<uint64_t>(iterations * (target / elapsed) * 1.2) : iterations * 10;
+        iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+    }
+
+    std::vector<double> samples;
+    for (unsigned r = 0; r < options.repeat; r++) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            g_sink = g_sink + fn();
+        samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.fields = 0;
+    result.bytes = 0;
+    result.ops = 0;
+    result.iterations = iterations;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    double sum = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    result.meanNs = sum / samples.size();
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+struct CountingHandler : BaseReaderHandler<UTF8<>, CountingHandler> {
+    CountingHandler() : count() {}
+    bool Default() { count++; return true; }
+    size_t count;
+};
+
+// Collects the names and string values of a document.
+void CollectStrings(const Value& value, std::vector<std::string>& all) {
+    if (value.IsObject()) {
+        for (Value::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m) {
+            all.push_back(std::string(m->name.GetString(), m->name.GetStringLength()));
+            CollectStrings(m->value, all);
+        }
+    }
+    else if (value.IsArray()) {
+        for (SizeType i = 0; i < value.Size(); i++)
+            CollectStrings(value[i], all);
+    }
+    else if (value.IsString())
+        all.push_back(std::string(value.GetString(), value.GetStringLength()));
+}
+
+// Collects the floating point values of a document.
+void CollectDoubles(const Value& value, std::vector<double>& all) {
+    if (value.IsObject()) {
+        for (Value::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m)
+            CollectDoubles(m->value, all);
+    }
+    else if (value.IsArray()) {
+        for (SizeType i = 0; i < value.Size(); i++)
+            CollectDoubles(value[i], all);
+    }
+    else if (value.IsDouble())
+        all.push_back(value.GetDouble());
+}
+
+// Writes values as one JSON array, with Writer's shortest round-trip output.
+std::string MakeDoubleArray(const std::vector<double>& values) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    for (size_t i = 0; i < values.size(); i++)
+        writer.Double(values[i]);
+    writer.EndArray();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+// Writes the numbers of a document, integers and floating point, into one array.
+size_t WriteNumbers(const Value& value, Writer<StringBuffer>& writer) {
+    size_t count = 0;
+    if (value.IsObject()) {
+        for (Value::ConstMemberIterator m = value.MemberBegin(); m != value.MemberEnd(); ++m)
+            count += WriteNumbers(m->value, writer);
+    }
+    else if (value.IsArray()) {
+        for (SizeType i = 0; i < value.Size(); i++)
+            count += WriteNumbers(value[i], writer);
+    }
+    else if (value.IsNumber()) {
+        value.Accept(writer);
+        count++;
+    }
+    return count;
+}
+
+// Writes strings as one array. Writer<StringBuffer> scans unescaped runs in bulk
+// (SSE, SIMD128 or SWAR); other Writer types, e.g. with other flags, write them
+// character by character.
+template <typename WriterType>
+size_t WriteStrings(const std::vector<std::string>& strings) {
+    StringBuffer sb;
+    WriterType writer(sb);
+    writer.StartArray();
+    for (size_t i = 0; i < strings.size(); i++)
+        writer.String(strings[i].c_str(), static_cast<SizeType>(strings[i].size()));
+    writer.EndArray();
+    return sb.GetSize();
+}
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options_(options) {}
+
+    void Run(const Payload& p) {
+        const char* json = p.json.c_str();
+        const size_t length = p.json.size();
+        std::vector<char> insitu(length + 1);
+
+        Bench(p, "parse_dom", [&]() -> size_t {
+            Document d;
+            d.Parse(json, length);
+            return d.HasParseError() ? 0 : d.MemberCount();
+        });
+
+        Bench(p, "parse_sax", [&]() -> size_t {
+            Reader reader;
+            CountingHandler handler;
+            StringStream s(json);
+            reader.Parse(s, handler);
+            return handler.count;
+        });
+
+        // Includes the copy into the mutable buffer, as every real in-situ
+        // caller has to pay it once per message.
+        Bench(p, "parse_insitu", [&]() -> size_t {
+            std::memcpy(&insitu[0], json, length + 1);
+            Document d;
+            d.ParseInsitu(&insitu[0]);
+            return d.HasParseError() ? 0 : d.MemberCount();
+        });
+
+        Bench(p, "parse_iterative", [&]() -> size_t {
+            Document d;
+            d.Parse<kParseIterativeFlag>(json, length);
+            return d.HasParseError() ? 0 : d.MemberCount();
+        });
+
+        Document doc;
+        doc.Parse(json, length);
+
+        // Indented input, so that most of the text goes through the SIMD scanners
+        // (SkipWhitespace_SIMD and the unescaped string scans) rather than the tokenizer.
+        StringBuffer pretty;
+        {
+            PrettyWriter<StringBuffer> writer(pretty);
+            doc.Accept(writer);
+        }
+        std::vector<char> prettyInsitu(pretty.GetSize() + 1);
+        BenchBytes(p, "scan_pretty_sax", pretty.GetSize(), [&]() -> size_t {
+            Reader reader;
+            CountingHandler handler;
+            StringStream s(pretty.GetString());
+            reader.Parse(s, handler);
+            return handler.count;
+        });
+
+        BenchBytes(p, "scan_pretty_insitu", pretty.GetSize(), [&]() -> size_t {
+            std::memcpy(&prettyInsitu[0], pretty.GetString(), pretty.GetSize() + 1);
+            Reader reader;
+            CountingHandler handler;
+            InsituStringStream s(&prettyInsitu[0]);
+            reader.Parse<kParseInsituFlag>(s, handler);
+            return handler.count;
+        });
+
+        Bench(p, "write", [&]() -> size_t {
+            StringBuffer sb;
+            Writer<StringBuffer> writer(sb);
+            doc.Accept(writer);
+            return sb.GetSize();
+        });
+
+        Bench(p, "write_pretty", [&]() -> size_t {
+            StringBuffer sb;
+            PrettyWriter<StringBuffer> writer(sb);
+            doc.Accept(writer);
+            return sb.GetSize();
+        });
+
+        std::vector<std::string> strings;
+        CollectStrings(doc, strings);
+        size_t stringBytes = 0;
+        for (size_t i = 0; i < strings.size(); i++)
+            stringBytes += strings[i].size();
+        BenchBytes(p, "write_strings", stringBytes, [&]() -> size_t {
+            return WriteStrings<Writer<StringBuffer> >(strings);
+        });
+
+        BenchBytes(p, "write_strings_generic", stringBytes, [&]() -> size_t {
+            return WriteStrings<Writer<StringBuffer, UTF8<>, UTF8<>, CrtAllocator, kWriteNanAndInfFlag> >(strings);
+        });
+
+        // The doubles of the payload narrowed to float, as the sim vars are sent: shortest
+        // float32 output against the same values promoted to double.
+        std::vector<double> doubles;
+        CollectDoubles(doc, doubles);
+        std::vector<float> floats(doubles.begin(), doubles.end());
+        if (!floats.empty()) {
+            Bench(p, "write_float", floats.size(), [&]() -> size_t {
+                StringBuffer sb;
+                Writer<StringBuffer> writer(sb);
+                writer.StartArray();
+                for (size_t i = 0; i < floats.size(); i++)
+                    writer.Float(floats[i]);
+                writer.EndArray();
+                return sb.GetSize();
+            });
+
+            Bench(p, "write_float_as_double", floats.size(), [&]() -> size_t {
+                StringBuffer sb;
+                Writer<StringBuffer> writer(sb);
+                writer.StartArray();
+                for (size_t i = 0; i < floats.size(); i++)
+                    writer.Double(static_cast<double>(floats[i]));
+                writer.EndArray();
+                return sb.GetSize();
+            });
+        }
+
+        // The doubles of the payload, mostly 16 and 17 significant digits, parsed exactly
+        // (StrtodFullPrecision) and with the default fast path.
+        if (!doubles.empty()) {
+            const std::string numbers = MakeDoubleArray(doubles);
+            Bench(p, "strtod_full_precision", doubles.size(), [&]() -> size_t {
+                Reader reader;
+                CountingHandler handler;
+                StringStream s(numbers.c_str());
+                reader.Parse<kParseFullPrecisionFlag>(s, handler);
+                return handler.count;
+            });
+
+            Bench(p, "strtod_normal_precision", doubles.size(), [&]() -> size_t {
+                Reader reader;
+                CountingHandler handler;
+                StringStream s(numbers.c_str());
+                reader.Parse(s, handler);
+                return handler.count;
+            });
+        }
+
+        // Every number of the payload. Parse(str, length) reads from a MemoryStream and takes
+        // runs of digits at once; a null-terminated StringStream takes them one by one.
+        StringBuffer numberBuffer;
+        Writer<StringBuffer> numberWriter(numberBuffer);
+        numberWriter.StartArray();
+        const size_t numberCount = WriteNumbers(doc, numberWriter);
+        numberWriter.EndArray();
+        if (numberCount != 0) {
+            Bench(p, "number_parse", numberCount, [&]() -> size_t {
+                Document d;
+                d.Parse(numberBuffer.GetString(), numberBuffer.GetSize());
+                return d.HasParseError() ? 0 : d.Size();
+            });
+
+            Bench(p, "number_parse_stream", numberCount, [&]() -> size_t {
+                Document d;
+                d.Parse(numberBuffer.GetString());
+                return d.HasParseError() ? 0 : d.Size();
+            });
+        }
+
+        std::vector<Pointer> pointers;
+        for (size_t i = 0; i < p.pointers.size(); i++) {
+            pointers.push_back(Pointer(p.pointers[i].c_str()));
+            Abort(pointers.back().IsValid() && pointers.back().Get(doc) != 0, p, "pointer");
+        }
+        Bench(p, "pointer_get", pointers.size(), [&]() -> size_t {
+            size_t found = 0;
+            for (size_t i = 0; i < pointers.size(); i++)
+                found += pointers[i].Get(doc) != 0;
+            return found;
+        });
+
+        // FindMember on the largest object, with the hashed member index once it has
+        // RAPIDJSON_MEMBER_INDEX_THRESHOLD members. Const lookups need it built beforehand.
+        const Value& object = Pointer(p.object.c_str()).Get(doc)->BuildMemberIndex();
+        Bench(p, "member_find", p.members.size(), [&]() -> size_t {
+            size_t found = 0;
+            for (size_t i = 0; i < p.members.size(); i++)
+                found += object.FindMember(p.members[i].c_str()) != object.MemberEnd();
+            return found;
+        });
+
+        Document schemaDoc;
+        schemaDoc.Parse(p.schema);
+        Abort(!schemaDoc.HasParseError(), p, "schema");
+        SchemaDocument schema(schemaDoc);
+        {
+            SchemaValidator validator(schema);
+            Abort(doc.Accept(validator), p, "validate");
+        }
+        Bench(p, "schema_validate", [&]() -> size_t {
+            SchemaValidator validator(schema);
+            return doc.Accept(validator) ? 1 : 0;
+        });
+
+        Bench(p, "schema_validate_sax", [&]() -> size_t {
+            Reader reader;
+            SchemaValidator validator(schema);
+            StringStream s(json);
+            return reader.Parse(s, validator) ? 1 : 0;
+        });
+
+        // The payload as MessagePack, against write, parse_dom and parse_sax of the JSON text.
+        // The byte counts are those of the MessagePack encoding, so its size is in the results.
+        StringBuffer msgpack;
+        {
+            MsgPackWriter<StringBuffer> writer(msgpack);
+            doc.Accept(writer);
+            Abort(writer.IsComplete(), p, "msgpack");
+        }
+        const size_t msgpackSize = msgpack.GetSize();
+        const std::string sizeName = "msgpack_size/" + p.name;
+        if (sizeName.find(options_.filter) != std::string::npos)
+            std::fprintf(stderr, "%-36s %12u B  json %u B (%.0f%%)\n", sizeName.c_str(),
+                         static_cast<unsigned>(msgpackSize), static_cast<unsigned>(length), 100.0 * msgpackSize / length);
+
+        BenchBytes(p, "msgpack_write", msgpackSize, [&]() -> size_t {
+            StringBuffer sb;
+            MsgPackWriter<StringBuffer> writer(sb);
+            doc.Accept(writer);
+            return sb.GetSize();
+        });
+
+        BenchBytes(p, "msgpack_parse_dom", msgpackSize, [&]() -> size_t {
+            Document d;
+            MsgPackReader reader;
+            MsgPackParser<MsgPackReader> parser(reader, msgpack.GetString(), msgpackSize);
+            d.Populate(parser);
+            return reader.HasParseError() ? 0 : d.MemberCount();
+        });
+
+        BenchBytes(p, "msgpack_parse_sax", msgpackSize, [&]() -> size_t {
+            MsgPackReader reader;
+            CountingHandler handler;
+            reader.Parse(msgpack.GetString(), msgpackSize, handler);
+            return handler.count;
+        });
+    }
+
+    const std::vector<Result>& GetResults() const { return results_; }
+
+private:
+    template <typename Fn>
+    void Bench(const Payload& p, const char* kind, Fn fn) {
+        Record(p, kind, p.json.size(), 0, fn);
+    }
+
+    // Benchmark of ops operations per call, reported in operations per second.
+    template <typename Fn>
+    void Bench(const Payload& p, const char* kind, size_t ops, Fn fn) {
+        Record(p, kind, p.json.size(), ops, fn);
+    }
+
+    // Benchmark processing bytes derived from the payload rather than the payload itself.
+    template <typename Fn>
+    void BenchBytes(const Payload& p, const char* kind, size_t bytes, Fn fn) {
+        Record(p, kind, bytes, 0, fn);
+    }
+
+    template <typename Fn>
+    void Record(const Payload& p, const char* kind, size_t bytes, size_t ops, Fn fn) {
+        std::string name = std::string(kind) + "/" + p.name;
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+            return;
+        Abort(fn() != 0, p, kind);
+
+        Result r = Measure(options_, fn);
+        r.name = name;
+        r.payload = p.name;
+        r.fields = p.fields;
+        r.bytes = bytes;
+        r.ops = ops;
+        results_.push_back(r);
+        if (ops)
+            std::fprintf(stderr, "%-36s %12.0f ns %10.2f Mops/s\n", name.c_str(), r.medianNs, OpsPerSecond(r) * 1e-6);
+        else
+            std::fprintf(stderr, "%-36s %12.0f ns %10.1f MB/s\n", name.c_str(), r.medianNs, MegabytesPerSecond(r));
+    }
+
+    static void Abort(bool ok, const Payload& p, const char* what) {
+        if (!ok) {
+            std::fprintf(stderr, "%s failed on %s\n", what, p.name.c_str());
+            std::exit(1);
+        }
+    }
+
+public:
+    static double MegabytesPerSecond(const Result& r) {
+        return r.medianNs > 0 ? (r.bytes / (1024.0 * 1024.0)) / (r.medianNs * 1e-9) : 0;
+    }
+
+    static double OpsPerSecond(const Result& r) {
+        return r.medianNs > 0 ? r.ops / (r.medianNs * 1e-9) : 0;
+    }
+
+private:
+    const Options& options_;
+    std::vector<Result> results_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Reporting
+
+const char* SimdName() {
+#if defined(RAPIDJSON_SSE42)
+    return "sse4.2";
+#elif defined(RAPIDJSON_SSE2)
+    return "sse2";
+#elif defined(RAPIDJSON_WASM_SIMD128)
+    return "wasm-simd128";
+#elif defined(RAPIDJSON_NEON)
+    return "neon";
+#else
+    return "none";
+#endif
+}
+
+template <typename Handler>
+void WriteResults(Handler& writer, const Options& options, const std::vector<Result>& results) {
+    writer.StartObject();
+    writer.Key("label"); writer.String(options.label.c_str());
+    writer.Key("rapidjson"); writer.String(RAPIDJSON_VERSION_STRING);
+#if defined(__VERSION__)
+    writer.Key("compiler"); writer.String(__VERSION__);
+#else
+    writer.Key("compiler"); writer.String("unknown");
+#endif
+    writer.Key("simd"); writer.String(SimdName());
+    writer.Key("minTimeMs"); writer.Uint(options.minTimeMs);
+    writer.Key("repeat"); writer.Uint(options.repeat);
+    writer.Key("results");
+    writer.StartArray();
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        writer.StartObject();
+        writer.Key("name"); writer.String(r.name.c_str());
+        writer.Key("payload"); writer.String(r.payload.c_str());
+        writer.Key("fields"); writer.Uint64(r.fields);
+        writer.Key("bytes"); writer.Uint64(r.bytes);
+        writer.Key("iterations"); writer.Uint64(r.iterations);
+        writer.Key("minNs"); writer.Double(r.minNs);
+        writer.Key("medianNs"); writer.Double(r.medianNs);
+        writer.Key("meanNs"); writer.Double(r.meanNs);
+        if (r.ops) {
+            writer.Key("ops"); writer.Uint64(r.ops);
+            writer.Key("opsPerSec"); writer.Double(Suite::OpsPerSecond(r));
+        }
+        else {
+            writer.Key("mbPerSec"); writer.Double(Suite::MegabytesPerSecond(r));
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+bool ReadFile(const std::string& path, std::string& content) {
+    FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+    char buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        content.append(buffer, n);
+    std::fclose(fp);
+    return true;
+}
+
+// Returns the number of benchmarks slower than the baseline by more than the threshold.
+int CompareBaseline(const Options& options, const std::vector<Result>& results) {
+    std::string content;
+    if (!ReadFile(options.baseline, content)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", options.baseline.c_str());
+        std::exit(1);
+    }
+    Document baseline;
+    baseline.Parse(content.c_str(), content.size());
+    if (baseline.HasParseError() || !baseline.IsObject() || !baseline.HasMember("results") || !baseline["results"].IsArray()) {
+        std::fprintf(stderr, "invalid baseline %s\n", options.baseline.c_str());
+        std::exit(1);
+    }
+
+    const Value& entries = baseline["results"];
+    int regressions = 0;
+    std::fprintf(stderr, "\n%-36s %12s %12s %8s\n", "benchmark", "baseline ns", "current ns", "change");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        for (SizeType j = 0; j < entries.Size(); j++) {
+            const Value& e = entries[j];
+            if (!e.IsObject() || !e.HasMember("name") || !e.HasMember("medianNs") || !e["medianNs"].IsNumber() || r.name != e["name"].GetString())
+                continue;
+            double old = e["medianNs"].GetDouble();
+            double change = old > 0 ? (r.medianNs - old) * 100.0 / old : 0;
+            bool regressed = change > options.threshold;
+            regressions += regressed;
+            std::fprintf(stderr, "%-36s %12.0f %12.0f %+7.1f%%%s\n", r.name.c_str(), old, r.medianNs, change, regressed ? "  REGRESSION" : "");
+            break;
+        }
+    }
+    return regressions;
+}
+
+void DumpCorpus(const std::string& dir, const std::vector<Payload>& corpus) {
+    for (size_t i = 0; i < corpus.size(); i++) {
+        std::string path = dir + "/" + corpus[i].name + ".json";
+        FILE* fp = std::fopen(path.c_str(), "wb");
+        if (!fp) {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            std::exit(1);
+        }
+        std::fwrite(corpus[i].json.data(), 1, corpus[i].json.size(), fp);
+        std::fclose(fp);
+    }
+}
+
+void Usage() {
+    std::fprintf(stderr,
+        "usage: rapidjsonbench [--filter substr] [--min-time ms] [--repeat n]\n"
+        "                      [--out results.json] [--label text]\n"
+        "                      [--baseline old.json] [--threshold percent]\n"
+        "                      [--dump-corpus dir]\n");
+    std::exit(1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (i + 1 >= argc)
+            Usage();
+        const char* value = argv[++i];
+        if (arg == "--filter") options.filter = value;
+        else if (arg == "--min-time") options.minTimeMs = static_cast<unsigned>(std::strtoul(value, 0, 10));
+        else if (arg == "--repeat") options.repeat = static_cast<unsigned>(std::strtoul(value, 0, 10));
+        else if (arg == "--out") options.out = value;
+        else if (arg == "--label") options.label = value;
+        else if (arg == "--baseline") options.baseline = value;
+        else if (arg == "--threshold") options.threshold = std::strtod(value, 0);
+        else if (arg == "--dump-corpus") options.dumpCorpus = value;
+        else Usage();
+    }
+    if (options.repeat == 0 || options.minTimeMs == 0)
+        Usage();
+
+    std::vector<Payload> corpus = MakeCorpus();
+    if (!options.dumpCorpus.empty())
+        DumpCorpus(options.dumpCorpus, corpus);
+
+    Suite suite(options);
+    for (size_t i = 0; i < corpus.size(); i++)
+        suite.Run(corpus[i]);
+
+    FILE* fp = options.out.empty() ? stdout : std::fopen(options.out.c_str(), "wb");
+    if (!fp) {
+        std::fprintf(stderr, "cannot write %s\n", options.out.c_str());
+        return 1;
+    }
+    char buffer[65536];
+    FileWriteStream os(fp, buffer, sizeof(buffer));
+    PrettyWriter<FileWriteStream> writer(os);
+    WriteResults(writer, options, suite.GetResults());
+    os.Put('\n');
+    os.Flush();
+    if (fp != stdout)
+        std::fclose(fp);
+
+    if (!options.baseline.empty() && CompareBaseline(options, suite.GetResults()) > 0)
+        return 2;
+    return 0;
+}
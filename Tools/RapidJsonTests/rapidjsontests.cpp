@@ -0,0 +1,1330 @@
+// Regression tests for the vendored rapidjson headers and their extensions.
+//
+// Every case is a plain function of checks; the process exits with status 1
+// if any check fails. The cases are meant to run under AddressSanitizer and
+// UndefinedBehaviorSanitizer, which catch the out-of-bounds reads they cover.
+//
+// Build (native, with sanitizers):
+//   c++ -std=c++11 -g -O1 -fsanitize=address,undefined -fno-omit-frame-pointer
+//       -pthread -I SDKResources/WASM/include Tools/RapidJsonTests/rapidjsontests.cpp
+//       -o rapidjsontests
+//   (add -msse4.2 -DRAPIDJSON_SSE42 or -DRAPIDJSON_SSE2 to cover the SIMD paths;
+//   build with -fsanitize=thread instead to check the concurrent cases for races)
+//
+// Usage:
+//   rapidjsontests [--filter substr]
+
+#include "rapidjson/document.h"
+#include "rapidjson/schema.h"
+#include "rapidjson/instrumentedallocator.h"
+#include "rapidjson/msgpack.h"
+#include "rapidjson/ndjsonreader.h"
+#include "rapidjson/patch.h"
+#include "rapidjson/persistentvalue.h"
+#include "rapidjson/pushreader.h"
+#include "rapidjson/segmentedbuffer.h"
+#include "rapidjson/tape.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace rapidjson;
+
+namespace {
+
+int g_failures;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); g_failures++; } } while (0)
+
+// Copy of json in a heap block with room after the terminator for the aligned 16 byte loads of the SIMD
+// string scans, which never cross a page but may read past the end of the text.
+std::string SimdPadded(const char* json) {
+    std::string padded(json);
+    padded.reserve(padded.size() + 16);
+    return padded;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Member index
+
+const char* MemberName(char* buffer, int i) {
+    std::sprintf(buffer, "A:VAR %d", i);
+    return buffer;
+}
+
+// Checks that object holds exactly the members "A:VAR i" = i for i in [0, count) except removed, in any order.
+bool HasVarMembers(const Value& object, int count, int removed) {
+    char name[32];
+    for (int i = 0; i < count; i++) {
+        Value::ConstMemberIterator m = object.FindMember(MemberName(name, i));
+        if (i == removed ? m != object.MemberEnd() : (m == object.MemberEnd() || m->value.GetInt() != i))
+            return false;
+    }
+    return !object.HasMember("A:VAR -1") && object.MemberCount() == static_cast<SizeType>(removed < 0 ? count : count - 1);
+}
+
+bool MemberNameLess(const Value::Member& a, const Value::Member& b) {
+    return std::strcmp(a.name.GetString(), b.name.GetString()) < 0;
+}
+
+// Lookups on large objects use the member index and stay correct as the members change.
+void MemberIndexLookups() {
+    Document d;
+    Value& object = d.SetObject();
+    char name[32];
+    const int kCount = 500;
+    for (int i = 0; i < kCount; i++)
+        object.AddMember(Value(MemberName(name, i), d.GetAllocator()).Move(), i, d.GetAllocator());
+
+    // Const lookups do not build the index.
+    const Value& constObject = object;
+    CHECK(HasVarMembers(constObject, kCount, -1));
+    object.BuildMemberIndex();
+    CHECK(HasVarMembers(constObject, kCount, -1));
+
+    // Added members are indexed in place, through non-const lookups too.
+    object.AddMember("A:VAR 500", 500, d.GetAllocator());
+    CHECK(HasVarMembers(constObject, kCount + 1, -1));
+    CHECK(object.FindMember("A:VAR 500")->value.GetInt() == 500);
+    CHECK(object["A:VAR 250"].GetInt() == 250);
+
+    // Removing swaps the last member in; the index is rebuilt by the next non-const lookup.
+    CHECK(object.RemoveMember("A:VAR 7"));
+    CHECK(HasVarMembers(constObject, kCount + 1, 7));
+    CHECK(object.FindMember("A:VAR 500") != object.MemberEnd());
+    CHECK(HasVarMembers(constObject, kCount + 1, 7));
+    object.EraseMember(object.FindMember("A:VAR 500"));
+    CHECK(HasVarMembers(constObject, kCount, 7));
+
+    // Reordered members are detected, by const and non-const lookups.
+    object.BuildMemberIndex();
+    std::sort(object.MemberBegin(), object.MemberEnd(), MemberNameLess);
+    CHECK(std::strcmp(object.MemberBegin()->name.GetString(), "A:VAR 0") == 0);
+    CHECK(HasVarMembers(constObject, kCount, 7));
+    CHECK(object.FindMember("A:VAR 499")->value.GetInt() == 499);
+    CHECK(HasVarMembers(constObject, kCount, 7));
+
+    // Renamed members are found once the index is rebuilt.
+    Value::MemberIterator renamed = object.FindMember("A:VAR 8");
+    renamed->name.SetString("A:VAR 7", d.GetAllocator());
+    renamed->value.SetInt(7);
+    object.BuildMemberIndex();
+    CHECK(object.FindMember("A:VAR 8") == object.MemberEnd());
+    CHECK(constObject["A:VAR 7"].GetInt() == 7);
+
+    // Duplicate names resolve to the first member, as without the index.
+    object.AddMember("A:VAR 0", -1, d.GetAllocator());
+    CHECK(constObject["A:VAR 0"].GetInt() == 0);
+    CHECK(object["A:VAR 0"].GetInt() == 0);
+}
+
+// Threads sharing a const object only read it.
+void MemberIndexConcurrentReaders() {
+    Document d;
+    Value& object = d.SetObject();
+    char name[32];
+    const int kCount = 200;
+    for (int i = 0; i < kCount; i++)
+        object.AddMember(Value(MemberName(name, i), d.GetAllocator()).Move(), i, d.GetAllocator());
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1)
+            object.BuildMemberIndex();
+        const Document& shared = d;
+        bool ok[2] = {};
+        std::thread threads[2];
+        for (int t = 0; t < 2; t++)
+            threads[t] = std::thread([&, t]() { ok[t] = HasVarMembers(shared, kCount, -1); });
+        for (int t = 0; t < 2; t++)
+            threads[t].join();
+        CHECK(ok[0] && ok[1]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tape
+
+// The end iterator of the root object sits one past the last entry of the tape.
+void TapeRootObjectIteration() {
+    TapeDocument d(0, 64);
+    d.Parse(SimdPadded("{\"a\":1}").c_str());
+    CHECK(!d.HasParseError());
+    TapeValue root = d.GetRoot();
+    CHECK(root.HasMember("a"));
+    CHECK(!root.HasMember("b"));
+
+    int count = 0;
+    for (TapeValue::ConstMemberIterator m = root.MemberBegin(); m != root.MemberEnd(); ++m) {
+        CHECK(std::strcmp(m->name.GetString(), "a") == 0);
+        CHECK(m->value.GetInt() == 1);
+        count++;
+    }
+    CHECK(count == 1);
+
+    d.Parse(SimdPadded("{}").c_str());
+    CHECK(d.GetRoot().MemberBegin() == d.GetRoot().MemberEnd());
+    CHECK(!d.GetRoot().HasMember("a"));
+
+    d.Parse(SimdPadded("{\"s\":\"text\",\"o\":{\"x\":[1,2]},\"n\":null}").c_str());
+    root = d.GetRoot();
+    count = 0;
+    for (TapeValue::ConstMemberIterator m = root.MemberBegin(); m != root.MemberEnd(); m++)
+        count++;
+    CHECK(count == 3);
+    CHECK(root["o"]["x"][1].GetInt() == 2);
+    CHECK(root["n"].IsNull());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Float
+
+// A float stored in a value keeps its exact value; only Writer::Float() shortens it.
+void FloatValuePredicates() {
+    CHECK(Value(0.3f).IsFloat());
+    CHECK(Value(0.3f).IsLosslessFloat());
+    CHECK(Value(0.3f).GetFloat() == 0.3f);
+    CHECK(Value(0.3f).GetDouble() == static_cast<double>(0.3f));
+    CHECK(Value(FLT_MAX).IsFloat());
+    CHECK(Value(FLT_MAX).IsLosslessFloat());
+    CHECK(Value(-FLT_MAX).IsFloat());
+    CHECK(Value(FLT_MIN).IsLosslessFloat());
+
+    Value d;
+    d.SetDouble(0.3f);
+    CHECK(Value(0.3f) == d);
+    Value f;
+    f.SetFloat(0.3f);
+    CHECK(f == d);
+    CHECK(f.IsLosslessFloat());
+    CHECK(!Value(0.3).IsLosslessFloat());
+}
+
+void WriterFloatShortest() {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    writer.Float(0.3f);
+    writer.Float(FLT_MAX);
+    writer.Float(-1.5f);
+    writer.Float(0.0f);
+    writer.EndArray();
+    CHECK(std::strcmp(sb.GetString(), "[0.3,3.4028235e38,-1.5,0.0]") == 0);
+
+}
+
+// Writes v with a fresh writer of type W.
+template <typename W>
+std::string AcceptToString(const Value& v) {
+    StringBuffer sb;
+    W writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+struct DoubleRecorder : BaseReaderHandler<UTF8<>, DoubleRecorder> {
+    DoubleRecorder() : value() {}
+    bool Double(double d) { value = d; return true; }
+    double value;
+};
+
+// A value made from a float is written by Writer::Float(); the same number set as a double is not.
+void ValueFloatAccept() {
+    CHECK(AcceptToString<Writer<StringBuffer> >(Value(0.3f)) == "0.3");
+    CHECK(AcceptToString<PrettyWriter<StringBuffer> >(Value(0.3f)) == "0.3");
+    CHECK(AcceptToString<Writer<StringBuffer> >(Value(-1.17549435e-38f)) == "-1.1754944e-38");
+    Value f;
+    f.SetFloat(0.3f);
+    CHECK(AcceptToString<Writer<StringBuffer> >(f) == "0.3");
+
+    Value d;
+    d.SetDouble(0.3f);
+    CHECK(AcceptToString<Writer<StringBuffer> >(d) == "0.30000001192092898");
+    f.SetDouble(0.3f);
+    CHECK(AcceptToString<Writer<StringBuffer> >(f) == "0.30000001192092898");
+
+    // Deep copies keep the float origin.
+    Document doc;
+    doc.SetArray().PushBack(Value(0.3f), doc.GetAllocator());
+    Value copy(doc, doc.GetAllocator());
+    CHECK(AcceptToString<Writer<StringBuffer> >(copy) == "[0.3]");
+
+    // Handlers without Float() get the exact double.
+    DoubleRecorder recorder;
+    CHECK(Value(0.3f).Accept(recorder));
+    CHECK(recorder.value == static_cast<double>(0.3f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Strings
+
+bool PointsInto(const Value& v, const std::string& buffer) {
+    return v.GetString() >= buffer.data() && v.GetString() < buffer.data() + buffer.size();
+}
+
+bool HasString(const Value& v, const char* expected, SizeType length) {
+    return v.IsString() && v.GetStringLength() == length && std::memcmp(v.GetString(), expected, length) == 0;
+}
+
+// With kParseNoCopyStringsFlag, strings without escapes refer into the source and are not null-terminated;
+// escaped strings, and every string without the flag, are copies with a terminator.
+void StringsNoCopy() {
+    const std::string json = SimdPadded("{\"plain key\":\"plain value\",\"esc\\\"key\":\"tab\\there\",\"utf8\":\"caf\xC3\xA9\","
+                                        "\"nul\":\"a\\u0000b\",\"empty\":\"\"}");
+    for (int pass = 0; pass < 3; pass++) {
+        Document d;
+        if (pass == 0)
+            d.ParseNoCopy(json.c_str());
+        else if (pass == 1)
+            d.ParseNoCopy(json.c_str(), json.size());
+        else
+            d.Parse(json.c_str());
+        CHECK(!d.HasParseError() && d.MemberCount() == 5);
+        const bool noCopy = pass < 2;
+
+        Value::ConstMemberIterator m = d.MemberBegin();
+        CHECK(HasString(m->name, "plain key", 9) && HasString(m->value, "plain value", 11));
+        CHECK(PointsInto(m->name, json) == noCopy && PointsInto(m->value, json) == noCopy);
+        // A referenced string ends at the closing quote of the source.
+        CHECK(m->value.GetString()[11] == (noCopy ? '\"' : '\0'));
+        CHECK(d["plain key"] == "plain value");
+
+        ++m;
+        CHECK(HasString(m->name, "esc\"key", 7) && HasString(m->value, "tab\there", 8));
+        CHECK(!PointsInto(m->name, json) && !PointsInto(m->value, json));
+        CHECK(m->name.GetString()[7] == '\0' && m->value.GetString()[8] == '\0');
+
+        ++m;
+        CHECK(HasString(m->value, "caf\xC3\xA9", 5) && PointsInto(m->value, json) == noCopy);
+
+        ++m;
+        CHECK(HasString(m->value, "a\0b", 3) && !PointsInto(m->value, json) && m->value.GetString()[3] == '\0');
+
+        ++m;
+        CHECK(HasString(m->value, "", 0));
+    }
+
+    // Non-ASCII strings are copied when the encoding is validated.
+    Document d;
+    d.ParseNoCopy<kParseValidateEncodingFlag>(json.c_str());
+    CHECK(!d.HasParseError() && HasString(d["utf8"], "caf\xC3\xA9", 5) && !PointsInto(d["utf8"], json));
+    CHECK(PointsInto(d["plain key"], json));
+    d.ParseNoCopy<kParseValidateEncodingFlag>(SimdPadded("[\"\xC3\"]").c_str());
+    CHECK(d.GetParseError() == kParseErrorStringInvalidEncoding);
+
+    // A truncated buffer is an error, with or without the flag.
+    d.ParseNoCopy(json.c_str(), 5);
+    CHECK(d.GetParseError() == kParseErrorStringMissQuotationMark);
+    d.Parse(json.c_str(), 5);
+    CHECK(d.GetParseError() == kParseErrorStringMissQuotationMark);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Numbers
+
+// Parses a copy of json in an exact-size heap block, so that any read past the terminator is reported.
+bool ParseExact(Document& d, const char* json, bool withLength) {
+    const size_t length = std::strlen(json);
+    char* copy = static_cast<char*>(std::malloc(withLength ? length : length + 1));
+    std::memcpy(copy, json, withLength ? length : length + 1);
+    if (withLength)
+        d.Parse(copy, length);
+    else
+        d.Parse(copy);
+    std::free(copy);
+    return !d.HasParseError();
+}
+
+// Digit runs are loaded in blocks only from streams which know their end.
+void NumberDigitRunsStayInBounds() {
+    static const char* const kNumbers[] = {
+        "12", "-7", "12345678", "123456789", "1234567890123", "-9223372036854775808",
+        "18446744073709551615", "0.5", "3.14159265", "0.1234567890123456789", "47.6062095",
+        "-122.3320708", "1e10", "123456789012345678901234567890", "[1,22,333,4444,55555]"
+    };
+    for (size_t i = 0; i < sizeof(kNumbers) / sizeof(kNumbers[0]); i++) {
+        Document a, b;
+        CHECK(ParseExact(a, kNumbers[i], false));
+        CHECK(ParseExact(b, kNumbers[i], true));
+        CHECK(a == b);
+    }
+
+    Document d;
+    CHECK(ParseExact(d, "12345678", true) && d.GetInt() == 12345678);
+    CHECK(ParseExact(d, "-9223372036854775808", true) && d.GetInt64() == INT64_MIN);
+    CHECK(ParseExact(d, "18446744073709551615", true) && d.GetUint64() == UINT64_MAX);
+    CHECK(ParseExact(d, "0.1234567890123456", true) && d.GetDouble() == 0.1234567890123456);
+    CHECK(ParseExact(d, "47.6062095", true) && d.GetDouble() == 47.6062095);
+}
+
+// Parses number with kParseFullPrecisionFlag and checks the result bit for bit against strtod(). Overflow may
+// also be reported as kParseErrorNumberTooBig.
+bool ParsesLikeStrtod(const char* number) {
+    const double expected = std::strtod(number, 0);
+    Document d;
+    d.Parse<kParseFullPrecisionFlag>(number);
+    if (d.HasParseError())
+        return std::fabs(expected) == HUGE_VAL && d.GetParseError() == kParseErrorNumberTooBig;
+    if (!d.IsDouble() && !(d.IsNumber() && std::strpbrk(number, ".eE") == 0))
+        return false;
+    const double actual = d.GetDouble();
+    if (std::memcmp(&actual, &expected, sizeof(double)) == 0)
+        return true;
+    std::fprintf(stderr, "  %s: parsed %.17g, strtod %.17g\n", number, actual, expected);
+    return false;
+}
+
+// Writes the exact decimal expansion of the midpoint between d > 0 and the next double up, then one of:
+// the midpoint itself, a value just below it, or a value just above it.
+bool FormatMidpoint(char* buffer, size_t size, double d, int offset) {
+#if LDBL_MANT_DIG >= 64
+    const long double mid = (static_cast<long double>(d) + static_cast<long double>(std::nextafter(d, HUGE_VAL))) / 2;
+    std::snprintf(buffer, size, "%.800Le", mid);
+    char* e = std::strchr(buffer, 'e');
+    char* last = e - 1;
+    while (*last == '0')
+        last--;
+    std::string exponent(e);
+    if (offset > 0) {
+        *++last = '1';
+    } else if (offset < 0) {
+        // Decrement the last nonzero digit and pad with nines.
+        (*last)--;
+        for (int i = 0; i < 5; i++)
+            *++last = '9';
+    }
+    std::strcpy(last + 1, exponent.c_str());
+    return true;
+#else
+    (void)buffer; (void)size; (void)d; (void)offset;
+    return false;
+#endif
+}
+
+// Full precision parsing matches strtod on halfway cases, subnormals, long inputs and the overflow boundary.
+void StrtodMatchesLibc() {
+    static const char* const kNumbers[] = {
+        // Ties to even around 2^53 and 1.
+        "9007199254740993", "9007199254740995", "9007199254740993.000000000000000000001",
+        "9007199254740992.999999999999999999999", "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124", "1.00000000000000011102230246251565404236316680908203126",
+        // Subnormals and the normal boundary.
+        "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324", "2e-324", "3e-324",
+        "2.2250738585072011e-308", "2.2250738585072012e-308", "2.2250738585072014e-308", "4.4501477170144023e-308",
+        "1e-400", "0.000000000000000000000000000000000000000000000000000000000000000000000000000000001e-300",
+        // More than 19 digits.
+        "3.3276237173476957047603103473289198982e-104", "12345678901234567890", "123456789012345678901234567890",
+        "0.12345678901234567890123456789", "47.606209512345678901234567", "-122.33207081234567890123456789",
+        "18446744073709551616", "18446744073709551615.5", "1.7976931348623157e+308",
+        // Overflow boundary: the midpoint between DBL_MAX and 2^1024 rounds up.
+        "1.7976931348623158e308", "1.797693134862315807e308", "1.7976931348623158079372897140530341507993e308",
+        "1.7976931348623158079372897140530341507994e308", "1.7976931348623159e308", "1.8e308", "1e309",
+        "179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096"
+        "330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730"
+        "270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497791.9",
+    };
+    for (size_t i = 0; i < sizeof(kNumbers) / sizeof(kNumbers[0]); i++)
+        CHECK(ParsesLikeStrtod(kNumbers[i]));
+
+    // Exact midpoints of random doubles, normal and subnormal, and their neighbours.
+    std::mt19937_64 random(42);
+    char buffer[1024];
+    int mismatches = 0;
+    for (int i = 0; i < 3000; i++) {
+        uint64_t bits = random() & 0x7FEFFFFFFFFFFFFFull;
+        if (i % 3 == 0)
+            bits &= 0x000FFFFFFFFFFFFFull;
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        if (d == 0)
+            continue;
+        for (int offset = -1; offset <= 1; offset++)
+            if (FormatMidpoint(buffer, sizeof(buffer), d, offset) && !ParsesLikeStrtod(buffer))
+                mismatches++;
+        std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+        if (!ParsesLikeStrtod(buffer))
+            mismatches++;
+    }
+
+    // Random digit strings of 1 to 40 digits across the whole exponent range.
+    for (int i = 0; i < 20000; i++) {
+        const int digits = 1 + static_cast<int>(random() % 40);
+        char* p = buffer;
+        if (random() & 1)
+            *p++ = '-';
+        *p++ = static_cast<char>('1' + random() % 9);
+        if (digits > 1)
+            *p++ = '.';
+        for (int k = 1; k < digits; k++)
+            *p++ = static_cast<char>('0' + random() % 10);
+        std::sprintf(p, "e%d", static_cast<int>(random() % 640) - 330);
+        if (!ParsesLikeStrtod(buffer))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Schema
+
+bool Validates(const SchemaDocument& schema, const char* json) {
+    Document d;
+    d.Parse(SimdPadded(json).c_str());
+    SchemaValidator validator(schema);
+    return !d.HasParseError() && d.Accept(validator);
+}
+
+// A key matched only by patternProperties is not an additional property.
+void SchemaPatternPropertiesOnly() {
+    Document sd;
+    sd.Parse(SimdPadded("{\"patternProperties\":{\"^a\":{\"type\":\"integer\"}},\"additionalProperties\":false}").c_str());
+    SchemaDocument schema(sd);
+    CHECK(Validates(schema, "{\"ab\":1}"));
+    CHECK(Validates(schema, "{\"ab\":1,\"ac\":2}"));
+    CHECK(Validates(schema, "{}"));
+    CHECK(!Validates(schema, "{\"ab\":\"x\"}"));
+    CHECK(!Validates(schema, "{\"b\":1}"));
+    CHECK(!Validates(schema, "{\"ab\":1,\"b\":1}"));
+
+    // A key matching a property and a pattern, then a key matching the pattern only.
+    sd.Parse(SimdPadded("{\"properties\":{\"ab\":{\"minimum\":0}},\"patternProperties\":{\"^a\":{\"type\":\"integer\"}},"
+                        "\"additionalProperties\":false}").c_str());
+    SchemaDocument withProperty(sd);
+    CHECK(Validates(withProperty, "{\"ab\":1,\"ac\":2}"));
+    CHECK(!Validates(withProperty, "{\"ab\":-1,\"ac\":2}"));
+    CHECK(!Validates(withProperty, "{\"ab\":1,\"ac\":2.5}"));
+}
+
+// Validators on different threads share one schema document and its compiled patterns.
+void SchemaConcurrentValidators() {
+    Document sd;
+    sd.Parse(SimdPadded("{\"type\":\"object\",\"properties\":{\"icao\":{\"type\":\"string\",\"pattern\":\"^[A-Z]{4}$\"}},"
+                        "\"patternProperties\":{\"^L:[A-Z_]+$\":{\"type\":\"number\"},\"^A:\":{\"type\":\"number\"}},"
+                        "\"additionalProperties\":false}").c_str());
+    SchemaDocument schema(sd);
+
+    static const char* const kDocuments[] = {
+        "{\"icao\":\"KSEA\",\"L:FLAPS_SET\":1,\"A:PLANE ALTITUDE\":1500.5}",
+        "{\"icao\":\"KSEA1\"}",
+        "{\"icao\":\"EGLL\",\"A:AIRSPEED INDICATED\":120}",
+        "{\"L:flaps\":1}",
+        "{\"L:GEAR_HANDLE\":\"down\"}",
+        "{\"A:ANY\":0,\"L:X\":2,\"icao\":\"LFPG\"}",
+    };
+    static const bool kValid[] = { true, false, true, false, false, true };
+    const size_t count = sizeof(kDocuments) / sizeof(kDocuments[0]);
+    Document documents[count];
+    for (size_t i = 0; i < count; i++)
+        documents[i].Parse(SimdPadded(kDocuments[i]).c_str());
+
+    int mismatches[2] = {};
+    std::thread threads[2];
+    for (int t = 0; t < 2; t++)
+        threads[t] = std::thread([&, t]() {
+            SchemaValidator validator(schema);
+            for (int n = 0; n < 2000; n++) {
+                const size_t i = static_cast<size_t>(n + t) % count;
+                validator.Reset();
+                if (documents[i].Accept(validator) != kValid[i])
+                    mismatches[t]++;
+            }
+        });
+    for (int t = 0; t < 2; t++)
+        threads[t].join();
+    CHECK(mismatches[0] == 0);
+    CHECK(mismatches[1] == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MessagePack
+
+// Writes d as a MessagePack root value, reads it back, and returns the encoded size.
+size_t MsgPackRoundTrip(double d, double& back) {
+    StringBuffer sb;
+    MsgPackWriter<StringBuffer> writer(sb);
+    writer.Double(d);
+    Document doc;
+    MsgPackReader reader;
+    MsgPackParser<MsgPackReader> parser(reader, sb.GetString(), sb.GetSize());
+    doc.Populate(parser);
+    back = doc.IsNumber() ? doc.GetDouble() : 0;
+    return sb.GetSize();
+}
+
+// Doubles are narrowed to float 32 only when exact; out of range values must not be narrowed at all.
+void MsgPackDoubleNarrowing() {
+    double back;
+    CHECK(MsgPackRoundTrip(0.5, back) == 5 && back == 0.5);
+    CHECK(MsgPackRoundTrip(FLT_MAX, back) == 5 && back == FLT_MAX);
+    CHECK(MsgPackRoundTrip(0.1, back) == 9 && back == 0.1);
+    CHECK(MsgPackRoundTrip(1e300, back) == 9 && back == 1e300);
+    CHECK(MsgPackRoundTrip(-1e300, back) == 9 && back == -1e300);
+    CHECK(MsgPackRoundTrip(static_cast<double>(FLT_MAX) * 2, back) == 9 && back == static_cast<double>(FLT_MAX) * 2);
+    CHECK(MsgPackRoundTrip(1e-300, back) == 9 && back == 1e-300);
+    CHECK(MsgPackRoundTrip(HUGE_VAL, back) == 5 && back == HUGE_VAL);
+    CHECK(MsgPackRoundTrip(-HUGE_VAL, back) == 5 && back == -HUGE_VAL);
+    CHECK(MsgPackRoundTrip(std::numeric_limits<double>::quiet_NaN(), back) == 9 && back != back);
+}
+
+// Encodes value with MsgPackWriter and decodes the output into d.
+bool MsgPackEncodeDecode(const Value& value, StringBuffer& sb, Document& d) {
+    MsgPackWriter<StringBuffer> writer(sb);
+    if (!value.Accept(writer) || !writer.IsComplete())
+        return false;
+    MsgPackReader reader;
+    MsgPackParser<MsgPackReader> parser(reader, sb.GetString(), sb.GetSize());
+    d.Populate(parser);
+    return !reader.HasParseError();
+}
+
+// Documents read back from the writer's output equal the original, and encode to the same bytes again.
+void MsgPackDocumentRoundTrip() {
+    Document original;
+    original.Parse(SimdPadded(
+        "{\"src\":\"5f0c8a52-3b9e-4d0e-9a57-1b2c3d4e5f60\",\"full\":true,\"gone\":null,\"empty\":\"\",\"utf8\":\"\\u00e9\\ud83d\\ude00\",\"ints\":"
+        "[0,127,128,255,256,65535,65536,4294967295,4294967296,18446744073709551615,-1,-32,-33,-128,-129,-32768,-32769,"
+        "-2147483648,-2147483649,-9223372036854775808],\"doubles\":[0.5,-0.0,1.0,0.1,47.6062095,-122.3320708,1e300,"
+        "3.4028234663852886e38,6.8056469327705772e38,1.401298464324817e-45,1e-300],"
+        "\"nested\":{\"a\":{\"b\":{\"c\":[[],{},[[1]]]}}}}").c_str());
+    CHECK(!original.HasParseError());
+
+    // Strings, arrays and maps past the fixstr, fixarray and fixmap, 8 and 16-bit length formats.
+    Document::AllocatorType& allocator = original.GetAllocator();
+    Value big(kArrayType);
+    for (int i = 0; i < 70000; i++)
+        big.PushBack(i, allocator);
+    original.AddMember("big", big, allocator);
+    Value members(kObjectType);
+    char name[32];
+    for (int i = 0; i < 20; i++)
+        members.AddMember(Value(MemberName(name, i), allocator).Move(), i * 0.25, allocator);
+    original.AddMember("members", members, allocator);
+    const std::string text300(300, 'x'), text70000(70000, 'y');
+    original.AddMember("s31", Value(text300.c_str(), 31, allocator).Move(), allocator);
+    original.AddMember("s32", Value(text300.c_str(), 32, allocator).Move(), allocator);
+    original.AddMember("s300", Value(text300.c_str(), allocator).Move(), allocator);
+    original.AddMember("s70000", Value(text70000.c_str(), allocator).Move(), allocator);
+
+    StringBuffer encoded, reencoded;
+    Document decoded, redecoded;
+    CHECK(MsgPackEncodeDecode(original, encoded, decoded));
+    CHECK(decoded == original);
+    CHECK(decoded["doubles"][3].IsDouble() && decoded["doubles"][3].GetDouble() == 0.1);
+    CHECK(decoded["ints"][9].IsUint64() && decoded["ints"][9].GetUint64() == UINT64_MAX);
+    CHECK(decoded["ints"][19].IsInt64() && decoded["ints"][19].GetInt64() == INT64_MIN);
+    CHECK(MsgPackEncodeDecode(decoded, reencoded, redecoded));
+    CHECK(reencoded.GetSize() == encoded.GetSize() && std::memcmp(reencoded.GetString(), encoded.GetString(), encoded.GetSize()) == 0);
+
+    // Narrowing: doubles exact in float 32 take 5 bytes and decode to the same double, others keep 9 bytes.
+    static const double kNarrowable[] = { 0.5, -0.0, 1.0, 0.25, 3.4028234663852886e38, 1.401298464324817e-45 };
+    static const double kWide[] = { 0.1, 47.6062095, 1e300, 6.8056469327705772e38, 1e-300, 1.4e-45 };
+    for (size_t i = 0; i < sizeof(kNarrowable) / sizeof(kNarrowable[0]); i++) {
+        StringBuffer sb;
+        Document d;
+        CHECK(MsgPackEncodeDecode(Value(kNarrowable[i]), sb, d) && sb.GetSize() == 5);
+        CHECK(d.IsDouble() && d.GetDouble() == kNarrowable[i] &&
+              std::signbit(d.GetDouble()) == std::signbit(kNarrowable[i]));
+    }
+    for (size_t i = 0; i < sizeof(kWide) / sizeof(kWide[0]); i++) {
+        StringBuffer sb;
+        Document d;
+        CHECK(MsgPackEncodeDecode(Value(kWide[i]), sb, d) && sb.GetSize() == 9);
+        CHECK(d.IsDouble() && d.GetDouble() == kWide[i]);
+    }
+
+    // A value made from a float is written as float 32 and decodes to the float's exact double.
+    StringBuffer sb;
+    Document d;
+    CHECK(MsgPackEncodeDecode(Value(0.3f), sb, d) && sb.GetSize() == 5);
+    CHECK(d.IsDouble() && d.GetDouble() == static_cast<double>(0.3f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Intern pool
+
+// Interned strings keep their address across rehashes; parsed keys found in the pool refer to it, other
+// keys and all values are copies; lookups and comparisons give the results of documents without a pool.
+void InternPoolMemberNames() {
+    InternPool pool;
+    const char* empty = pool.Intern("");
+    const char* alt = pool.Intern("A:VAR 0");
+    CHECK(empty && *empty == '\0' && pool.Intern("", 0) == empty);
+    CHECK(alt != empty && pool.Intern("A:VAR 0 suffix", 7) == alt && pool.Find("A:VAR 0", 7) == alt && !pool.Find("A:VAR", 5));
+
+    std::vector<const char*> interned;
+    char name[32];
+    for (int i = 0; i < 2000; i++)  // past several rehashes
+        interned.push_back(pool.Intern(MemberName(name, i)));
+    const char* const kLongName = "a member name longer than a short string";
+    const char* longName = pool.Intern(kLongName);
+    CHECK(pool.GetSize() == 2002 && interned[0] == alt);
+    for (int i = 0; i < 2000; i++)
+        CHECK(pool.Intern(MemberName(name, i)) == interned[i] && std::strcmp(interned[i], name) == 0);
+
+    // A large object, above the member index threshold, with keys in and out of the pool and key-like values.
+    std::string json = "{";
+    for (int i = 0; i < 100; i++)
+        json += std::string("\"") + MemberName(name, i) + "\":\"" + MemberName(name, i) + "\",";
+    json += std::string("\"") + kLongName + "\":null,\"unknown\":{\"A:VAR 5\":5,\"other\":[{\"A:VAR 6\":6}]}}";
+    json.reserve(json.size() + 16);     // room for the SIMD string scans, as in SimdPadded()
+
+    Document plain, pooled;
+    plain.Parse(json.c_str());
+    pooled.SetInternPool(&pool).Parse(json.c_str());
+    CHECK(!plain.HasParseError() && !pooled.HasParseError() && pooled.GetInternPool() == &pool);
+    CHECK(pooled.GetAllocator().Size() < plain.GetAllocator().Size());     // the long name is not copied
+    CHECK(pooled.FindMember(kLongName)->name.GetString() == longName);
+    CHECK(pooled.MemberBegin()->name.GetString() == interned[0]);
+    CHECK(pooled.MemberBegin()->value.GetString() != interned[0]);         // values are not interned
+    CHECK(pooled["unknown"]["A:VAR 5"].GetInt() == 5 && pooled["unknown"]["other"][0]["A:VAR 6"].GetInt() == 6);
+    CHECK(pooled["unknown"].MemberBegin()->name.GetString() == interned[5]);
+    Value::ConstMemberIterator unknown = pooled.FindMember("unknown");
+    CHECK(unknown != pooled.MemberEnd() && !pool.Find("unknown", 7) && unknown->name.GetString() != json.c_str() + 1);
+
+    // Lookups through the member index, by a plain string and by an interned name, and comparisons.
+    for (int i = 0; i < 100; i += 7) {
+        CHECK(pooled.FindMember(MemberName(name, i)) == pooled.MemberBegin() + i);
+        CHECK(pooled.FindMember(Value(StringRef(interned[i]))) == pooled.MemberBegin() + i);
+        CHECK(pooled[interned[i]] == Value(StringRef(name)));
+    }
+    CHECK(!pooled.HasMember("A:VAR 100") && pooled == plain && plain == pooled);
+    CHECK(AcceptToString<Writer<StringBuffer> >(pooled) == AcceptToString<Writer<StringBuffer> >(plain));
+
+    // Names of two pools compare by content; a copy keeps referring to the pool.
+    InternPool other;
+    other.InternMemberNames(plain);
+    CHECK(other.GetSize() == 103 && other.Find("other", 5));
+    Document second;
+    second.SetInternPool(&other).Parse(json.c_str());
+    CHECK(second.MemberBegin()->name.GetString() != interned[0] && second == pooled);
+    Document copy;
+    copy.CopyFrom(pooled, copy.GetAllocator());
+    CHECK(copy.MemberBegin()->name.GetString() == interned[0] && copy == plain);
+
+    pooled.SetInternPool(0).Parse(json.c_str());
+    CHECK(pooled.MemberBegin()->name.GetString() != interned[0] && pooled == plain);
+    copy.SetNull();
+    second.SetNull();
+    other.Clear();
+    CHECK(other.GetSize() == 0 && !other.Find("other", 5));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Instrumented allocator
+
+// Blocks are accounted to the innermost scope alive at their Malloc(), even when resized or freed
+// later; the report carries the same figures; statistics outlive the allocator until its last block is freed.
+void InstrumentedAllocatorScopes() {
+    typedef InstrumentedAllocator<> Instrumented;
+    const std::string tag("inner");     // tags are not copied, and match by content
+    Instrumented allocator;
+    void* outside = allocator.Malloc(10);
+    void* outer;
+    void* inner;
+    {
+        Instrumented::Scope outerScope(allocator, "outer");
+        outer = allocator.Malloc(100);
+        {
+            Instrumented::Scope innerScope(allocator, tag.c_str());
+            inner = allocator.Malloc(40);
+            outer = allocator.Realloc(outer, 100, 1000);
+        }
+        inner = allocator.Realloc(inner, 40, 20);
+    }
+    const AllocationStats* root = allocator.GetStats("");
+    const AllocationStats* o = allocator.GetStats("outer");
+    const AllocationStats* i = allocator.GetStats("inner");
+    CHECK(root && o && i && !allocator.GetStats("missing"));
+    CHECK(root->mallocCount == 1 && root->bytes == 10 && root->histogram[AllocationStats::SizeClass(10)] == 1);
+    CHECK(o->mallocCount == 1 && o->reallocCount == 1 && o->bytes == 1000 && o->peakBytes == 1000 && o->totalBytes == 1000);
+    CHECK(o->histogram[AllocationStats::SizeClass(100)] == 1 && o->histogram[AllocationStats::SizeClass(1000)] == 1);
+    CHECK(i->mallocCount == 1 && i->reallocCount == 1 && i->bytes == 20 && i->peakBytes == 40 && i->totalBytes == 40);
+    CHECK(allocator.Size() == 1030 && allocator.PeakSize() == 1050);
+    CHECK(AllocationStats::SizeClass(16) == 0 && AllocationStats::SizeClass(17) == 1 &&
+          AllocationStats::SizeClass(size_t(1) << 30) == AllocationStats::kHistogramSize - 1);
+
+    Instrumented::Free(inner);
+    CHECK(i->freeCount == 1 && i->bytes == 0 && allocator.Size() == 1010);
+    CHECK(allocator.Realloc(outside, 10, 0) == 0 && root->freeCount == 1 && root->bytes == 0);
+
+    // The report is the statistics as JSON.
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    CHECK(allocator.Accept(writer));
+    Document report;
+    report.Parse(SimdPadded(sb.GetString()).c_str());
+    CHECK(!report.HasParseError() && report["bytes"].GetUint64() == 1000 && report["peakBytes"].GetUint64() == 1050);
+    CHECK(report["scopes"].Size() == 3);
+    for (SizeType k = 0; k < report["scopes"].Size(); k++) {
+        const Value& scope = report["scopes"][k];
+        const AllocationStats* stats = allocator.GetStats(scope["name"].GetString());
+        CHECK(stats && scope["mallocCount"].GetUint64() == stats->mallocCount && scope["freeCount"].GetUint64() == stats->freeCount &&
+              scope["peakBytes"].GetUint64() == stats->peakBytes && scope["histogram"].Size() == AllocationStats::kHistogramSize);
+    }
+
+    // A pool on top: the chunks of a parse are accounted to its scope and returned by Clear().
+    typedef MemoryPoolAllocator<Instrumented> Pool;
+    Pool pool(256, &allocator);
+    {
+        Instrumented::Scope scope(allocator, "parse");
+        GenericDocument<UTF8<>, Pool> d(&pool);
+        d.Parse(SimdPadded("{\"a\":[1,2,3,\"a string long enough to be copied\"],\"b\":{\"c\":null},"
+                           "\"d\":[[[],[]],[[],[]],{},{}]}").c_str());
+        CHECK(!d.HasParseError());
+    }
+    const AllocationStats* parse = allocator.GetStats("parse");
+    CHECK(parse && parse->mallocCount > 0 && parse->bytes > pool.Capacity());    // chunks and their headers
+    pool.Clear();
+    CHECK(parse->bytes == 0 && parse->freeCount == parse->mallocCount);
+    Instrumented::Free(outer);
+
+    // A block freed after its allocator is destroyed updates statistics which are still alive.
+    Instrumented* owner = new Instrumented;
+    void* late = owner->Malloc(64);
+    delete owner;
+    Instrumented::Free(late);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// NDJSON
+
+// Collects the records of an NdjsonReader as (offset, JSON text); the unordered mode calls it concurrently.
+struct NdjsonCollector {
+    NdjsonCollector() : stopAt(~size_t(0)), calls() {}
+    bool operator()(Value& record, size_t offset) {
+        std::lock_guard<std::mutex> lock(mutex);
+        calls++;
+        records.push_back(std::make_pair(offset, AcceptToString<Writer<StringBuffer> >(record)));
+        return offset != stopAt;
+    }
+    std::mutex mutex;
+    std::vector<std::pair<size_t, std::string> > records;
+    size_t stopAt;      // offset of the record for which to return false
+    size_t calls;
+};
+
+// Records of a sequential parse, line by line, up to the first error.
+ParseResult ParseLines(const std::string& text, std::vector<std::pair<size_t, std::string> >& records) {
+    for (size_t begin = 0; begin < text.size(); ) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos)
+            end = text.size();
+        if (text.find_first_not_of(" \t\r", begin) < end) {
+            Document d;
+            d.Parse(text.c_str() + begin, end - begin);
+            if (d.HasParseError())
+                return ParseResult(d.GetParseError(), begin + d.GetErrorOffset());
+            records.push_back(std::make_pair(begin, AcceptToString<Writer<StringBuffer> >(d)));
+        }
+        begin = end + 1;
+    }
+    return ParseResult();
+}
+
+// Records cut by small chunks at every position are delivered as a sequential parse sees them,
+// in order or in any order, with the first error of the input and the records before it.
+void NdjsonMatchesSequential() {
+    std::mt19937 rng(15);
+    std::string text;
+    for (int i = 0; i < 2000; i++) {
+        switch (rng() % 8) {
+        case 0: text += "\n"; continue;                             // blank lines are skipped
+        case 1: text += " \t\r\n"; continue;
+        case 2: text += "[" + std::to_string(i) + ", " + std::string(rng() % 600, ' ') + "true]\r\n"; continue; // longer than a chunk
+        default: break;
+        }
+        text += "{\"id\":" + std::to_string(i) + ",\"name\":\"" + std::string(rng() % 40, 'x') + "\",\"v\":[" +
+            std::to_string(static_cast<double>(rng() % 1000) / 4) + "]}\n";
+    }
+    text += "{\"last\":null}";    // no final newline
+
+    std::vector<std::pair<size_t, std::string> > expected;
+    CHECK(!ParseLines(text, expected).IsError() && expected.size() > 1000);
+
+    NdjsonReader reader(4, 256);
+    NdjsonCollector ordered;
+    CHECK(!reader.Parse(text.c_str(), text.size(), ordered, kNdjsonOrdered).IsError());
+    CHECK(ordered.records == expected && reader.GetRecordCount() == expected.size());
+
+    NdjsonCollector unordered;
+    CHECK(!reader.Parse(text.c_str(), text.size(), unordered, kNdjsonUnordered).IsError());
+    std::sort(unordered.records.begin(), unordered.records.end());
+    CHECK(unordered.records == expected && reader.GetRecordCount() == expected.size());
+
+    // Two broken records: the first one is reported, and in order every record before it is delivered.
+    std::string broken = text;
+    const size_t second = expected[expected.size() * 2 / 3].first, first = expected[expected.size() / 3].first;
+    broken.insert(second, "{\"id\":]\n");
+    broken.insert(first, "[1,2,,3]\n");
+    std::vector<std::pair<size_t, std::string> > before;
+    const ParseResult error = ParseLines(broken, before);
+    CHECK(error.Code() == kParseErrorValueInvalid && error.Offset() == first + 5);
+    NdjsonCollector partial;
+    const ParseResult result = reader.Parse(broken.c_str(), broken.size(), partial, kNdjsonOrdered);
+    CHECK(result.Code() == error.Code() && result.Offset() == error.Offset());
+    CHECK(partial.records == before && reader.GetRecordCount() == before.size());
+    NdjsonCollector any;
+    const ParseResult anyResult = reader.Parse(broken.c_str(), broken.size(), any, kNdjsonUnordered);
+    CHECK(anyResult.Code() == error.Code() && anyResult.Offset() == error.Offset());
+
+    // A callback returning false stops the reader at its record.
+    NdjsonCollector stopping;
+    stopping.stopAt = expected[100].first;
+    const ParseResult stopped = reader.Parse(text.c_str(), text.size(), stopping, kNdjsonOrdered);
+    CHECK(stopped.Code() == kParseErrorTermination && stopped.Offset() == expected[100].first);
+    CHECK(stopping.calls == 101 && reader.GetRecordCount() == 100);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Push reader
+
+// Records every SAX event as a line of text.
+struct EventLog {
+    bool Null() { return Add("null"); }
+    bool Bool(bool b) { return Add(b ? "true" : "false"); }
+    bool Int(int i) { return Add("int " + std::to_string(i)); }
+    bool Uint(unsigned u) { return Add("uint " + std::to_string(u)); }
+    bool Int64(int64_t i) { return Add("int64 " + std::to_string(i)); }
+    bool Uint64(uint64_t u) { return Add("uint64 " + std::to_string(u)); }
+    bool Double(double d) { char buffer[32]; std::snprintf(buffer, sizeof(buffer), "double %a", d); return Add(buffer); }
+    bool RawNumber(const char* str, SizeType length, bool) { return Add("number " + std::string(str, length)); }
+    bool String(const char* str, SizeType length, bool) { return Add("string " + std::string(str, length)); }
+    bool Key(const char* str, SizeType length, bool) { return Add("key " + std::string(str, length)); }
+    bool StartObject() { return Add("{"); }
+    bool EndObject(SizeType count) { return Add("} " + std::to_string(count)); }
+    bool StartArray() { return Add("["); }
+    bool EndArray(SizeType count) { return Add("] " + std::to_string(count)); }
+    bool Add(const std::string& event) { events += event; events += '\n'; return true; }
+    std::string events;
+};
+
+// Events and error of Reader::Parse on the whole input.
+template <unsigned parseFlags>
+std::string ParseWhole(const std::string& json) {
+    EventLog log;
+    Reader reader;
+    std::string padded(json);
+    padded.reserve(padded.size() + 16);     // room for the SIMD string scans, as in SimdPadded()
+    StringStream is(padded.c_str());
+    if (!reader.Parse<parseFlags>(is, log))
+        log.Add("error " + std::to_string(reader.GetParseErrorCode()) + " at " + std::to_string(reader.GetErrorOffset()));
+    return log.events;
+}
+
+// Events and error of PushReader fed with the input cut at the given offsets; every fragment is
+// copied into its own heap block, so that reads past a fragment are reported.
+template <unsigned parseFlags>
+std::string ParsePushed(const std::string& json, const std::vector<size_t>& cuts) {
+    EventLog log;
+    PushReader reader;
+    size_t begin = 0;
+    for (size_t k = 0; k <= cuts.size() && !reader.HasParseError(); k++) {
+        const size_t end = k < cuts.size() ? cuts[k] : json.size();
+        std::vector<char> fragment(json.begin() + static_cast<std::ptrdiff_t>(begin), json.begin() + static_cast<std::ptrdiff_t>(end));
+        reader.Feed<parseFlags>(fragment.empty() ? 0 : &fragment[0], fragment.size(), log);
+        begin = end;
+    }
+    if (!reader.HasParseError())
+        reader.Finish<parseFlags>(log);
+    if (reader.HasParseError())
+        log.Add("error " + std::to_string(reader.GetParseErrorCode()) + " at " + std::to_string(reader.GetErrorOffset()));
+    return log.events;
+}
+
+// Cut at every offset, at every pair of offsets, and into random runs of 1 to 4 characters.
+template <unsigned parseFlags>
+bool PushedLikeWhole(const std::string& json, std::mt19937& rng) {
+    const std::string expected = ParseWhole<parseFlags>(json);
+    bool same = true;
+    std::vector<size_t> cuts;
+    for (size_t i = 0; i <= json.size(); i++) {
+        cuts.assign(1, i);
+        same = same && ParsePushed<parseFlags>(json, cuts) == expected;
+        for (size_t j = i; j <= json.size() && same && json.size() < 200; j++) {
+            cuts.assign(1, i);
+            cuts.push_back(j);
+            same = ParsePushed<parseFlags>(json, cuts) == expected;
+        }
+    }
+    for (int round = 0; round < 20 && same; round++) {
+        cuts.clear();
+        for (size_t i = 1 + rng() % 4; i < json.size(); i += 1 + rng() % 4)
+            cuts.push_back(i);
+        same = ParsePushed<parseFlags>(json, cuts) == expected;
+    }
+    return same;
+}
+
+// Any split of the input, inside strings, escapes, numbers and literals included, gives the events and errors of Reader::Parse.
+void PushReaderArbitrarySplits() {
+    std::mt19937 rng(5);
+    static const char* const kValid[] = {
+        "{\"a\\\"b\":\"x\\\\y\\/z\\b\\f\\n\\r\\t\",\"\\u00e9\\ud83d\\ude00\":[true,false,null],\"n\":"
+            "[0,-0,12,-7,4294967295,4294967296,-2147483649,18446744073709551615,123456789012345678901,"
+            "-0.5e+10,1E-300,3.25e2,2.2250738585072014e-308]}",
+        "  [ {} , [ ] , \"\" , \"caf\xc3\xa9\" , 1.5 ]  ",
+        "\t-12.5e-3\n",
+        "null",
+        "\"\\u0041\\u00e9\"",
+        "{\"nested\":{\"deeper\":{\"deepest\":[[[1],[2.5],[\"three\"]]]}},\"after\":true}",
+    };
+    static const char* const kInvalid[] = {
+        "[1,2",
+        "{\"a\":tru}",
+        "[nul]",
+        "\"abc",
+        "\"\\u12\"",
+        "\"\\ud800\"",
+        "[1.]",
+        "[-]",
+        "[1e]",
+        "{\"a\" 1}",
+        "[1] x",
+        "",
+        "   ",
+    };
+    for (size_t i = 0; i < sizeof(kValid) / sizeof(kValid[0]); i++) {
+        CHECK(PushedLikeWhole<kParseDefaultFlags>(kValid[i], rng));
+        CHECK(PushedLikeWhole<kParseFullPrecisionFlag>(kValid[i], rng));
+        CHECK(PushedLikeWhole<kParseNumbersAsStringsFlag>(kValid[i], rng));
+    }
+    for (size_t i = 0; i < sizeof(kInvalid) / sizeof(kInvalid[0]); i++)
+        CHECK(PushedLikeWhole<kParseDefaultFlags>(kInvalid[i], rng));
+    CHECK(PushedLikeWhole<kParseCommentsFlag | kParseTrailingCommasFlag | kParseNanAndInfFlag>(
+        "/* block * comment */[1, // line\n Infinity, -NaN, \"s\", /**/ {\"k\":null,},]// end", rng));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Segmented buffer
+
+// Content of a segmented buffer joined from its spans; every span but the last one fills a whole segment.
+bool JoinSpans(const SegmentedBuffer& buffer, size_t segment, std::string& joined) {
+    joined.clear();
+    for (size_t i = 0; i < buffer.GetSpanCount(); i++) {
+        const SegmentedBuffer::Span& span = buffer.GetSpans()[i];
+        if (span.size == 0 || span.size > segment || (i + 1 < buffer.GetSpanCount() && span.size != segment))
+            return false;
+        joined.append(span.data, span.size);
+    }
+    return joined.size() == buffer.GetSize();
+}
+
+// Writers produce the same text into segments of any size as into a StringBuffer, CopyTo() reads any
+// range of it, and a cleared buffer reuses its segments without allocating.
+void SegmentedBufferMatchesStringBuffer() {
+    Document d;
+    d.Parse(SimdPadded("{\"name\":\"segmented\",\"values\":[1,2.5,-3e100,true,false,null],\"nested\":{\"empty\":[],\"text\":"
+                       "\"a string long enough to cross several small segments, with \\\"escapes\\\" and \\u00e9\"}}").c_str());
+    CHECK(!d.HasParseError());
+    const std::string compact = AcceptToString<Writer<StringBuffer> >(d);
+    const std::string pretty = AcceptToString<PrettyWriter<StringBuffer> >(d);
+
+    static const size_t kSegmentSizes[] = { 8, 17, 64, 4096 };
+    std::mt19937 rng(16);
+    for (size_t k = 0; k < sizeof(kSegmentSizes) / sizeof(kSegmentSizes[0]); k++) {
+        SegmentPool pool(kSegmentSizes[k]);
+        SegmentedBuffer buffer(&pool, 1);   // the span list grows too
+        std::string joined;
+
+        Writer<SegmentedBuffer> writer(buffer);
+        CHECK(d.Accept(writer) && JoinSpans(buffer, kSegmentSizes[k], joined) && joined == compact);
+        for (int round = 0; round < 200; round++) {
+            const size_t offset = rng() % (compact.size() + 2), count = rng() % (compact.size() + 2);
+            std::string copy(count, '\0');
+            const size_t copied = buffer.CopyTo(offset, &copy[0], count);
+            copy.resize(copied);
+            CHECK(copy == compact.substr(offset < compact.size() ? offset : compact.size(), count));
+        }
+
+        const size_t segments = pool.GetSegmentCount();
+        buffer.Clear();
+        CHECK(buffer.GetSize() == 0 && buffer.GetSpanCount() == 0 && pool.GetFreeSegmentCount() == segments);
+
+        // PrettyWriter indents with PutN(); Write() copies a run longer than a segment.
+        PrettyWriter<SegmentedBuffer> prettyWriter(buffer);
+        CHECK(d.Accept(prettyWriter) && JoinSpans(buffer, kSegmentSizes[k], joined) && joined == pretty);
+        buffer.Clear();
+        buffer.Write(pretty.c_str(), pretty.size());
+        PutN(buffer, ' ', kSegmentSizes[k] * 2 + 1);
+        CHECK(JoinSpans(buffer, kSegmentSizes[k], joined) && joined == pretty + std::string(kSegmentSizes[k] * 2 + 1, ' '));
+        buffer.Clear();
+        CHECK(pool.GetSegmentCount() == pool.GetFreeSegmentCount());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// JSON Patch
+
+// Random JSON of bounded depth; objects of up to 40 members cover both the linear and the hashed member matching.
+void RandomJson(Value& v, int depth, std::mt19937& rng, Document::AllocatorType& allocator) {
+    char name[32];
+    switch (depth > 0 ? rng() % 6 : rng() % 4) {
+    case 0: v.SetNull(); break;
+    case 1: v.SetBool(rng() % 2 != 0); break;
+    case 2: v.SetDouble(static_cast<double>(rng() % 1000) / 8); break;
+    case 3: std::sprintf(name, "s%u", static_cast<unsigned>(rng() % 50)); v.SetString(name, allocator); break;
+    case 4:
+        v.SetArray();
+        for (unsigned i = rng() % 6; i > 0; i--) {
+            Value e;
+            RandomJson(e, depth - 1, rng, allocator);
+            v.PushBack(e, allocator);
+        }
+        break;
+    default:
+        v.SetObject();
+        for (unsigned i = rng() % 40; i > 0; i--) {
+            std::sprintf(name, "m%u/~", static_cast<unsigned>(rng() % 60));   // escaped in the paths
+            if (v.HasMember(name))
+                continue;
+            Value m;
+            RandomJson(m, depth - 1, rng, allocator);
+            v.AddMember(Value(name, allocator).Move(), m, allocator);
+        }
+        break;
+    }
+}
+
+// Copy of v with random members removed, added and changed, and random array elements replaced.
+void MutateJson(Value& v, std::mt19937& rng, Document::AllocatorType& allocator) {
+    if (v.IsObject()) {
+        for (Value::MemberIterator m = v.MemberBegin(); m != v.MemberEnd(); )
+            if (rng() % 8 == 0)
+                m = v.RemoveMember(m);
+            else {
+                if (rng() % 4 == 0)
+                    RandomJson(m->value, 2, rng, allocator);
+                else
+                    MutateJson(m->value, rng, allocator);
+                ++m;
+            }
+        char name[32];
+        for (unsigned i = rng() % 4; i > 0; i--) {
+            std::sprintf(name, "n%u", static_cast<unsigned>(rng() % 60));
+            if (!v.HasMember(name))
+                v.AddMember(Value(name, allocator).Move(), Value(static_cast<int>(i)).Move(), allocator);
+        }
+    }
+    else if (v.IsArray()) {
+        for (SizeType i = 0; i < v.Size(); i++)
+            if (rng() % 4 == 0)
+                RandomJson(v[i], 1, rng, allocator);
+        if (rng() % 3 == 0)
+            v.PushBack(Value(kObjectType).Move(), allocator);
+        else if (rng() % 3 == 0 && !v.Empty())
+            v.PopBack();
+    }
+    else if (v.IsNumber() && rng() % 2)
+        v.SetDouble(v.GetDouble() + 0.5);
+}
+
+// Applying Diff(a, b) to a copy of a gives b.
+bool PatchRoundTrip(Differ& differ, const Value& a, const Value& b, SizeType* operations = 0) {
+    Document patch, patched;
+    differ.Diff(a, b, patch);
+    patched.CopyFrom(a, patched.GetAllocator());
+    if (operations)
+        *operations = patch.Size();
+    return ApplyPatch(patched, patch) == kPatchErrorNone && patched == b;
+}
+
+// ApplyPatch(a, Diff(a, b)) gives b on random documents; a reordered large object diffs to its changes only.
+void PatchDiffRoundTrip() {
+    std::mt19937 rng(8);
+    Differ differ;  // reused, so that its buffers carry over between diffs
+    for (int i = 0; i < 500; i++) {
+        Document a, b;
+        RandomJson(a, 4, rng, a.GetAllocator());
+        b.CopyFrom(a, b.GetAllocator());
+        MutateJson(b, rng, b.GetAllocator());
+        CHECK(PatchRoundTrip(differ, a, b));
+        CHECK(PatchRoundTrip(differ, b, a));
+        SizeType operations;
+        CHECK(PatchRoundTrip(differ, a, a, &operations) && operations == 0);
+    }
+
+    // A large object in a different member order: only the changed members make operations.
+    Document a(kObjectType), b(kObjectType);
+    char name[32];
+    for (int i = 0; i < 5000; i++) {
+        a.AddMember(Value(MemberName(name, i), a.GetAllocator()).Move(), i, a.GetAllocator());
+        const int j = 4999 - i;
+        if (j % 100 != 0)
+            b.AddMember(Value(MemberName(name, j), b.GetAllocator()).Move(), j % 7 == 0 ? -j : j, b.GetAllocator());
+    }
+    b.AddMember("added", true, b.GetAllocator());
+    SizeType operations;
+    CHECK(PatchRoundTrip(differ, a, b, &operations) && operations == 50 + 714 - 7 + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Persistent values
+
+// Whether v holds the same JSON as expected, members compared by name.
+bool PersistentEquals(const PersistentValue& v, const Value& expected) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    Document d;
+    return v.Accept(writer) && !d.Parse(SimdPadded(sb.GetString()).c_str()).HasParseError() && d == expected;
+}
+
+// Every member of the model is found at a position holding its value, and a missing name is not found.
+bool PersistentLookups(const PersistentValue& v, const Value& model) {
+    for (Value::ConstMemberIterator m = model.MemberBegin(); m != model.MemberEnd(); ++m) {
+        const SizeType index = v.FindMember(m->name.GetString(), m->name.GetStringLength());
+        if (index == v.MemberCount() || !PersistentEquals(v.GetMemberValue(index), m->value))
+            return false;
+    }
+    return v.FindMember("missing") == v.MemberCount();
+}
+
+// Set and Remove by name on a large object give the results of Pointer on a document, and leave older versions and their unchanged subtrees shared.
+void PersistentSetRemove() {
+    PersistentValue::AllocatorType allocator;
+    Document model(kObjectType);
+    char name[32];
+    for (int i = 0; i < 2000; i++)
+        model.AddMember(Value(MemberName(name, i), model.GetAllocator()).Move(), i, model.GetAllocator());
+
+    PersistentValue v0(model, allocator);
+    CHECK(PersistentEquals(v0, model) && PersistentLookups(v0, model));
+
+    // One member changes; the others are the same nodes in both versions.
+    const PersistentValue v1 = v0.Set(Pointer("/A:VAR 1500"), Value(-1), allocator);
+    CHECK(v0["A:VAR 1500"].GetInt() == 1500 && v1["A:VAR 1500"].GetInt() == -1);
+    CHECK(v1["A:VAR 7"].IsSameNode(v0["A:VAR 7"]) && v1["A:VAR 1999"].IsSameNode(v0["A:VAR 1999"]));
+    CHECK(v1.MemberCount() == 2000 && v1.FindMember("A:VAR 1500") == 1500);
+
+    // Removing moves the last member into the hole; the moved member is found at its new position.
+    const PersistentValue v2 = v1.Remove(Pointer("/A:VAR 3"), allocator);
+    CHECK(v2.MemberCount() == 1999 && !v2.HasMember("A:VAR 3"));
+    CHECK(v2.FindMember("A:VAR 1999") == 3 && v2["A:VAR 1999"].IsSameNode(v0["A:VAR 1999"]));
+    CHECK(PersistentEquals(v0, model) && v1.HasMember("A:VAR 3"));
+
+    // Random sets, additions and removals against the document model; a few versions are kept to check at the end.
+    std::mt19937 rng(21);
+    PersistentValue v = v0;
+    std::vector<std::pair<PersistentValue, std::string> > kept;
+    for (int step = 0; step < 4000; step++) {
+        const int i = static_cast<int>(rng() % 2600);
+        const std::string path = std::string("/") + MemberName(name, i);
+        if (rng() % 3 == 0) {
+            v = v.Remove(Pointer(path.c_str()), allocator);
+            Pointer(path.c_str()).Erase(model);
+        }
+        else {
+            v = v.Set(Pointer(path.c_str()), Value(step), allocator);
+            Pointer(path.c_str()).Set(model, step);
+        }
+        if (step % 500 == 0) {
+            CHECK(PersistentEquals(v, model) && PersistentLookups(v, model));
+            StringBuffer sb;
+            Writer<StringBuffer> writer(sb);
+            model.Accept(writer);
+            kept.push_back(std::make_pair(v, std::string(sb.GetString(), sb.GetSize())));
+        }
+    }
+    CHECK(PersistentEquals(v, model) && PersistentLookups(v, model));
+    for (size_t k = 0; k < kept.size(); k++) {
+        Document expected;
+        expected.Parse(SimdPadded(kept[k].second.c_str()).c_str());
+        CHECK(PersistentEquals(kept[k].first, expected) && PersistentLookups(kept[k].first, expected));
+    }
+
+    // Removing every member, the last one included, leaves an empty object.
+    PersistentValue emptied = v0;
+    for (int i = 0; i < 2000; i++)
+        emptied = emptied.Remove(Pointer((std::string("/") + MemberName(name, (i * 7) % 2000)).c_str()), allocator);
+    CHECK(emptied.IsObject() && emptied.Empty() && !emptied.HasMember("A:VAR 0"));
+    CHECK(v0.MemberCount() == 2000 && v0.FindMember("A:VAR 0") == 0 && v0["A:VAR 0"].GetInt() == 0);
+
+    // Update() keeps the index and the nodes of unchanged members.
+    model.SetObject();
+    for (int i = 0; i < 2000; i++)
+        model.AddMember(Value(MemberName(name, i), model.GetAllocator()).Move(), i, model.GetAllocator());
+    model["A:VAR 42"] = 0;
+    const PersistentValue updated = v0.Update(model, allocator);
+    CHECK(PersistentEquals(updated, model) && PersistentLookups(updated, model));
+    CHECK(updated["A:VAR 43"].IsSameNode(v0["A:VAR 43"]) && v0["A:VAR 42"].GetInt() == 42);
+
+    // Duplicate names: lookups find the first one, removing it moves the last member into its place.
+    Document duplicates;
+    duplicates.Parse(SimdPadded("{\"a\":1,\"b\":2,\"a\":3}").c_str());
+    const PersistentValue d0(duplicates, allocator);
+    CHECK(d0.FindMember("a") == 0 && d0["a"].GetInt() == 1);
+    const PersistentValue d1 = d0.Remove(Pointer("/a"), allocator);
+    CHECK(d1.MemberCount() == 2 && d1.FindMember("a") == 0 && d1["a"].GetInt() == 3);
+    const PersistentValue d2 = d1.Remove(Pointer("/a"), allocator);
+    CHECK(d2.MemberCount() == 1 && !d2.HasMember("a") && d2["b"].GetInt() == 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+const TestCase kTests[] = {
+    { "member_index_lookups", MemberIndexLookups },
+    { "member_index_concurrent_readers", MemberIndexConcurrentReaders },
+    { "tape_root_object_iteration", TapeRootObjectIteration },
+    { "float_value_predicates", FloatValuePredicates },
+    { "writer_float_shortest", WriterFloatShortest },
+    { "value_float_accept", ValueFloatAccept },
+    { "strings_no_copy", StringsNoCopy },
+    { "number_digit_runs_stay_in_bounds", NumberDigitRunsStayInBounds },
+    { "strtod_matches_libc", StrtodMatchesLibc },
+    { "schema_pattern_properties_only", SchemaPatternPropertiesOnly },
+    { "schema_concurrent_validators", SchemaConcurrentValidators },
+    { "msgpack_double_narrowing", MsgPackDoubleNarrowing },
+    { "msgpack_document_round_trip", MsgPackDocumentRoundTrip },
+    { "intern_pool_member_names", InternPoolMemberNames },
+    { "instrumented_allocator_scopes", InstrumentedAllocatorScopes },
+    { "ndjson_matches_sequential", NdjsonMatchesSequential },
+    { "push_reader_arbitrary_splits", PushReaderArbitrarySplits },
+    { "segmented_buffer_matches_string_buffer", SegmentedBufferMatchesStringBuffer },
+    { "patch_diff_round_trip", PatchDiffRoundTrip },
+    { "persistent_set_remove", PersistentSetRemove },
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--filter substr]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int run = 0;
+    for (size_t i = 0; i < sizeof(kTests) / sizeof(kTests[0]); i++) {
+        if (filter && !std::strstr(kTests[i].name, filter))
+            continue;
+        const int before = g_failures;
+        kTests[i].fn();
+        std::fprintf(stderr, "%-40s %s\n", kTests[i].name, g_failures == before ? "ok" : "FAILED");
+        run++;
+    }
+    std::fprintf(stderr, "%d tests, %d failed checks\n", run, g_failures);
+    return g_failures ? 1 : 0;
+}
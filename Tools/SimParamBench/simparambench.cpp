@@ -0,0 +1,358 @@
+// Benchmark of indexed simvar access through the two FsVarParamArray helpers
+// of MSFS/Utils/SimParamArrayHelper.h:
+//   - "create": FsCreateParamArray(fmt, ...) + FsDestroyParamArray, i.e. a
+//     format string parsed at run time, varargs and one malloc/free per access;
+//   - "stack":  FsParamArray<...>, checked at compile time and built on the stack.
+//
+// Each benchmark reads one indexed var per iteration, cycling through the
+// indices the way the sync code walks engines, fuel tanks and radios. The
+// fsVars functions are replaced by an in-process var table which consumes
+// every parameter, so the numbers isolate the cost of building the
+// parameters plus a call; inside the simulator the var lookup is added to
+// both paths alike.
+//
+// Build (native):
+//   c++ -std=c++11 -O2 -DNDEBUG -I SDKResources/WASM/include
+//       Tools/SimParamBench/simparambench.cpp -o simparambench
+//
+// Build (WASM, SDK clang, run under any WASI runtime):
+//   clang++ --target=wasm32-wasi -std=c++11 -O2 -DNDEBUG
+//       -I SDKResources/WASM/include Tools/SimParamBench/simparambench.cpp
+//       -o simparambench.wasm
+//
+// Usage:
+//   simparambench [--filter substr] [--min-time ms] [--repeat n]
+//
+// Results are written to stdout as one JSON document:
+//   { "compiler", "minTimeMs", "repeat",
+//     "results": [ { "name", "path", "params", "iterations",
+//                    "minNs", "medianNs", "meanNs" } ] }
+// and a summary of the speedup of every benchmark is written to stderr.
+
+#include <MSFS/MSFS_Vars.h>
+#include <MSFS/Utils/SimParamArrayHelper.h>
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/filewritestream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMPARAMBENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define SIMPARAMBENCH_NOINLINE __declspec(noinline)
+#else
+#define SIMPARAMBENCH_NOINLINE
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulated var table
+
+namespace {
+
+const unsigned kVarCount = 64;
+const unsigned kIndexCount = 16;
+double g_vars[kVarCount][kIndexCount];
+
+} // namespace
+
+// Stand-ins for the simulator imports. They read every parameter so that
+// building the array cannot be optimized away.
+extern "C" SIMPARAMBENCH_NOINLINE FsVarError fsVarsAircraftVarGet(FsSimVarId simvar, FsUnitId unit, FsVarParamArray param, double* result) {
+    unsigned index = static_cast<unsigned>(unit);
+    for (unsigned i = 0; i < param.size; i++) {
+        const FsVarParamVariant& p = param.array[i];
+        switch (p.type) {
+        case FsVarParamTypeInteger: index += p.intValue; break;
+        case FsVarParamTypeCRC:     index += static_cast<unsigned>(p.CRCValue); break;
+        case FsVarParamTypeString:  index += static_cast<unsigned char>(p.stringValue[0]); break;
+        default:                    return FS_VAR_ERROR_INVALID_ARGS;
+        }
+    }
+    *result = g_vars[static_cast<unsigned>(simvar) % kVarCount][index % kIndexCount];
+    return FS_VAR_ERROR_NONE;
+}
+
+extern "C" SIMPARAMBENCH_NOINLINE FsVarError fsVarsAircraftVarSet(FsSimVarId simvar, FsUnitId unit, FsVarParamArray param, double value) {
+    unsigned index = static_cast<unsigned>(unit);
+    for (unsigned i = 0; i < param.size; i++)
+        index += param.array[i].type == FsVarParamTypeInteger ? param.array[i].intValue : 0;
+    g_vars[static_cast<unsigned>(simvar) % kVarCount][index % kIndexCount] = value;
+    return FS_VAR_ERROR_NONE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timing
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+volatile double g_sink;  // Keeps results observable so the optimizer cannot drop the work.
+
+struct Options {
+    Options() : filter(), minTimeMs(200), repeat(5) {}
+    std::string filter;
+    unsigned minTimeMs;
+    unsigned repeat;
+};
+
+struct Result {
+    std::string name;
+    std::string path;
+    unsigned params;
+    uint64_t iterations;
+    double minNs;
+    double medianNs;
+    double meanNs;
+};
+
+// Calibrates an iteration count that runs for at least options.minTimeMs / repeat,
+// then times repeat batches of that many calls. fn(i) performs access number i.
+template <typename Fn>
+Result Measure(const Options& options, Fn fn) {
+    uint64_t iterations = 1;
+    const double target = options.minTimeMs * 1e6 / options.repeat;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        double sum = 0;
+        for (uint64_t i = 0; i < iterations; i++)
+            sum += fn(static_cast<unsigned>(i));
+        g_sink = g_sink + sum;
+        double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        if (elapsed >= target || iterations >= (1ULL << 40))
+            break;
+        uint64_t next = elapsed > 0 ? static_cast<uint64_t>(iterations * (target / elapsed) * 1.2) : iterations * 10;
+        iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+    }
+
+    std::vector<double> samples;
+    for (unsigned r = 0; r < options.repeat; r++) {
+        Clock::time_point start = Clock::now();
+        double sum = 0;
+        for (uint64_t i = 0; i < iterations; i++)
+            sum += fn(static_cast<unsigned>(i));
+        g_sink = g_sink + sum;
+        samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.params = 0;
+    result.iterations = iterations;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    double sum = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    result.meanNs = sum / samples.size();
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+const FsSimVarId kEngRpm = 11;          // GENERAL ENG RPM:index
+const FsSimVarId kFuelTank = 18;        // FUEL TANK QUANTITY:index
+const FsSimVarId kComFrequency = 45;    // COM ACTIVE FREQUENCY:index, per radio and sub-index
+const FsSimVarId kComponentVar = 52;    // var addressed by component CRC and node name
+const FsUnitId kUnit = 1;
+const char* const kNodeNames[] = { "LEFT", "RIGHT", "CENTER", "AUX" };
+
+struct EngineCreate {
+    double operator()(unsigned i) const {
+        FsVarParamArray param = FsCreateParamArray("i", i % 4 + 1);
+        double value = 0;
+        fsVarsAircraftVarGet(kEngRpm, kUnit, param, &value);
+        FsDestroyParamArray(&param);
+        return value;
+    }
+};
+
+struct EngineStack {
+    double operator()(unsigned i) const {
+        FsParamArray<'i'> param(i % 4 + 1);
+        double value = 0;
+        fsVarsAircraftVarGet(kEngRpm, kUnit, param, &value);
+        return value;
+    }
+};
+
+struct TankCreate {
+    double operator()(unsigned i) const {
+        FsVarParamArray param = FsCreateParamArray("i", i % 11);
+        double value = 0;
+        fsVarsAircraftVarGet(kFuelTank, kUnit, param, &value);
+        FsDestroyParamArray(&param);
+        return value;
+    }
+};
+
+struct TankStack {
+    double operator()(unsigned i) const {
+        FsParamArray<'i'> param(i % 11);
+        double value = 0;
+        fsVarsAircraftVarGet(kFuelTank, kUnit, param, &value);
+        return value;
+    }
+};
+
+struct RadioCreate {
+    double operator()(unsigned i) const {
+        FsVarParamArray param = FsCreateParamArray("ii", i % 3 + 1, i % 2);
+        double value = 0;
+        fsVarsAircraftVarGet(kComFrequency, kUnit, param, &value);
+        FsDestroyParamArray(&param);
+        return value;
+    }
+};
+
+struct RadioStack {
+    double operator()(unsigned i) const {
+        FsParamArray<'i', 'i'> param(i % 3 + 1, i % 2);
+        double value = 0;
+        fsVarsAircraftVarGet(kComFrequency, kUnit, param, &value);
+        return value;
+    }
+};
+
+struct ComponentCreate {
+    double operator()(unsigned i) const {
+        FsVarParamArray param = FsCreateParamArray("ics", i % 4, static_cast<FsCRC>(0x9E3779B97F4A7C15ULL), kNodeNames[i % 4]);
+        double value = 0;
+        fsVarsAircraftVarGet(kComponentVar, kUnit, param, &value);
+        FsDestroyParamArray(&param);
+        return value;
+    }
+};
+
+struct ComponentStack {
+    double operator()(unsigned i) const {
+        FsParamArray<'i', 'c', 's'> param(i % 4, 0x9E3779B97F4A7C15ULL, kNodeNames[i % 4]);
+        double value = 0;
+        fsVarsAircraftVarGet(kComponentVar, kUnit, param, &value);
+        return value;
+    }
+};
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options_(options) {}
+
+    template <typename Create, typename Stack>
+    void Run(const char* name, unsigned params) {
+        Add(name, "create", params, Create());
+        Add(name, "stack", params, Stack());
+    }
+
+    const std::vector<Result>& GetResults() const { return results_; }
+
+private:
+    template <typename Fn>
+    void Add(const char* name, const char* path, unsigned params, Fn fn) {
+        std::string fullName = std::string(name) + "/" + path;
+        if (!options_.filter.empty() && fullName.find(options_.filter) == std::string::npos)
+            return;
+        Result result = Measure(options_, fn);
+        result.name = name;
+        result.path = path;
+        result.params = params;
+        results_.push_back(result);
+    }
+
+    const Options& options_;
+    std::vector<Result> results_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Reporting
+
+template <typename Handler>
+void WriteResults(Handler& writer, const Options& options, const std::vector<Result>& results) {
+    writer.StartObject();
+#if defined(__clang__)
+    writer.Key("compiler"); writer.String("clang " __clang_version__);
+#elif defined(__GNUC__)
+    writer.Key("compiler"); writer.String("gcc " __VERSION__);
+#elif defined(_MSC_VER)
+    writer.Key("compiler"); writer.String("msvc");
+#else
+    writer.Key("compiler"); writer.String("unknown");
+#endif
+    writer.Key("minTimeMs"); writer.Uint(options.minTimeMs);
+    writer.Key("repeat"); writer.Uint(options.repeat);
+    writer.Key("results");
+    writer.StartArray();
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        writer.StartObject();
+        writer.Key("name"); writer.String(r.name.c_str());
+        writer.Key("path"); writer.String(r.path.c_str());
+        writer.Key("params"); writer.Uint(r.params);
+        writer.Key("iterations"); writer.Uint64(r.iterations);
+        writer.Key("minNs"); writer.Double(r.minNs);
+        writer.Key("medianNs"); writer.Double(r.medianNs);
+        writer.Key("meanNs"); writer.Double(r.meanNs);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+void WriteSummary(const std::vector<Result>& results) {
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].path != "create")
+            continue;
+        for (size_t j = 0; j < results.size(); j++)
+            if (results[j].name == results[i].name && results[j].path == "stack")
+                std::fprintf(stderr, "%-10s create %7.2f ns  stack %7.2f ns  x%.1f\n", results[i].name.c_str(),
+                    results[i].medianNs, results[j].medianNs, results[j].medianNs > 0 ? results[i].medianNs / results[j].medianNs : 0.0);
+    }
+}
+
+void Usage() {
+    std::fprintf(stderr, "usage: simparambench [--filter substr] [--min-time ms] [--repeat n]\n");
+    std::exit(1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (i + 1 >= argc)
+            Usage();
+        const char* value = argv[++i];
+        if (arg == "--filter") options.filter = value;
+        else if (arg == "--min-time") options.minTimeMs = static_cast<unsigned>(std::strtoul(value, 0, 10));
+        else if (arg == "--repeat") options.repeat = static_cast<unsigned>(std::strtoul(value, 0, 10));
+        else Usage();
+    }
+    if (options.repeat == 0 || options.minTimeMs == 0)
+        Usage();
+
+    for (unsigned v = 0; v < kVarCount; v++)
+        for (unsigned i = 0; i < kIndexCount; i++)
+            g_vars[v][i] = v * 100.0 + i;
+
+    Suite suite(options);
+    suite.Run<EngineCreate, EngineStack>("engine", 1);
+    suite.Run<TankCreate, TankStack>("tank", 1);
+    suite.Run<RadioCreate, RadioStack>("radio", 2);
+    suite.Run<ComponentCreate, ComponentStack>("component", 3);
+
+    char buffer[4096];
+    rapidjson::FileWriteStream os(stdout, buffer, sizeof(buffer));
+    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
+    WriteResults(writer, options, suite.GetResults());
+    os.Put('\n');
+    os.Flush();
+    WriteSummary(suite.GetResults());
+    return 0;
+}
@@ -0,0 +1,374 @@
+// Regression tests for the helpers of MSFS/Utils, run natively.
+//
+// The fsVars and fsCommBus imports are replaced by an in-process var table
+// and a recorder of the CommBus calls, so the helpers run unchanged outside
+// the simulator. Every case is a plain function of checks; the process exits
+// with status 1 if any check fails.
+//
+// Build (native, with sanitizers):
+//   c++ -std=c++11 -g -O1 -fsanitize=address,undefined -fno-omit-frame-pointer
+//       -I SDKResources/WASM/include Tools/SimUtilsTests/simutilstests.cpp
+//       -o simutilstests
+//
+// Usage:
+//   simutilstests [--filter substr]
+
+#include <MSFS/Utils/VarChangeDetector.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulated imports
+
+namespace {
+
+const unsigned kVarCount = 256;
+double g_vars[kVarCount];
+std::map<std::string, FsSimVarId> g_varIds;
+std::vector<std::vector<char> > g_packets;
+std::vector<FsSimVarId> g_writes;   // ids passed to fsVarsAircraftVarSet, in call order
+FsSimVarId g_failingVar = -1;       // gets of this var fail
+
+} // namespace
+
+extern "C" FsSimVarId fsVarsGetAircraftVarId(const char* simVarName) {
+    std::map<std::string, FsSimVarId>::iterator it = g_varIds.find(simVarName);
+    if (it != g_varIds.end())
+        return it->second;
+    const FsSimVarId id = static_cast<FsSimVarId>(g_varIds.size());
+    g_varIds[simVarName] = id;
+    return id;
+}
+
+extern "C" FsUnitId fsVarsGetUnitId(const char*) {
+    return 1;
+}
+
+extern "C" FsVarError fsVarsAircraftVarGet(FsSimVarId simvar, FsUnitId, FsVarParamArray, double* result) {
+    if (simvar == g_failingVar)
+        return FS_VAR_ERROR_FAIL;
+    *result = g_vars[static_cast<unsigned>(simvar) % kVarCount];
+    return FS_VAR_ERROR_NONE;
+}
+
+extern "C" FsVarError fsVarsAircraftVarSet(FsSimVarId simvar, FsUnitId, FsVarParamArray, double value) {
+    g_writes.push_back(simvar);
+    g_vars[static_cast<unsigned>(simvar) % kVarCount] = value;
+    return FS_VAR_ERROR_NONE;
+}
+
+extern "C" bool fsCommBusCall(const char*, const char* buf, unsigned int bufSize, FsCommBusBroadcastFlags) {
+    g_packets.push_back(std::vector<char>(buf, buf + bufSize));
+    return true;
+}
+
+namespace {
+
+int g_failures;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); g_failures++; } } while (0)
+
+void ResetSim() {
+    std::memset(g_vars, 0, sizeof(g_vars));
+    g_varIds.clear();
+    g_packets.clear();
+    g_writes.clear();
+    g_failingVar = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VarBatch
+
+FsVarParamVariant StringParam(const char* value) {
+    FsVarParamVariant v;
+    v.type = FsVarParamTypeString;
+    v.stringValue = value;
+    return v;
+}
+
+FsVarParamVariant IntParam(int value) {
+    FsVarParamVariant v;
+    v.type = FsVarParamTypeInteger;
+    v.intValue = value;
+    return v;
+}
+
+// Registering the same var, unit and parameters returns the first handle; string parameters
+// compare by content, and a null one only matches another null one.
+void BatchRegisterParams() {
+    ResetSim();
+    VarBatch batch;
+    const VarBatch::Handle plain = batch.Register("ENG N1", "percent");
+    CHECK(batch.Register("ENG N1", "percent") == plain);
+
+    FsVarParamVariant one = IntParam(1), two = IntParam(2);
+    FsVarParamArray param;
+    param.size = 1;
+    param.array = &one;
+    const VarBatch::Handle engine1 = batch.Register("ENG N1", "percent", param);
+    CHECK(engine1 != plain && batch.Register("ENG N1", "percent", param) == engine1);
+    param.array = &two;
+    CHECK(batch.Register("ENG N1", "percent", param) != engine1);
+
+    char copy[] = "LEFT";
+    FsVarParamVariant left = StringParam("LEFT"), leftCopy = StringParam(copy), null = StringParam(nullptr), null2 = StringParam(nullptr);
+    param.array = &left;
+    const VarBatch::Handle named = batch.Register("FLAPS", "number", param);
+    param.array = &leftCopy;
+    CHECK(batch.Register("FLAPS", "number", param) == named);
+    param.array = &null;
+    const VarBatch::Handle unnamed = batch.Register("FLAPS", "number", param);
+    CHECK(unnamed != named);
+    param.array = &null2;
+    CHECK(batch.Register("FLAPS", "number", param) == unnamed);
+    param.array = &left;
+    CHECK(batch.Register("FLAPS", "number", param) == named);
+    CHECK(batch.Size() == 5);
+}
+
+// Read() reports the vars which moved by more than their epsilon across more than one mask word,
+// keeps the previous value of a failed get, and FlushWrites() applies the last value queued per var.
+void BatchReadAndWrite() {
+    ResetSim();
+    VarBatch batch;
+    VarBatch::Handle handles[40];
+    for (unsigned i = 0; i < 40; i++) {
+        char name[8];
+        std::sprintf(name, "V%u", i);
+        handles[i] = batch.Register(name, "number", FsVarParamArray(), i == 3 ? 0.5 : 0.0);
+        g_vars[i] = i;
+    }
+    CHECK(batch.Read() == 40 && batch.ChangedMaskWords() == 2);
+    CHECK(batch.Read() == 0 && batch.NextChanged(0) == VarBatch::InvalidHandle);
+
+    g_vars[3] += 0.25;      // inside its epsilon
+    g_vars[5] = std::nan("");
+    g_vars[33] += 1.0;
+    g_failingVar = 39;
+    g_vars[39] = 100.0;
+    CHECK(batch.Read() == 2);
+    CHECK(batch.NextChanged(0) == handles[5] && batch.NextChanged(handles[5] + 1) == handles[33]);
+    CHECK(batch.NextChanged(handles[33] + 1) == VarBatch::InvalidHandle);
+    CHECK(batch.Value(handles[39]) == 39.0 && batch.Error(handles[39]) == FS_VAR_ERROR_FAIL && batch.Stats().readErrors == 1);
+    CHECK(batch.Read() == 0);    // NaN stays NaN
+    CHECK(batch.PreviousValues()[handles[33]] == 34.0);
+
+    batch.QueueWrite(handles[7], 1.0);
+    batch.QueueWrite(handles[2], 2.0);
+    batch.QueueWrite(handles[7], 3.0);
+    CHECK(batch.PendingWrites() == 2 && batch.FlushWrites() == 0 && batch.PendingWrites() == 0);
+    CHECK(g_writes.size() == 2 && g_writes[0] == 7 && g_writes[1] == 2 && g_vars[7] == 3.0 && g_vars[2] == 2.0);
+    CHECK(batch.FlushWrites() == 0 && batch.Stats().flushes == 1 && batch.Stats().varsWritten == 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VarChangeDetector
+
+// A packet decoded back into its header and entries, as a receiver would.
+struct DeltaPacket {
+    uint16_t flags;
+    uint32_t sequence;
+    std::map<unsigned, double> values;  // key -> value
+};
+
+bool Decode(const std::vector<char>& packet, DeltaPacket& out) {
+    if (packet.size() < VarChangeDetector::HeaderSize)
+        return false;
+    uint32_t magic;
+    uint16_t version, count;
+    std::memcpy(&magic, &packet[0], 4);
+    std::memcpy(&version, &packet[4], 2);
+    std::memcpy(&out.flags, &packet[6], 2);
+    std::memcpy(&out.sequence, &packet[8], 4);
+    std::memcpy(&count, &packet[12], 2);
+    if (magic != VarChangeDetector::Magic || version != VarChangeDetector::Version
+        || packet.size() != VarChangeDetector::HeaderSize + count * VarChangeDetector::EntrySize)
+        return false;
+    out.values.clear();
+    for (unsigned i = 0; i < count; i++) {
+        uint16_t key;
+        double value;
+        std::memcpy(&key, &packet[VarChangeDetector::HeaderSize + i * VarChangeDetector::EntrySize], 2);
+        std::memcpy(&value, &packet[VarChangeDetector::HeaderSize + i * VarChangeDetector::EntrySize + 2], 8);
+        out.values[key] = value;
+    }
+    return true;
+}
+
+void DetectorDeadbandAndPriority() {
+    ResetSim();
+    VarChangeDetector detector("Test.VarDelta");
+    VarTrackOptions altitude;
+    altitude.deadband = 1.0;
+    altitude.maxInterval = 5.0;
+    VarTrackOptions gear;
+    gear.priority = VarPriorityCritical;
+    gear.key = 700;
+    const VarBatch::Handle a = detector.Track("ALT", "feet", altitude);
+    detector.Track("GEAR", "bool", gear);
+
+    g_vars[a] = 100.0;
+    CHECK(detector.Update(0.0) == 2);
+    DeltaPacket p;
+    CHECK(Decode(g_packets.back(), p) && p.flags == VarChangeDetector::VarDeltaKeyframe && p.sequence == 0);
+    uint16_t firstKey;
+    std::memcpy(&firstKey, &g_packets.back()[VarChangeDetector::HeaderSize], 2);
+    CHECK(firstKey == 700);     // critical class first
+
+    CHECK(detector.Update(0.1) == 0 && g_packets.size() == 1);
+    g_vars[a] = 100.5;
+    CHECK(detector.Update(0.2) == 0);       // inside the deadband
+    g_vars[a] = 101.2;
+    CHECK(detector.Update(0.3) == 1);
+    CHECK(Decode(g_packets.back(), p) && p.flags == 0 && p.values[a] == 101.2);
+    CHECK(detector.Update(5.3) == 1);       // heartbeat
+    CHECK(detector.Stats().heartbeats == 1);
+}
+
+// Vars of a keyframe split by the packet size reach the new receiver, even
+// when they drift within their deadband of the value the old receivers have.
+void DetectorSplitKeyframe() {
+    ResetSim();
+    VarChangeDetector detector("Test.VarDelta", FsCommBusBroadcast_Default,
+                               VarChangeDetector::HeaderSize + 2 * VarChangeDetector::EntrySize);
+    VarTrackOptions options;
+    options.deadband = 5.0;
+    VarBatch::Handle handles[4];
+    for (unsigned i = 0; i < 4; i++) {
+        char name[8];
+        std::sprintf(name, "V%u", i);
+        handles[i] = detector.Track(name, "number", options);
+        g_vars[handles[i]] = 10.0 * i;
+    }
+    CHECK(detector.Update(0.0) == 2);
+    CHECK(detector.Update(0.1) == 2);
+    CHECK(detector.Update(0.2) == 0);
+
+    // A new peer joins; every var drifts by less than its deadband after the first packet.
+    g_packets.clear();
+    detector.ForceFull();
+    CHECK(detector.Update(1.0) == 2);
+    for (unsigned i = 0; i < 4; i++)
+        g_vars[handles[i]] += 1.0;
+    CHECK(detector.Update(1.1) == 2);
+    CHECK(detector.Update(1.2) == 0);
+
+    std::map<unsigned, double> received;
+    DeltaPacket p;
+    for (size_t i = 0; i < g_packets.size(); i++) {
+        CHECK(Decode(g_packets[i], p));
+        CHECK((p.flags == VarChangeDetector::VarDeltaKeyframe) == (i == 0));
+        received.insert(p.values.begin(), p.values.end());
+    }
+    CHECK(received.size() == 4);
+    CHECK(detector.Stats().varsDeferred == 4);  // two vars left after each of the two keyframes
+}
+
+// Vars of a class which all change every frame take turns in a packet that holds only some
+// of them, and a keyframe reaches every var, instead of the first vars of the class taking every packet.
+void DetectorNoStarvation() {
+    ResetSim();
+    VarChangeDetector detector("Test.VarDelta", FsCommBusBroadcast_Default,
+                               VarChangeDetector::HeaderSize + 2 * VarChangeDetector::EntrySize);
+    VarTrackOptions critical;
+    critical.priority = VarPriorityCritical;
+    const VarBatch::Handle fast = detector.Track("FAST", "number", critical);
+    VarBatch::Handle handles[5];
+    for (unsigned i = 0; i < 5; i++) {
+        char name[8];
+        std::sprintf(name, "V%u", i);
+        handles[i] = detector.Track(name, "number");
+    }
+
+    // Every var changes every frame; the critical one takes a slot each time, the five others share the second.
+    std::map<unsigned, unsigned> sent;
+    DeltaPacket p;
+    for (unsigned frame = 0; frame < 15; frame++) {
+        g_vars[fast] += 1.0;
+        for (unsigned i = 0; i < 5; i++)
+            g_vars[handles[i]] += 1.0;
+        CHECK(detector.Update(0.1 * frame) == 2);
+        CHECK(Decode(g_packets.back(), p) && p.values.count(fast) == 1);
+        for (std::map<unsigned, double>::const_iterator it = p.values.begin(); it != p.values.end(); ++it)
+            sent[it->first]++;
+    }
+    CHECK(sent[fast] == 15);
+    for (unsigned i = 0; i < 5; i++)
+        CHECK(sent[handles[i]] == 3);
+
+    // A keyframe while everything keeps changing: every var reaches the new receiver within five frames.
+    g_packets.clear();
+    detector.ForceFull();
+    std::map<unsigned, double> received;
+    for (unsigned frame = 0; frame < 5; frame++) {
+        g_vars[fast] += 1.0;
+        for (unsigned i = 0; i < 5; i++)
+            g_vars[handles[i]] += 1.0;
+        detector.Update(2.0 + 0.1 * frame);
+        CHECK(Decode(g_packets.back(), p));
+        received.insert(p.values.begin(), p.values.end());
+    }
+    CHECK(received.size() == 6);
+}
+
+// A size limit below one entry is raised to one entry, so vars still go out.
+void DetectorPacketLimitBelowOneEntry() {
+    ResetSim();
+    VarChangeDetector detector("Test.VarDelta", FsCommBusBroadcast_Default, 4);
+    detector.Track("A", "number");
+    detector.Track("B", "number");
+    CHECK(detector.Update(0.0) == 1);
+    CHECK(detector.Update(0.1) == 1);
+    CHECK(detector.Update(0.2) == 0);
+    CHECK(g_packets.size() == 2);
+    CHECK(g_packets[0].size() == VarChangeDetector::HeaderSize + VarChangeDetector::EntrySize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+const TestCase kTests[] = {
+    { "batch_register_params", BatchRegisterParams },
+    { "batch_read_and_write", BatchReadAndWrite },
+    { "detector_deadband_and_priority", DetectorDeadbandAndPriority },
+    { "detector_split_keyframe", DetectorSplitKeyframe },
+    { "detector_no_starvation", DetectorNoStarvation },
+    { "detector_packet_limit_below_one_entry", DetectorPacketLimitBelowOneEntry },
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--filter substr]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int run = 0;
+    for (size_t i = 0; i < sizeof(kTests) / sizeof(kTests[0]); i++) {
+        if (filter && !std::strstr(kTests[i].name, filter))
+            continue;
+        const int before = g_failures;
+        kTests[i].fn();
+        std::fprintf(stderr, "%-40s %s\n", kTests[i].name, g_failures == before ? "ok" : "FAILED");
+        run++;
+    }
+    std::fprintf(stderr, "%d tests, %d failed checks\n", run, g_failures);
+    return g_failures ? 1 : 0;
+}
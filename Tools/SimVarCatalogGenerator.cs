@@ -26,6 +26,24 @@ namespace SharedCockpitClient
         private static readonly Regex sHeaderEventRegex = new(@"K:[A-Z0-9_]+", RegexOptions.Compiled);
         private static readonly Regex sHeaderTokenRegex = new(@"(?<![A-Z0-9_])([A-Z][A-Z0-9_]*_EVENT_[A-Z0-9_]+)(?![A-Z0-9_])", RegexOptions.Compiled);
 
+        // SimVars que todo header generado debe contener; GenerateCppHeader() falla si falta alguno.
+        private static readonly string[] sRequiredCppSimVars =
+        {
+            "PLANE LATITUDE", "PLANE LONGITUDE", "PLANE ALTITUDE", "PLANE HEADING DEGREES TRUE", "PLANE PITCH DEGREES",
+            "PLANE BANK DEGREES", "AIRSPEED INDICATED", "VERTICAL SPEED", "SIM ON GROUND", "GENERAL ENG THROTTLE LEVER POSITION",
+            "AUTOPILOT MASTER", "FUEL TOTAL QUANTITY", "NAV CDI"
+        };
+
+        // Unidades SimConnect habituales; UnitNames las incluye siempre junto a las de las SimVars.
+        private static readonly string[] sCppUnits =
+        {
+            "Bool", "Number", "Enum", "Percent", "Percent over 100", "Position", "Degrees", "Radians", "Feet", "Meters",
+            "Knots", "Feet per second", "Feet per minute", "Meters per second", "Radians per second", "Degrees per second",
+            "Mach", "RPM", "Psi", "Millibars", "Inches of mercury", "Celsius", "Rankine", "Gallons", "Pounds",
+            "Gallons per hour", "Pounds per hour", "Volts", "Amperes", "Seconds", "Hours", "MHz", "KHz", "Hz",
+            "Frequency BCD16", "Frequency BCD32", "Nautical miles", "String"
+        };
+
         public static bool TryGetCatalog(out SimVarCatalog catalog)
         {
             var value = s_cachedCatalog.Value;
@@ -69,6 +87,417 @@ namespace SharedCockpitClient
             return JsonSerializer.Serialize(payload, new JsonSerializerOptions { WriteIndented = indented });
         }
 
+        /// <summary>
+        /// Genera un header C++ para los módulos WASM con las tablas de nombres de SimVars y unidades,
+        /// un hash perfecto mínimo constexpr nombre → índice denso y una caché de los IDs de runtime.
+        /// Incluye siempre SimDataDefinition.AllSimVars, SimStateSnapshot.DefaultSimVarKeys y las unidades
+        /// SimConnect habituales; <paramref name="simVars"/> añade más variables. Solo se aceptan nombres
+        /// de SimVar reales (mayúsculas, varias palabras): el catálogo embebido aporta sobre todo IDs de
+        /// documentación XML que se descartan. Los nombres indexados ("GENERAL ENG RPM:2") se reducen al
+        /// nombre base. Lanza InvalidOperationException si falta alguna SimVar básica.
+        /// </summary>
+        public static string GenerateCppHeader(IEnumerable<SimVarDescriptor>? simVars = null)
+        {
+            var unitsByName = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+            foreach (var unit in sCppUnits)
+                unitsByName[unit] = unit;
+
+            var varUnits = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+            void AddSimVar(string name, string? units)
+            {
+                var baseName = name.Trim();
+                if (ParseIndex(baseName).HasValue)
+                    baseName = baseName[..baseName.LastIndexOf(':')];
+                if (!IsCppSimVarName(baseName))
+                    return;
+
+                var unit = units?.Trim() ?? string.Empty;
+                if (unit.Length > 0 && !unitsByName.ContainsKey(unit))
+                    unitsByName[unit] = unit;
+                if (!varUnits.TryGetValue(baseName, out var known) || (known.Length == 0 && unit.Length > 0))
+                    varUnits[baseName] = unit;
+            }
+
+            foreach (var simVar in SimDataDefinition.AllSimVars.Concat(simVars ?? Array.Empty<SimVarDescriptor>()))
+                AddSimVar(simVar.Name, simVar.Units);
+            foreach (var key in SimStateSnapshot.DefaultSimVarKeys)
+                AddSimVar(key, null);
+
+            var missing = sRequiredCppSimVars.Where(n => !varUnits.ContainsKey(n)).ToList();
+            if (missing.Count > 0)
+                throw new InvalidOperationException($"SimVars missing from the C++ catalog: {string.Join(", ", missing)}.");
+
+            var varSlots = BuildPerfectHash(varUnits.Keys.OrderBy(k => k, StringComparer.Ordinal).ToList(), out var varDisplacements);
+            var unitSlots = BuildPerfectHash(unitsByName.Keys.OrderBy(k => k, StringComparer.Ordinal).ToList(), out var unitDisplacements);
+            var unitIndex = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+            for (var i = 0; i < unitSlots.Length; i++)
+                unitIndex[unitSlots[i]] = i;
+
+            var sb = new StringBuilder();
+            sb.AppendLine("// <auto-generated>");
+            sb.AppendLine("// Generated by SharedCockpitClient.SimVarCatalogGenerator.GenerateCppHeader(). Do not edit.");
+            sb.AppendLine("// </auto-generated>");
+            sb.AppendLine("#pragma once");
+            sb.AppendLine();
+            sb.AppendLine("#ifndef SIMVAR_CATALOG_H");
+            sb.AppendLine("#define SIMVAR_CATALOG_H");
+            sb.AppendLine();
+            sb.AppendLine("#include <MSFS/MSFS_Vars.h>");
+            sb.AppendLine("#include <cstddef>");
+            sb.AppendLine("#include <cstdint>");
+            sb.AppendLine();
+            sb.AppendLine("namespace SimVarCatalog");
+            sb.AppendLine("{");
+            sb.AppendLine($"\tconstexpr unsigned int SimVarCount = {varSlots.Length};");
+            sb.AppendLine($"\tconstexpr unsigned int UnitCount = {unitSlots.Length};");
+            sb.AppendLine();
+            sb.AppendLine("\t/// Names in slot order of the perfect hash : FindSimVar(SimVarNames[i]) == i.");
+            AppendCppStringArray(sb, "SimVarNames", "SimVarCount", varSlots);
+            sb.AppendLine("\t/// Unit of each simvar in the catalog, index in UnitNames, -1 if none.");
+            sb.AppendLine($"\tconstexpr int SimVarUnits[{Math.Max(1, varSlots.Length)}] = {{");
+            AppendCppValues(sb, varSlots.Select(n => unitIndex.TryGetValue(varUnits[n], out var u) ? u : -1));
+            sb.AppendLine("\t};");
+            sb.AppendLine();
+            AppendCppStringArray(sb, "UnitNames", "UnitCount", unitSlots);
+            sb.AppendLine("\tnamespace Detail");
+            sb.AppendLine("\t{");
+            sb.AppendLine($"\t\tconstexpr int32_t SimVarDisplacements[{varDisplacements.Length}] = {{");
+            AppendCppValues(sb, varDisplacements);
+            sb.AppendLine("\t\t};");
+            sb.AppendLine();
+            sb.AppendLine($"\t\tconstexpr int32_t UnitDisplacements[{unitDisplacements.Length}] = {{");
+            AppendCppValues(sb, unitDisplacements);
+            sb.AppendLine("\t\t};");
+            sb.AppendLine("\t}");
+            sb.Append(CppLookupSource);
+            sb.AppendLine("}");
+            sb.AppendLine();
+            sb.AppendLine("#endif // SIMVAR_CATALOG_H");
+            return sb.ToString();
+        }
+
+        // SimVar base real: mayúsculas, dígitos y espacios, con al menos dos palabras ("PLANE LATITUDE").
+        // Descarta los IDs de documentación ("F:SharpDX...") y los nombres sueltos ("M13", "CL") del catálogo.
+        private static bool IsCppSimVarName(string baseName) =>
+            baseName.Length > 0 && char.IsAsciiLetterUpper(baseName[0]) && baseName.Contains(' ') &&
+            !baseName.Contains(':') && SimStateSnapshot.LooksLikeSimVar(baseName);
+
+        // Parte fija del header generado. Detail::Hash() y Detail::Mix() deben coincidir con CppHash() y CppMix().
+        private const string CppLookupSource = """
+
+            	namespace Detail
+            	{
+            		constexpr uint32_t Lower(char c) { return (c >= 'A' && c <= 'Z') ? uint32_t(c - 'A' + 'a') : uint32_t((unsigned char)c); }
+            		constexpr uint32_t XorShift(uint32_t h, int shift) { return h ^ (h >> shift); }
+            		constexpr uint32_t Finalize(uint32_t h) { return XorShift(XorShift(XorShift(h, 16) * 0x85EBCA6Bu, 13) * 0xC2B2AE35u, 16); }
+
+            		/// FNV-1a over the ASCII lowercase name.
+            		constexpr uint32_t Fnv(const char* s, size_t length, uint32_t h)
+            		{
+            			return length == 0 ? h : Fnv(s + 1, length - 1, (h ^ Lower(*s)) * 16777619u);
+            		}
+
+            		constexpr uint32_t Hash(const char* s, size_t length) { return Fnv(s, length, 2166136261u); }
+
+            		/// Bucket (seed 0) and slot (seed d) hashes derive from one pass over the name.
+            		constexpr uint32_t Mix(uint32_t hash, uint32_t seed) { return Finalize(hash ^ (seed * 0x9E3779B9u)); }
+
+            		constexpr bool Equals(const char* s, size_t length, const char* name)
+            		{
+            			return length == 0 ? *name == '\0' : (*name != '\0' && Lower(*s) == Lower(*name) && Equals(s + 1, length - 1, name + 1));
+            		}
+
+            		constexpr size_t Length(const char* s) { return *s == '\0' ? 0 : 1 + Length(s + 1); }
+
+            		constexpr int Verify(int slot, const char* s, size_t length, const char* const* names)
+            		{
+            			return Equals(s, length, names[slot]) ? slot : -1;
+            		}
+
+            		/// Displacement d < 0 stores the slot -d - 1 of a single-key bucket, d > 0 seeds the slot hash.
+            		constexpr int Slot(int32_t d, uint32_t hash, unsigned int count)
+            		{
+            			return d < 0 ? -d - 1 : int(Mix(hash, uint32_t(d)) % count);
+            		}
+
+            		constexpr int Probe(uint32_t hash, const char* s, size_t length, const int32_t* displacements, unsigned int bucketCount, const char* const* names, unsigned int count)
+            		{
+            			return Verify(Slot(displacements[Mix(hash, 0) % bucketCount], hash, count), s, length, names);
+            		}
+
+            		constexpr int Lookup(const char* s, size_t length, const int32_t* displacements, unsigned int bucketCount, const char* const* names, unsigned int count)
+            		{
+            			return count == 0 ? -1 : Probe(Hash(s, length), s, length, displacements, bucketCount, names, count);
+            		}
+            	}
+
+            	/// <summary>
+            	/// Dense index of a simvar base name (without ":index"), -1 if it is not in the catalog.
+            	/// Case-insensitive, one hash probe and one string compare; usable in constant expressions.
+            	/// </summary>
+            	constexpr int FindSimVar(const char* name, size_t length)
+            	{
+            		return Detail::Lookup(name, length, Detail::SimVarDisplacements, sizeof(Detail::SimVarDisplacements) / sizeof(int32_t), SimVarNames, SimVarCount);
+            	}
+
+            	constexpr int FindSimVar(const char* name) { return FindSimVar(name, Detail::Length(name)); }
+
+            	/// Dense index of a unit name, -1 if it is not in the catalog.
+            	constexpr int FindUnit(const char* name, size_t length)
+            	{
+            		return Detail::Lookup(name, length, Detail::UnitDisplacements, sizeof(Detail::UnitDisplacements) / sizeof(int32_t), UnitNames, UnitCount);
+            	}
+
+            	constexpr int FindUnit(const char* name) { return FindUnit(name, Detail::Length(name)); }
+
+            	/// <summary>
+            	/// Split a network-supplied "NAME:index" into the length of NAME and the index (0 without suffix).
+            	/// </summary>
+            	inline size_t SplitIndex(const char* name, size_t length, unsigned int& index)
+            	{
+            		index = 0;
+            		size_t i = length;
+            		while (i > 0 && name[i - 1] >= '0' && name[i - 1] <= '9')
+            			--i;
+            		if (i == length || i == 0 || name[i - 1] != ':')
+            			return length;
+            		for (size_t k = i; k < length; ++k)
+            			index = index * 10 + unsigned(name[k] - '0');
+            		return i - 1;
+            	}
+
+            	/// Resolves ids with fsVarsGetAircraftVarId / fsVarsGetUnitId.
+            	struct VarsResolver
+            	{
+            		typedef int Id;
+            		static Id SimVar(const char* name) { return fsVarsGetAircraftVarId(name); }
+            		static Id Unit(const char* name) { return fsVarsGetUnitId(name); }
+            	};
+
+            #ifdef SIMVAR_CATALOG_LEGACY_ENUMS
+            	/// Resolves ids with the legacy get_aircraft_var_enum / get_units_enum, include gauges.h first.
+            	struct LegacyResolver
+            	{
+            		typedef ENUM Id;
+            		static Id SimVar(const char* name) { return get_aircraft_var_enum(name); }
+            		static Id Unit(const char* name) { return get_units_enum(name); }
+            	};
+            #endif
+
+            	/// <summary>
+            	/// Runtime ids of the catalog entries, resolved by name on first use and cached.
+            	/// Lookups by name cost one FindSimVar / FindUnit probe once the id is cached.
+            	/// Unknown names and indices give -1.
+            	/// </summary>
+            	template <typename Resolver>
+            	class BasicIdCache
+            	{
+            	public:
+            		typedef typename Resolver::Id Id;
+
+            		BasicIdCache() { Reset(); }
+
+            		/// Forget every id, e.g. when the module is reloaded.
+            		void Reset()
+            		{
+            			for (unsigned int i = 0; i < SimVarCount; ++i)
+            				simVarIds[i] = Id(Unresolved);
+            			for (unsigned int i = 0; i < UnitCount; ++i)
+            				unitIds[i] = Id(Unresolved);
+            		}
+
+            		/// Resolve every entry now instead of on first use.
+            		void ResolveAll()
+            		{
+            			for (unsigned int i = 0; i < SimVarCount; ++i)
+            				SimVarId(int(i));
+            			for (unsigned int i = 0; i < UnitCount; ++i)
+            				UnitId(int(i));
+            		}
+
+            		Id SimVarId(int index)
+            		{
+            			if (index < 0 || unsigned(index) >= SimVarCount)
+            				return Id(-1);
+            			if (simVarIds[index] == Id(Unresolved))
+            				simVarIds[index] = Resolver::SimVar(SimVarNames[index]);
+            			return simVarIds[index];
+            		}
+
+            		Id UnitId(int index)
+            		{
+            			if (index < 0 || unsigned(index) >= UnitCount)
+            				return Id(-1);
+            			if (unitIds[index] == Id(Unresolved))
+            				unitIds[index] = Resolver::Unit(UnitNames[index]);
+            			return unitIds[index];
+            		}
+
+            		Id SimVarId(const char* name, size_t length) { return SimVarId(FindSimVar(name, length)); }
+            		Id SimVarId(const char* name) { return SimVarId(FindSimVar(name)); }
+            		Id UnitId(const char* name, size_t length) { return UnitId(FindUnit(name, length)); }
+            		Id UnitId(const char* name) { return UnitId(FindUnit(name)); }
+
+            		/// Id of the unit the catalog declares for a simvar.
+            		Id DefaultUnitId(int simVarIndex)
+            		{
+            			return simVarIndex < 0 || unsigned(simVarIndex) >= SimVarCount ? Id(-1) : UnitId(SimVarUnits[simVarIndex]);
+            		}
+
+            	private:
+            		enum { Unresolved = -2 };
+
+            		Id simVarIds[SimVarCount != 0 ? SimVarCount : 1];
+            		Id unitIds[UnitCount != 0 ? UnitCount : 1];
+            	};
+
+            	typedef BasicIdCache<VarsResolver> IdCache;
+            #ifdef SIMVAR_CATALOG_LEGACY_ENUMS
+            	typedef BasicIdCache<LegacyResolver> LegacyIdCache;
+            #endif
+
+            """;
+
+        // Hash-and-displace: las claves se agrupan en buckets por CppMix(h, 0); para cada bucket, de mayor a menor,
+        // se busca un desplazamiento d tal que CppMix(h, d) coloque todas sus claves en slots libres.
+        // Los buckets de una sola clave guardan directamente el slot como -slot - 1.
+        private static string[] BuildPerfectHash(IReadOnlyList<string> keys, out int[] displacements)
+        {
+            var count = keys.Count;
+            var bucketCount = Math.Max(1, (count + 1) / 2);
+            displacements = new int[bucketCount];
+            var slots = new string[count];
+            if (count == 0)
+                return slots;
+
+            var hashes = keys.ToDictionary(k => k, CppHash, StringComparer.OrdinalIgnoreCase);
+            if (hashes.Values.Distinct().Count() != count)
+                throw new InvalidOperationException("Two names share the same 32-bit hash.");
+
+            var buckets = keys.GroupBy(k => (int)(CppMix(hashes[k], 0) % (uint)bucketCount))
+                .OrderByDescending(g => g.Count())
+                .ThenBy(g => g.Key)
+                .ToList();
+
+            var taken = new bool[count];
+            var candidate = new List<int>();
+            foreach (var bucket in buckets.Where(b => b.Count() > 1))
+            {
+                for (var d = 1; ; d++)
+                {
+                    if (d == int.MaxValue)
+                        throw new InvalidOperationException("No perfect hash displacement found.");
+
+                    candidate.Clear();
+                    foreach (var key in bucket)
+                    {
+                        var slot = (int)(CppMix(hashes[key], (uint)d) % (uint)count);
+                        if (taken[slot] || candidate.Contains(slot))
+                            break;
+                        candidate.Add(slot);
+                    }
+
+                    if (candidate.Count != bucket.Count())
+                        continue;
+
+                    var i = 0;
+                    foreach (var key in bucket)
+                    {
+                        taken[candidate[i]] = true;
+                        slots[candidate[i++]] = key;
+                    }
+                    displacements[bucket.Key] = d;
+                    break;
+                }
+            }
+
+            var free = 0;
+            foreach (var bucket in buckets.Where(b => b.Count() == 1))
+            {
+                while (taken[free])
+                    free++;
+                taken[free] = true;
+                slots[free] = bucket.First();
+                displacements[bucket.Key] = -free - 1;
+            }
+
+            return slots;
+        }
+
+        // Mismos hashes que Detail::Hash() y Detail::Mix() en el header generado.
+        private static uint CppHash(string key)
+        {
+            unchecked
+            {
+                var h = 2166136261u;
+                foreach (var b in Encoding.UTF8.GetBytes(key))
+                {
+                    var c = b >= 'A' && b <= 'Z' ? (uint)(b - 'A' + 'a') : b;
+                    h = (h ^ c) * 16777619u;
+                }
+                return h;
+            }
+        }
+
+        private static uint CppMix(uint hash, uint seed)
+        {
+            unchecked
+            {
+                var h = hash ^ (seed * 0x9E3779B9u);
+                h ^= h >> 16;
+                h *= 0x85EBCA6Bu;
+                h ^= h >> 13;
+                h *= 0xC2B2AE35u;
+                h ^= h >> 16;
+                return h;
+            }
+        }
+
+        private static void AppendCppStringArray(StringBuilder sb, string name, string countName, IReadOnlyList<string> values)
+        {
+            sb.AppendLine($"\tconstexpr const char* {name}[{countName} != 0 ? {countName} : 1] = {{");
+            if (values.Count == 0)
+                sb.AppendLine("\t\t\"\",");
+            foreach (var value in values)
+                sb.AppendLine($"\t\t{EscapeCppString(value)},");
+            sb.AppendLine("\t};");
+            sb.AppendLine();
+        }
+
+        private static void AppendCppValues(StringBuilder sb, IEnumerable<int> values)
+        {
+            var line = new StringBuilder("\t\t");
+            var any = false;
+            foreach (var value in values)
+            {
+                if (line.Length > 100)
+                {
+                    sb.AppendLine(line.ToString().TrimEnd());
+                    line.Clear().Append("\t\t");
+                }
+                line.Append(value.ToString(CultureInfo.InvariantCulture)).Append(", ");
+                any = true;
+            }
+            if (!any)
+                line.Append("0,");
+            sb.AppendLine(line.ToString().TrimEnd());
+        }
+
+        private static string EscapeCppString(string value)
+        {
+            var sb = new StringBuilder("\"");
+            foreach (var b in Encoding.UTF8.GetBytes(value))
+            {
+                if (b == '"' || b == '\\')
+                    sb.Append('\\').Append((char)b);
+                else if (b < 0x20 || b >= 0x7F)
+                    sb.Append("\\").Append(Convert.ToString(b, 8).PadLeft(3, '0'));
+                else
+                    sb.Append((char)b);
+            }
+            return sb.Append('"').ToString();
+        }
+
         private static SimVarCatalog? GenerateInternal()
         {
             try